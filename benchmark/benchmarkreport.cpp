@@ -0,0 +1,75 @@
+#include "benchmarkreport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+BenchmarkReport::BenchmarkReport() {
+
+}
+
+BenchmarkReport::~BenchmarkReport() {
+
+}
+
+void BenchmarkReport::addRow(const Row & row) {
+    rows.push_back(row);
+}
+
+void BenchmarkReport::print(std::ostream & out) const {
+    out << std::left
+        << std::setw(8) << "backend"
+        << std::right
+        << std::setw(7) << "vars"
+        << std::setw(8) << "rules"
+        << std::setw(9) << "nodes"
+        << std::setw(11) << "bytes"
+        << std::setw(12) << "transl(ms)"
+        << std::setw(11) << "load(ms)"
+        << std::setw(9) << "solved"
+        << std::setw(11) << "mean(us)"
+        << std::setw(11) << "p50(us)"
+        << std::setw(11) << "p90(us)"
+        << std::setw(11) << "p99(us)"
+        << std::setw(11) << "max(us)"
+        << std::endl;
+
+    out << std::fixed << std::setprecision(2);
+    for(const Row & row: rows) {
+        std::vector<double> sorted = row.latenciesUs;
+        std::sort(sorted.begin(), sorted.end());
+        double mean = sorted.empty() ? 0 : std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+
+        out << std::left
+            << std::setw(8) << row.backend
+            << std::right
+            << std::setw(7) << row.numVariables
+            << std::setw(8) << row.numRestrictions
+            << std::setw(9) << row.astNodes;
+        if (row.programBytes > 0) {
+            out << std::setw(11) << row.programBytes;
+        } else {
+            out << std::setw(11) << "-";
+        }
+        out << std::setw(12) << row.translationMs
+            << std::setw(11) << row.loadMs
+            << std::setw(9) << (std::to_string(row.numSolved) + "/" + std::to_string(row.latenciesUs.size()))
+            << std::setw(11) << mean
+            << std::setw(11) << percentile(sorted, 50)
+            << std::setw(11) << percentile(sorted, 90)
+            << std::setw(11) << percentile(sorted, 99)
+            << std::setw(11) << (sorted.empty() ? 0 : sorted.back())
+            << std::endl;
+    }
+}
+
+double BenchmarkReport::percentile(const std::vector<double> & sortedSamples, double p) {
+    if (sortedSamples.empty()) {
+        return 0;
+    }
+    //nearest rank
+    std::size_t rank = (std::size_t) std::ceil((p / 100.0) * sortedSamples.size());
+    rank = std::max((std::size_t) 1, std::min(rank, sortedSamples.size()));
+    return sortedSamples[rank - 1];
+}
@@ -0,0 +1,55 @@
+#ifndef BENCHMARKREPORT_H
+#define BENCHMARKREPORT_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The BenchmarkReport class collects the measures of every machine and backend and prints them as a table.
+ */
+class BenchmarkReport
+{
+public:
+    /**
+     * @brief The Row struct measures of a machine solved by a backend.
+     */
+    typedef struct Row {
+        std::string backend;
+        int numVariables;
+        int numRestrictions;
+        std::size_t astNodes;
+        std::size_t programBytes;
+        double translationMs;
+        double loadMs;
+        int numSolved;
+        std::vector<double> latenciesUs;
+    } Row;
+
+    BenchmarkReport();
+    virtual ~BenchmarkReport();
+
+    /**
+     * @brief addRow adds the measures of a machine.
+     */
+    void addRow(const Row & row);
+    /**
+     * @brief print writes a line for every row: sizes, translation and load times, and the percentiles of the query latency.
+     */
+    void print(std::ostream & out) const;
+
+    /**
+     * @brief percentile returns the value under which are p percent of the samples, 0 if there are no samples.
+     * @param sortedSamples samples in ascending order.
+     * @param p percent, from 0 to 100.
+     */
+    static double percentile(const std::vector<double> & sortedSamples, double p);
+
+protected:
+    /**
+     * @brief rows measures added, in order.
+     */
+    std::vector<Row> rows;
+};
+
+#endif // BENCHMARKREPORT_H
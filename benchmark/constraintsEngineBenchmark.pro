@@ -0,0 +1,58 @@
+#-------------------------------------------------
+#
+# Benchmark of the translation and the solving of synthetic fluidic machines
+#
+#-------------------------------------------------
+
+# ensure one "debug_and_release" in CONFIG, for clarity...
+debug_and_release {
+    CONFIG -= debug_and_release
+    CONFIG += debug_and_release
+}
+    # ensure one "debug" or "release" in CONFIG so they can be used as
+    #   conditionals instead of writing "CONFIG(debug, debug|release)"...
+CONFIG(debug, debug|release) {
+    CONFIG -= debug release
+    CONFIG += debug
+}
+CONFIG(release, debug|release) {
+    CONFIG -= debug release
+    CONFIG += release
+}
+
+QT       -= gui
+
+TARGET = constraintsEngineBenchmark
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/..
+
+debug {
+    INCLUDEPATH += X:\fluidicMachineModel\dll_debug\include
+
+    LIBS += -L$$quote(X:\fluidicMachineModel\dll_debug\bin) -lFluidicMachineModel
+    LIBS += -L$$quote(X:\constraintsEngine\dll_debug\bin) -lconstraintsEngineLibrary
+}
+
+!debug {
+    INCLUDEPATH += X:\fluidicMachineModel\dll_release\include
+
+    LIBS += -L$$quote(X:\fluidicMachineModel\dll_release\bin) -lFluidicMachineModel
+    LIBS += -L$$quote(X:\constraintsEngine\dll_release\bin) -lconstraintsEngineLibrary
+}
+
+INCLUDEPATH += X:\swipl\include
+LIBS += -L$$quote(X:\swipl\bin) -llibswipl
+LIBS += -L$$quote(X:\swipl\lib) -llibswipl
+
+HEADERS += \
+    benchmarkreport.h \
+    syntheticmachine.h
+
+SOURCES += \
+    benchmarkreport.cpp \
+    main.cpp \
+    syntheticmachine.cpp
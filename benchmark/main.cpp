@@ -0,0 +1,164 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+
+#include "constraintengine/asttranslationstack.h"
+#include "constraintengine/nativetranslationstack.h"
+#include "constraintengine/prologexecutor.h"
+#include "constraintengine/prologtermtranslationstack.h"
+#include "constraintengine/prologtranslationstack.h"
+
+#include "benchmarkreport.h"
+#include "syntheticmachine.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static std::vector<std::string> split(const std::string & str) {
+    std::vector<std::string> items;
+    std::stringstream stream(str);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+static AstTranslationStack* createStack(const std::string & backend) {
+    if (backend == "text") {
+        return new PrologTranslationStack();
+    } else if (backend == "term") {
+        return new PrologTermTranslationStack();
+    } else if (backend == "native") {
+        return new NativeTranslationStack();
+    } else {
+        throw(std::runtime_error("unknown backend " + backend));
+    }
+}
+
+static void printUsage(const char* appName) {
+    std::cout << "usage: " << appName << " [options]" << std::endl
+              << "  --scales N1,N2,...    number of containers of every machine (default 8,16,32,64,128)" << std::endl
+              << "  --pumps R             pumps per container (default 0.25)" << std::endl
+              << "  --valves R            valves per container (default 0.25)" << std::endl
+              << "  --tubes R             tubes per container (default 1.25)" << std::endl
+              << "  --branching B         children of every container at the tree of tubes (default 2)" << std::endl
+              << "  --queries Q           calls to calculateNewRoute for every machine (default 100)" << std::endl
+              << "  --backends B1,B2,...  text, term and/or native (default text,term,native)" << std::endl
+              << "  --seed S              seed of the random generator (default 1)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> scales = {8, 16, 32, 64, 128};
+    double pumpsRatio = 0.25;
+    double valvesRatio = 0.25;
+    double tubesRatio = 1.25;
+    int branching = 2;
+    int numQueries = 100;
+    std::vector<std::string> backends = {"text", "term", "native"};
+    unsigned int seed = 1;
+
+    for(int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--help" || i + 1 >= argc) {
+            printUsage(argv[0]);
+            return (option == "--help") ? 0 : 1;
+        }
+        std::string value = argv[++i];
+        if (option == "--scales") {
+            scales.clear();
+            for(const std::string & scale: split(value)) {
+                scales.push_back(std::atoi(scale.c_str()));
+            }
+        } else if (option == "--pumps") {
+            pumpsRatio = std::atof(value.c_str());
+        } else if (option == "--valves") {
+            valvesRatio = std::atof(value.c_str());
+        } else if (option == "--tubes") {
+            tubesRatio = std::atof(value.c_str());
+        } else if (option == "--branching") {
+            branching = std::atoi(value.c_str());
+        } else if (option == "--queries") {
+            numQueries = std::atoi(value.c_str());
+        } else if (option == "--backends") {
+            backends = split(value);
+        } else if (option == "--seed") {
+            seed = (unsigned int) std::atoi(value.c_str());
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    PrologExecutor::createEngine(std::string(argv[0]));
+
+    BenchmarkReport report;
+    for(int scale: scales) {
+        SyntheticMachine::Parameters params;
+        params.numContainers = scale;
+        params.numPumps = (int) (scale * pumpsRatio);
+        params.numValves = (int) (scale * valvesRatio);
+        params.numTubes = (int) (scale * tubesRatio);
+        params.branching = branching;
+        params.seed = seed;
+
+        SyntheticMachine machine(params);
+        std::vector<std::unordered_map<std::string, long long>> queries = machine.generateQueries(numQueries, seed);
+
+        for(const std::string & backend: backends) {
+            try {
+                BenchmarkReport::Row row;
+                row.backend = backend;
+                row.numVariables = machine.getNumVariables();
+                row.programBytes = 0;
+                row.numSolved = 0;
+
+                std::unique_ptr<AstTranslationStack> stack(createStack(backend));
+                Clock::time_point start = Clock::now();
+                machine.translate(stack.get());
+                row.translationMs = elapsedMs(start);
+
+                row.numRestrictions = (int) stack->getRestrictionRoots().size();
+                row.astNodes = stack->getAst().getNumNodes();
+                PrologTranslationStack* textStack = dynamic_cast<PrologTranslationStack*>(stack.get());
+                if (textStack != NULL) {
+                    row.programBytes = textStack->generateProgram().size();
+                }
+
+                start = Clock::now();
+                std::unique_ptr<RoutingEngine> engine(stack->getRoutingEngine());
+                row.loadMs = elapsedMs(start);
+
+                row.latenciesUs.reserve(queries.size());
+                for(const std::unordered_map<std::string, long long> & query: queries) {
+                    std::unordered_map<std::string, long long> outStates;
+                    start = Clock::now();
+                    if (engine->calculateNewRoute(query, outStates)) {
+                        row.numSolved++;
+                    }
+                    row.latenciesUs.push_back(elapsedMs(start) * 1000.0);
+                }
+                report.addRow(row);
+            } catch (std::runtime_error & e) {
+                std::cerr << "scale " << scale << ", backend " << backend << ": " << e.what() << std::endl;
+            }
+        }
+    }
+
+    report.print(std::cout);
+
+    PrologExecutor::destoryEngine();
+    return 0;
+}
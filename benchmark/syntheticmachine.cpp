@@ -0,0 +1,145 @@
+#include "syntheticmachine.h"
+
+#include <algorithm>
+#include <random>
+
+SyntheticMachine::SyntheticMachine(const Parameters & params) :
+    params(params)
+{
+    std::mt19937 generator(params.seed);
+    int numContainers = std::max(2, params.numContainers);
+    int branching = std::max(1, params.branching);
+    int numTubes = std::max(1, params.numTubes);
+
+    //the tree first, then random pairs
+    for(int child = 1; child < numContainers && (int) tubes.size() < numTubes; child++) {
+        tubes.push_back(std::make_pair((child - 1) / branching, child));
+    }
+    std::uniform_int_distribution<int> containerDistribution(0, numContainers - 1);
+    while ((int) tubes.size() < numTubes) {
+        int a = containerDistribution(generator);
+        int b = containerDistribution(generator);
+        if (a != b) {
+            tubes.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+        }
+    }
+
+    int numPumps = std::max(1, std::min(params.numPumps, (int) tubes.size()));
+    tubePump.assign(tubes.size(), -1);
+    for(int pump = 0; pump < numPumps; pump++) {
+        tubePump[(pump * tubes.size()) / numPumps] = pump;
+    }
+
+    //the valves go to the containers with more tubes
+    std::vector<std::vector<int>> containerTubes(numContainers);
+    for(int tube = 0; tube < (int) tubes.size(); tube++) {
+        containerTubes[tubes[tube].first].push_back(tube);
+    }
+    std::vector<int> candidates;
+    for(int container = 0; container < numContainers; container++) {
+        if (containerTubes[container].size() > 1) {
+            candidates.push_back(container);
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [&containerTubes](int a, int b) {
+        return containerTubes[a].size() > containerTubes[b].size();
+    });
+    for(int i = 0; i < params.numValves && i < (int) candidates.size(); i++) {
+        valveTubes.push_back(containerTubes[candidates[i]]);
+    }
+
+    this->params.numContainers = numContainers;
+    this->params.numTubes = (int) tubes.size();
+    this->params.numPumps = numPumps;
+    this->params.numValves = (int) valveTubes.size();
+}
+
+SyntheticMachine::~SyntheticMachine() {
+
+}
+
+void SyntheticMachine::translate(TranslationStack* stack) const {
+    for(int container = 0; container < params.numContainers; container++) {
+        stackDomain(stack, VariableNominator::getContainerVarName(container), 0, 1);
+    }
+    for(int pump = 0; pump < params.numPumps; pump++) {
+        stackDomain(stack, VariableNominator::getPumpVarName(pump), -1, 1);
+    }
+    for(int valve = 0; valve < params.numValves; valve++) {
+        stackDomain(stack, VariableNominator::getValveVarName(valve), 0, (int) valveTubes[valve].size());
+    }
+
+    for(int tube = 0; tube < (int) tubes.size(); tube++) {
+        std::string name = tubeName(tube);
+        stackDomain(stack, name, -1, 1);
+
+        //(F #= 0) #\/ ((C_a #= 1) #/\ (C_b #= 1))
+        stackComparison(stack, name, Equality::equal, 0);
+        stackComparison(stack, VariableNominator::getContainerVarName(tubes[tube].first), Equality::equal, 1);
+        stackComparison(stack, VariableNominator::getContainerVarName(tubes[tube].second), Equality::equal, 1);
+        stack->stackBooleanConjuction(Conjunction::predicate_and);
+        stack->stackBooleanConjuction(Conjunction::predicate_or);
+        stack->addHeadToRestrictions();
+
+        if (tubePump[tube] != -1) {
+            //F #= P
+            stack->stackVariable(name);
+            stack->stackVariable(VariableNominator::getPumpVarName(tubePump[tube]));
+            stack->stackEquality(Equality::equal);
+            stack->addHeadToRestrictions();
+        } else {
+            //(F #= 0) #\/ (abs(P) #>= 1)
+            stackComparison(stack, name, Equality::equal, 0);
+            stack->stackVariable(VariableNominator::getPumpVarName(tube % params.numPumps));
+            stack->stackArithmeticUnaryOperation(RuleUnaryOperation::absolute_value);
+            stack->stackNumber(1);
+            stack->stackEquality(Equality::bigger_equal);
+            stack->stackBooleanConjuction(Conjunction::predicate_or);
+            stack->addHeadToRestrictions();
+        }
+    }
+
+    for(int valve = 0; valve < params.numValves; valve++) {
+        for(int position = 0; position < (int) valveTubes[valve].size(); position++) {
+            //(F #= 0) #\/ (V #= k)
+            stackComparison(stack, tubeName(valveTubes[valve][position]), Equality::equal, 0);
+            stackComparison(stack, VariableNominator::getValveVarName(valve), Equality::equal, position + 1);
+            stack->stackBooleanConjuction(Conjunction::predicate_or);
+            stack->addHeadToRestrictions();
+        }
+    }
+}
+
+std::vector<std::unordered_map<std::string, long long>> SyntheticMachine::generateQueries(int numQueries, unsigned int seed) const {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> tubeDistribution(0, (int) tubes.size() - 1);
+    std::uniform_int_distribution<int> directionDistribution(0, 1);
+
+    std::vector<std::unordered_map<std::string, long long>> queries(numQueries);
+    for(std::unordered_map<std::string, long long> & query: queries) {
+        query[tubeName(tubeDistribution(generator))] = directionDistribution(generator) ? 1 : -1;
+    }
+    return queries;
+}
+
+int SyntheticMachine::getNumVariables() const {
+    return params.numContainers + params.numPumps + params.numValves + params.numTubes;
+}
+
+std::string SyntheticMachine::tubeName(int tube) const {
+    return VariableNominator::getTubeVarName(tubes[tube].first, tubes[tube].second) + "_" + std::to_string(tube);
+}
+
+void SyntheticMachine::stackDomain(TranslationStack* stack, const std::string & name, int min, int max) const {
+    stack->stackNumber(min);
+    stack->stackNumber(max);
+    stack->stackVariable(name);
+    stack->stackVarDomain();
+    stack->addHeadToRestrictions();
+}
+
+void SyntheticMachine::stackComparison(TranslationStack* stack, const std::string & name, Equality::ComparatorOp op, int value) const {
+    stack->stackVariable(name);
+    stack->stackNumber(value);
+    stack->stackEquality(op);
+}
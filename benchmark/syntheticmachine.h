@@ -0,0 +1,109 @@
+#ifndef SYNTHETICMACHINE_H
+#define SYNTHETICMACHINE_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fluidicmachinemodel/constraintssolverinterface/translationstack.h>
+#include <fluidicmachinemodel/machine_graph_utils/variablenominator.h>
+#include <fluidicmachinemodel/rules/conjunction.h>
+#include <fluidicmachinemodel/rules/arithmetic/unaryoperation.h>
+#include <fluidicmachinemodel/rules/equality.h>
+
+/**
+ * @brief The SyntheticMachine class generates the rules of a parameterized fluidic machine and sends them to a TranslationStack.
+ *
+ * The containers are connected as a tree where every container has up to branching children, a tube for each edge, and the extra
+ * tubes connect random pairs of containers. The pumps are spread evenly among the tubes, and every valve is placed at a container with
+ * more than one tube and selects which one of them can have flow. The generated rules are:
+ *
+ * - the domain of every variable: containers 0..1, tubes and pumps -1..1, valves 0..number of tubes of the valve.
+ * - a tube with flow needs both containers in use: (F #= 0) #\/ ((C_a #= 1) #/\ (C_b #= 1)).
+ * - a tube with a pump has the flow of the pump: F #= P.
+ * - a tube without a pump needs a pump working: (F #= 0) #\/ (abs(P) #>= 1).
+ * - a tube controlled by a valve needs the valve in its position: (F #= 0) #\/ (V #= k).
+ *
+ * The machine is not meant to be physically meaningful, only to have the size and the shape of the rules of a real one.
+ */
+class SyntheticMachine
+{
+public:
+    /**
+     * @brief The Parameters struct size of the machine.
+     */
+    typedef struct Parameters {
+        int numContainers;
+        int numPumps;
+        int numValves;
+        int numTubes;
+        int branching;
+        unsigned int seed;
+    } Parameters;
+
+    /**
+     * @brief SyntheticMachine creates the topology of a new machine.
+     * @param params size of the machine, the number of pumps, valves and tubes are limited by the number of containers.
+     */
+    SyntheticMachine(const Parameters & params);
+    virtual ~SyntheticMachine();
+
+    /**
+     * @brief translate sends all the rules of the machine to a translation stack.
+     * @param stack stack where the rules are translated.
+     */
+    void translate(TranslationStack* stack) const;
+    /**
+     * @brief generateQueries creates random inputs for calculateNewRoute, each one sets the flow of a random tube.
+     * @param numQueries number of inputs to generate.
+     * @param seed seed of the random generator.
+     * @return the inputs.
+     */
+    std::vector<std::unordered_map<std::string, long long>> generateQueries(int numQueries, unsigned int seed) const;
+
+    /**
+     * @brief getNumVariables returns the number of variables of the machine.
+     */
+    int getNumVariables() const;
+    /**
+     * @brief getParameters returns the size of the machine, with the numbers actually generated.
+     */
+    inline const Parameters & getParameters() const {
+        return params;
+    }
+
+protected:
+    /**
+     * @brief params size of the machine.
+     */
+    Parameters params;
+    /**
+     * @brief tubes containers connected by every tube.
+     */
+    std::vector<std::pair<int, int>> tubes;
+    /**
+     * @brief tubePump pump of every tube, -1 if the tube has no pump.
+     */
+    std::vector<int> tubePump;
+    /**
+     * @brief valveTubes tubes controlled by every valve.
+     */
+    std::vector<std::vector<int>> valveTubes;
+
+    /**
+     * @brief tubeName returns the name of the variable of a tube.
+     */
+    std::string tubeName(int tube) const;
+
+    /**
+     * @brief stackDomain translates: name in min..max.
+     */
+    void stackDomain(TranslationStack* stack, const std::string & name, int min, int max) const;
+    /**
+     * @brief stackComparison stacks: name op value.
+     */
+    void stackComparison(TranslationStack* stack, const std::string & name, Equality::ComparatorOp op, int value) const;
+};
+
+#endif // SYNTHETICMACHINE_H
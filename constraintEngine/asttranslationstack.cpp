@@ -0,0 +1,133 @@
+#include "asttranslationstack.h"
+
+#include "constraintprogramfile.h"
+
+AstTranslationStack::AstTranslationStack() {
+    this->presolve = false;
+    this->presolved = false;
+    this->presolveStats = ConstraintPresolver::Stats();
+    this->variablesBuilt = false;
+}
+
+AstTranslationStack::~AstTranslationStack() {
+
+}
+
+void AstTranslationStack::pop() {
+    stack.pop_back();
+}
+
+void AstTranslationStack::clear() {
+    stack.clear();
+}
+
+void AstTranslationStack::addHeadToRestrictions() {
+    restrictions.push_back(popNode());
+    presolved = false;
+}
+
+void AstTranslationStack::stackVariable(const std::string & name) {
+    int varId = ast.internVariable(name);
+    stack.push_back(ast.addVariable(varId));
+    if (varTable.insert(name).second) {
+        variablesBuilt = false;
+    }
+}
+
+void AstTranslationStack::stackNumber(int value) {
+    stack.push_back(ast.addNumber(value));
+}
+
+void AstTranslationStack::stackArithmeticBinaryOperation(int arithmeticOp) {
+    stackBinaryNode(ConstraintAst::binary_node, arithmeticOp);
+}
+
+void AstTranslationStack::stackArithmeticUnaryOperation(int unaryOp) {
+    ConstraintAst::NodeId operand = popNode();
+    stack.push_back(ast.addNode(ConstraintAst::unary_node, unaryOp, &operand, 1));
+}
+
+void AstTranslationStack::stackEquality(int op) {
+    stackBinaryNode(ConstraintAst::equality_node, op);
+}
+
+void AstTranslationStack::stackBooleanConjuction(int booleanOp) {
+    stackBinaryNode(ConstraintAst::conjunction_node, booleanOp);
+}
+
+void AstTranslationStack::stackImplication() {
+    stackBinaryNode(ConstraintAst::implication_node, 0);
+}
+
+void AstTranslationStack::stackVarDomain() {
+    ConstraintAst::NodeId variable = popNode();
+
+    if((stack.size() % 2) == 0) {
+        std::vector<ConstraintAst::NodeId> children;
+        children.reserve(stack.size() + 1);
+        children.push_back(variable);
+        while(!stack.empty()) {
+            ConstraintAst::NodeId max = popNode();
+            ConstraintAst::NodeId min = popNode();
+            children.push_back(min);
+            children.push_back(max);
+        }
+        stack.push_back(ast.addNode(ConstraintAst::domain_node, 0, children));
+    } else {
+        stack.clear();
+        stack.push_back(ast.addError());
+    }
+}
+
+ConstraintAst::NodeId AstTranslationStack::popNode() {
+    ConstraintAst::NodeId id = stack.back();
+    stack.pop_back();
+    return id;
+}
+
+void AstTranslationStack::stackBinaryNode(ConstraintAst::NodeKind kind, int op) {
+    ConstraintAst::NodeId right = popNode();
+    ConstraintAst::NodeId left = popNode();
+
+    ConstraintAst::NodeId children[] = {left, right};
+    stack.push_back(ast.addNode(kind, op, children, 2));
+}
+
+const VariableTable & AstTranslationStack::getVariableTable() {
+    if (!variablesBuilt) {
+        variables = VariableTable(varTable);
+        variablesBuilt = true;
+    }
+    return variables;
+}
+
+ConflictExplainer* AstTranslationStack::getConflictExplainer() throw(std::runtime_error) {
+    if (!stack.empty()) {
+        throw(std::runtime_error("AstTranslationStack::getConflictExplainer(). The stack is not empty, there is a restriction being translated"));
+    }
+    prepareRestrictions();
+    return new ConflictExplainer(ast, restrictions, getVariableTable());
+}
+
+void AstTranslationStack::saveProgram(const std::string & path) throw(std::runtime_error) {
+    if (!stack.empty()) {
+        throw(std::runtime_error("AstTranslationStack::saveProgram(). The stack is not empty, there is a restriction being translated"));
+    }
+    prepareRestrictions();
+    ConstraintProgramFile::save(path, ast, restrictions, varTable);
+}
+
+void AstTranslationStack::prepareRestrictions() {
+    if (!presolve || presolved || !stack.empty()) {
+        return;
+    }
+
+    ConstraintAst presolvedAst;
+    std::vector<ConstraintAst::NodeId> presolvedRestrictions;
+    ConstraintPresolver presolver;
+    presolveStats = presolver.presolve(ast, restrictions, presolvedAst, presolvedRestrictions);
+
+    std::swap(ast, presolvedAst);
+    restrictions.swap(presolvedRestrictions);
+    presolved = true;
+}
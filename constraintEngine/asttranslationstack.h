@@ -0,0 +1,219 @@
+#ifndef ASTTRANSLATIONSTACK_H
+#define ASTTRANSLATIONSTACK_H
+
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fluidicmachinemodel/constraintssolverinterface/translationstack.h>
+#include <fluidicmachinemodel/rules/conjunction.h>
+#include <fluidicmachinemodel/rules/arithmetic/binaryoperation.h>
+#include <fluidicmachinemodel/rules/arithmetic/unaryoperation.h>
+#include <fluidicmachinemodel/rules/equality.h>
+
+#include "constraintengine/conflictexplainer.h"
+#include "constraintengine/constraintast.h"
+#include "constraintengine/constraintpresolver.h"
+#include "constraintengine/variabletable.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The AstTranslationStack class translates a set of abstract rules to a ConstraintAst.
+ *
+ * The AstTranslationStack class implements the callbacks of the TranslationStack interface at the FluidicMachineModel library, but
+ * instead of building a string for each rule it adds nodes to a ConstraintAst: the stack only holds the ids of the nodes, so pushing
+ * and popping never copies a subtree. Subclasses decide how the translated restrictions are turned into a RoutingEngine by
+ * implementing getRoutingEngine().
+ *
+ * Optionally the restrictions are simplified by a ConstraintPresolver before the RoutingEngine is created, see setPresolve().
+ *
+ * @sa TranslationStack, @sa ConstraintAst
+ */
+class ASTTRANSLATIONSTACK_EXPORT AstTranslationStack : public TranslationStack
+{
+public:
+    /**
+     * @brief AstTranslationStack creates a new empty stack.
+     */
+    AstTranslationStack();
+    /**
+     * @brief ~AstTranslationStack destroys the stack.
+     */
+    virtual ~AstTranslationStack();
+
+    /**
+     * @brief pop removes the top of the stack
+     */
+    virtual void pop();
+    /**
+     * @brief clears the stack
+     */
+    virtual void clear();
+    /**
+     * @brief addHeadToRestrictions adds the node at the top of the stack to the restrictions vector and removes it from the stack.
+     */
+    virtual void addHeadToRestrictions();
+    /**
+     * @brief stackVariable adds to the top of the stack a new variable node, also adds this variable to the variable table.
+     * @param name name of the variable to be stack
+     */
+    virtual void stackVariable(const std::string & name);
+    /**
+     * @brief stackNumber adds to the top of the stack a new number node.
+     * @param value integer value to be stacked.
+     */
+    virtual void stackNumber(int value);
+    /**
+     * @brief stackArithmeticBinaryOperation removes the two nodes at the top of the stack and stacks a new node with the operation
+     * that has them as operands.
+     * @param arithmeticOp BinaryOperation::BinaryOperators value of the operation.
+     */
+    virtual void stackArithmeticBinaryOperation(int arithmeticOp);
+    /**
+     * @brief stackArithmeticUnaryOperation removes the node at the top of the stack and stacks a new node with the operation
+     * that has it as operand.
+     * @param unaryOp RuleUnaryOperation::UnaryOperators value of the operation.
+     */
+    virtual void stackArithmeticUnaryOperation(int unaryOp);
+    /**
+     * @brief stackEquality removes the two nodes at the top of the stack and stacks a new comparison node between them.
+     * @param op Equality::ComparatorOp value of the comparison.
+     */
+    virtual void stackEquality(int op);
+    /**
+     * @brief stackBooleanConjuction removes the two nodes at the top of the stack and stacks a new boolean node between them.
+     * @param booleanOp Conjunction::BoolOperators value of the boolean operation.
+     */
+    virtual void stackBooleanConjuction(int booleanOp);
+    /**
+     * @brief stackImplication deprecated, to be removed
+     */
+    virtual void stackImplication();
+    /**
+     * @brief stackVarDomain creates a new variable domain node with all the nodes of the stack.
+     *
+     * The top of the stack is the variable and the rest of the stack are pairs of max, min bounds. If the size of the rest of
+     * the stack is not even the stack is cleared and an error node is stacked.
+     */
+    virtual void stackVarDomain();
+
+    /**
+     * @brief getAst returns the tree with all the translated restrictions.
+     */
+    inline const ConstraintAst & getAst() const {
+        return ast;
+    }
+    /**
+     * @brief getRestrictionRoots returns the id of the root node of every translated restriction, in order of translation.
+     */
+    inline const std::vector<ConstraintAst::NodeId> & getRestrictionRoots() const {
+        return restrictions;
+    }
+    /**
+     * @brief getVarTable returns the varTable
+     * @return a constant reference to the varTable attribute.
+     *
+     * @sa varTable
+     */
+    inline const std::set<std::string> & getVarTable() const {
+        return varTable;
+    }
+
+    /**
+     * @brief setPresolve enables or disables the presolve of the restrictions, disabled by default.
+     *
+     * If enabled the translated restrictions are replaced by the simplified ones the first time they are turned into a RoutingEngine,
+     * the restrictions translated afterwards are simplified again together with them.
+     *
+     * @sa ConstraintPresolver
+     */
+    inline void setPresolve(bool presolve) {
+        this->presolve = presolve;
+    }
+    /**
+     * @brief getPresolveStats returns what has been removed by the last presolve, all zero if there has been none.
+     */
+    inline const ConstraintPresolver::Stats & getPresolveStats() const {
+        return presolveStats;
+    }
+    /**
+     * @brief getVariableTable returns the symbol table of the variables of varTable, it is built again only if a new variable has
+     * been stacked since the last call, so the same table is used to generate a program and to create its RoutingEngine.
+     */
+    const VariableTable & getVariableTable();
+    /**
+     * @brief getConflictExplainer creates a ConflictExplainer for the translated restrictions, presolved if the presolve is enabled,
+     * so the restrictions of a conflict are numbered as the restrictions given to the RoutingEngine. A runtime_error is thrown if the
+     * stack is not empty or a restriction is malformed. The caller must free the memory.
+     */
+    ConflictExplainer* getConflictExplainer() throw(std::runtime_error);
+    /**
+     * @brief saveProgram writes the translated restrictions to a ConstraintProgramFile, presolved if the presolve is enabled, so the
+     * machine can be loaded later without translating it again. A runtime_error is thrown if the stack is not empty or the file can
+     * not be written.
+     * @param path path of the file, it is overwritten.
+     */
+    void saveProgram(const std::string & path) throw(std::runtime_error);
+
+protected:
+    /**
+     * @brief ast arena with the nodes of all the restrictions.
+     */
+    ConstraintAst ast;
+    /**
+     * @brief stack ids of the nodes being translated.
+     */
+    std::vector<ConstraintAst::NodeId> stack;
+    /**
+     * @brief restrictions ids of the root node of every translated restriction, filled by addHeadToRestrictions().
+     */
+    std::vector<ConstraintAst::NodeId> restrictions;
+    /**
+     * @brief varTable set of strings that contains all the variables used in the rules.
+     *
+     * The names are inserted one by one while the rules are stacked, and a VariableTable is a sorted array that is not modified once
+     * built, so the set stays as the builder of the table and as the result of getVarTable(). Everything created from the stack uses
+     * the single table built from it by getVariableTable().
+     */
+    std::set<std::string> varTable;
+    /**
+     * @brief variables symbol table built from varTable by getVariableTable().
+     */
+    VariableTable variables;
+    /**
+     * @brief variablesBuilt true if variables has the same names as varTable.
+     */
+    bool variablesBuilt;
+    /**
+     * @brief presolve true if the restrictions must be simplified before creating a RoutingEngine.
+     */
+    bool presolve;
+    /**
+     * @brief presolved true if the restrictions have not changed since they were simplified.
+     */
+    bool presolved;
+    ConstraintPresolver::Stats presolveStats;
+
+    /**
+     * @brief prepareRestrictions replaces ast and restrictions with the simplified ones if the presolve is enabled and they have
+     * changed, must be called by the subclasses before using them to create a RoutingEngine.
+     *
+     * Nothing is done while the stack is not empty, as its nodes are ids of the old tree.
+     */
+    void prepareRestrictions();
+    /**
+     * @brief popNode removes the node at the top of the stack.
+     * @return the id of the removed node.
+     */
+    ConstraintAst::NodeId popNode();
+    /**
+     * @brief stackBinaryNode removes the two nodes at the top of the stack and stacks a new node of the given kind with them as children.
+     * @param kind kind of the new node.
+     * @param op operator of the new node.
+     */
+    void stackBinaryNode(ConstraintAst::NodeKind kind, int op);
+};
+
+#endif // ASTTRANSLATIONSTACK_H
@@ -0,0 +1,64 @@
+#include "compiledprogramcache.h"
+
+CompiledProgramCache::CompiledProgramCache(const std::string & directory) throw(std::runtime_error) {
+    this->directory = directory;
+
+    QDir dir(QString::fromStdString(directory));
+    if (!dir.exists() && !dir.mkpath(".")) {
+        throw(std::runtime_error("CompiledProgramCache::CompiledProgramCache(). Impossible to create the directory " + directory));
+    }
+}
+
+CompiledProgramCache::~CompiledProgramCache() {
+
+}
+
+std::string CompiledProgramCache::makeKey(const std::string & restrictionsHash, const std::set<std::string> & varTable) const {
+    QCryptographicHash hashFunction(QCryptographicHash::Sha1);
+    //every string is added with its terminating null, so the strings can not run into each other
+    std::string version = prologVersion();
+    hashFunction.addData(COMPILED_PROGRAM_FORMAT, (int) sizeof(COMPILED_PROGRAM_FORMAT));
+    hashFunction.addData(version.c_str(), (int) version.size() + 1);
+    hashFunction.addData(restrictionsHash.c_str(), (int) restrictionsHash.size() + 1);
+    for(const std::string & var: varTable) {
+        hashFunction.addData(var.c_str(), (int) var.size() + 1);
+    }
+    return hashFunction.result().toHex().toStdString();
+}
+
+bool CompiledProgramCache::contains(const std::string & key) const {
+    return QFile::exists(QString::fromStdString(getCompiledPath(key)));
+}
+
+void CompiledProgramCache::remove(const std::string & key) const {
+    QFile::remove(QString::fromStdString(getCompiledPath(key)));
+    QFile::remove(QString::fromStdString(getSourcePath(key)));
+}
+
+void CompiledProgramCache::clear() const {
+    QDir dir(QString::fromStdString(directory));
+    for(const QString & name: dir.entryList(QStringList() << "machine_*.pl" << "machine_*.qlf", QDir::Files)) {
+        dir.remove(name);
+    }
+}
+
+std::string CompiledProgramCache::getSourcePath(const std::string & key) const {
+    return QDir(QString::fromStdString(directory)).filePath(QString::fromStdString("machine_" + key + ".pl")).toStdString();
+}
+
+std::string CompiledProgramCache::getCompiledPath(const std::string & key) const {
+    return QDir(QString::fromStdString(directory)).filePath(QString::fromStdString("machine_" + key + ".qlf")).toStdString();
+}
+
+std::string CompiledProgramCache::prologVersion() {
+    try {
+        PlTerm value;
+        PlTermv av(PlAtom("version"), value);
+        if (PlCall("current_prolog_flag", av)) {
+            return std::to_string((long) av[1]);
+        }
+    } catch (PlException ex) {
+        //the key is still valid for this interpreter, only a change of version could go unnoticed
+    }
+    return std::string();
+}
@@ -0,0 +1,98 @@
+#ifndef COMPILEDPROGRAMCACHE_H
+#define COMPILEDPROGRAMCACHE_H
+
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+#define PL_SAFE_ARG_MACROS //define this flag so SWI-cpp macros dont colide with boost one
+#include <SWI-cpp.h>
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief COMPILED_PROGRAM_FORMAT version of the layout of the generated programs, it is part of every key so the compiled programs
+ * of a previous layout are never loaded.
+ */
+#define COMPILED_PROGRAM_FORMAT "1"
+
+/**
+ * @brief The CompiledProgramCache class is a directory with the programs of the machines compiled to the quick load format of swi-prolog.
+ *
+ * Consulting the text of a program means parsing it and expanding every clpfd restriction, which for big machines takes a good part
+ * of the startup. The CompiledProgramCache class keeps, for every program, the source and the .qlf file written by qcompile/1, so
+ * later executions load the compiled clauses directly.
+ *
+ * Every program is identified by a key, the SHA-1 of the hash of its restrictions, the names of all its variables, the version of
+ * swi-prolog and COMPILED_PROGRAM_FORMAT. A change in any of them gives a new key, so an outdated entry is never loaded and the
+ * cache never needs to be invalidated by hand, old entries are just not used anymore and can be removed with clear().
+ *
+ * The files of a key are written by PrologExecutor, this class only resolves the paths.
+ *
+ * @sa PrologExecutor
+ */
+class COMPILEDPROGRAMCACHE_EXPORT CompiledProgramCache
+{
+public:
+    /**
+     * @brief CompiledProgramCache creates a cache on a directory, the directory is created if it does not exist.
+     * @param directory path of the directory.
+     */
+    CompiledProgramCache(const std::string & directory) throw(std::runtime_error);
+    virtual ~CompiledProgramCache();
+
+    /**
+     * @brief makeKey returns the key of a program, the swi-prolog engine must be created.
+     * @param restrictionsHash hash of the restrictions of the program, as returned by ConstraintAst::hash().
+     * @param varTable names of the variables of the program, in alphabetical order.
+     * @return hexadecimal string with the key.
+     */
+    std::string makeKey(const std::string & restrictionsHash, const std::set<std::string> & varTable) const;
+
+    /**
+     * @brief contains returns true if the compiled program of a key exists.
+     */
+    bool contains(const std::string & key) const;
+    /**
+     * @brief remove deletes the files of a key, used when the compiled program can not be loaded.
+     */
+    void remove(const std::string & key) const;
+    /**
+     * @brief clear deletes the files of all the keys.
+     */
+    void clear() const;
+
+    /**
+     * @brief getSourcePath returns the path of the text of the program of a key.
+     */
+    std::string getSourcePath(const std::string & key) const;
+    /**
+     * @brief getCompiledPath returns the path of the compiled program of a key.
+     */
+    std::string getCompiledPath(const std::string & key) const;
+    /**
+     * @brief getDirectory returns the path of the directory of the cache.
+     */
+    inline const std::string & getDirectory() const {
+        return directory;
+    }
+
+protected:
+    /**
+     * @brief directory path of the directory of the cache.
+     */
+    std::string directory;
+
+    /**
+     * @brief prologVersion returns the version flag of the swi-prolog interpreter, the format of the .qlf files depends on it.
+     */
+    static std::string prologVersion();
+};
+
+#endif // COMPILEDPROGRAMCACHE_H
@@ -0,0 +1,150 @@
+#include "conflictexplainer.h"
+
+ConflictExplainer::ConflictExplainer(const ConstraintAst & ast,
+                                     const std::vector<ConstraintAst::NodeId> & restrictions,
+                                     const VariableTable & varTable)
+    throw(std::runtime_error) :
+    solver(ast, restrictions, varTable)
+{
+    groupOf.assign(restrictions.size(), -1);
+    std::vector<int> groups;
+    groups.reserve(restrictions.size());
+    for(int r = 0; r < (int) restrictions.size(); r++) {
+        bool isDomain = (ast.getNode(restrictions[r]).kind == ConstraintAst::domain_node);
+        groups.push_back(isDomain ? -1 : r);
+    }
+    setGroups(groups);
+}
+
+ConflictExplainer::~ConflictExplainer() {
+
+}
+
+void ConflictExplainer::setGroups(const std::vector<int> & groups) throw(std::runtime_error) {
+    if (groups.size() != groupOf.size()) {
+        throw(std::runtime_error("ConflictExplainer::setGroups(). There must be a group for every restriction"));
+    }
+
+    int maxGroup = -1;
+    for(int group: groups) {
+        if (group < -1) {
+            throw(std::runtime_error("ConflictExplainer::setGroups(). Invalid group " + std::to_string(group)));
+        }
+        maxGroup = std::max(maxGroup, group);
+    }
+
+    groupOf = groups;
+    groupMembers.assign(maxGroup + 1, std::vector<int>());
+    for(int r = 0; r < (int) groups.size(); r++) {
+        if (groups[r] >= 0) {
+            groupMembers[groups[r]].push_back(r);
+        }
+    }
+}
+
+bool ConflictExplainer::explain(const std::unordered_map<std::string, long long> & inputStates, Conflict & conflict) const
+    throw(std::runtime_error)
+{
+    //the inputs are sorted by position so the same input gives the same conflict
+    std::vector<std::pair<int, long long>> inputs;
+    inputs.reserve(inputStates.size());
+    for(const auto & statePair: inputStates) {
+        int pos = solver.getVarPosition(statePair.first);
+        if (pos < 0) {
+            throw(std::runtime_error("ConflictExplainer::explain(). Unknown variable " + statePair.first));
+        }
+        inputs.push_back(std::make_pair(pos, statePair.second));
+    }
+    std::sort(inputs.begin(), inputs.end());
+
+    Problem problem;
+    problem.numChecks = 0;
+    std::vector<Candidate> candidates;
+    for(int i = 0; i < (int) inputs.size(); i++) {
+        problem.inputPositions.push_back(inputs[i].first);
+        problem.inputValues.push_back(inputs[i].second);
+        candidates.push_back(Candidate{true, i});
+    }
+    for(int group = 0; group < (int) groupMembers.size(); group++) {
+        if (!groupMembers[group].empty()) {
+            candidates.push_back(Candidate{false, group});
+        }
+    }
+
+    if (isFeasible(problem, candidates)) {
+        return false;
+    }
+
+    conflict.inputs.clear();
+    conflict.groups.clear();
+    //if the background alone has no solution the conflict is empty
+    if (isFeasible(problem, std::vector<Candidate>())) {
+        std::vector<Candidate> minimal = quickXplain(problem, std::vector<Candidate>(), false, candidates);
+        for(const Candidate & candidate: minimal) {
+            if (candidate.isInput) {
+                conflict.inputs.push_back(solver.getVarNames()[problem.inputPositions[candidate.index]]);
+            } else {
+                conflict.groups.push_back(candidate.index);
+            }
+        }
+        std::sort(conflict.groups.begin(), conflict.groups.end());
+    }
+    conflict.numChecks = problem.numChecks;
+    return true;
+}
+
+bool ConflictExplainer::isFeasible(Problem & problem, const std::vector<Candidate> & candidates) const throw(std::runtime_error) {
+    std::vector<char> enabled(groupOf.size(), 0);
+    for(int r = 0; r < (int) groupOf.size(); r++) {
+        if (groupOf[r] == -1) {
+            enabled[r] = 1;
+        }
+    }
+
+    std::vector<int> inputPositions;
+    std::vector<long long> inputValues;
+    for(const Candidate & candidate: candidates) {
+        if (candidate.isInput) {
+            inputPositions.push_back(problem.inputPositions[candidate.index]);
+            inputValues.push_back(problem.inputValues[candidate.index]);
+        } else {
+            for(int r: groupMembers[candidate.index]) {
+                enabled[r] = 1;
+            }
+        }
+    }
+
+    problem.numChecks++;
+    return solver.isFeasible(inputPositions, inputValues, enabled);
+}
+
+std::vector<ConflictExplainer::Candidate> ConflictExplainer::quickXplain(Problem & problem,
+                                                                         const std::vector<Candidate> & background,
+                                                                         bool added,
+                                                                         const std::vector<Candidate> & candidates) const
+    throw(std::runtime_error)
+{
+    if (added && !isFeasible(problem, background)) {
+        return std::vector<Candidate>();
+    }
+    if (candidates.size() == 1) {
+        return candidates;
+    }
+
+    std::size_t half = candidates.size() / 2;
+    std::vector<Candidate> first(candidates.begin(), candidates.begin() + half);
+    std::vector<Candidate> second(candidates.begin() + half, candidates.end());
+
+    //the conflict part of the second half is searched with the whole first half enforced, then the part of the first half with
+    //only the part of the second half found
+    std::vector<Candidate> firstBackground = background;
+    firstBackground.insert(firstBackground.end(), first.begin(), first.end());
+    std::vector<Candidate> secondConflict = quickXplain(problem, firstBackground, true, second);
+
+    std::vector<Candidate> secondBackground = background;
+    secondBackground.insert(secondBackground.end(), secondConflict.begin(), secondConflict.end());
+    std::vector<Candidate> firstConflict = quickXplain(problem, secondBackground, !secondConflict.empty(), first);
+
+    firstConflict.insert(firstConflict.end(), secondConflict.begin(), secondConflict.end());
+    return firstConflict;
+}
@@ -0,0 +1,135 @@
+#ifndef CONFLICTEXPLAINER_H
+#define CONFLICTEXPLAINER_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "constraintengine/constraintast.h"
+#include "constraintengine/nativeconstraintsolver.h"
+#include "constraintengine/variabletable.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The ConflictExplainer class finds why a set of input states has no route.
+ *
+ * When calculateNewRoute() returns false the ConflictExplainer computes a minimal conflict: a subset of the input states and of the
+ * restrictions that has no solution, such that removing any single element of it gives a problem with solution. The conflict is
+ * computed with the QuickXplain algorithm, that needs a number of feasibility checks logarithmic in the number of candidates for
+ * every element of the conflict, instead of one check per candidate.
+ *
+ * The restrictions are grouped: the restrictions of a group are enabled and disabled together and the conflict reports the group, so
+ * all the restrictions generated for a flow or a component can be treated as a single candidate. By default every restriction is its
+ * own group, numbered as its position, and the domains of the variables are background restrictions that are always enforced, as
+ * without them the variables are unbounded. A group of -1 marks a restriction as background.
+ *
+ * The feasibility checks are done with a NativeConstraintSolver over the same restrictions, so the explainer works for any RoutingEngine
+ * created from the same tree. The explainer does not modify itself while explaining, so it can be used from several threads.
+ *
+ * @sa AstTranslationStack::getConflictExplainer, @sa NativeConstraintSolver::isFeasible
+ *
+ * @see U. Junker, "QuickXplain: Preferred Explanations and Relaxations for Over-Constrained Problems", AAAI 2004.
+ */
+class CONFLICTEXPLAINER_EXPORT ConflictExplainer
+{
+public:
+    /**
+     * @brief The Conflict struct a minimal set of input states and groups of restrictions without solution.
+     */
+    typedef struct Conflict {
+        /**
+         * @brief inputs names of the input states of the conflict.
+         */
+        std::vector<std::string> inputs;
+        /**
+         * @brief groups groups of restrictions of the conflict, in ascending order.
+         */
+        std::vector<int> groups;
+        /**
+         * @brief numChecks number of feasibility checks done to find the conflict.
+         */
+        unsigned long numChecks;
+    } Conflict;
+
+    /**
+     * @brief ConflictExplainer creates an explainer for a set of translated restrictions, the tree is copied.
+     *
+     * A runtime_error is thrown if a restriction has a malformed domain or uses a variable that is not in varTable.
+     *
+     * @param ast tree with the translated restrictions.
+     * @param restrictions id of the root node of every restriction.
+     * @param varTable name of the variables of the machine, in alphabetical order.
+     */
+    ConflictExplainer(const ConstraintAst & ast,
+                      const std::vector<ConstraintAst::NodeId> & restrictions,
+                      const VariableTable & varTable) throw(std::runtime_error);
+    virtual ~ConflictExplainer();
+
+    /**
+     * @brief setGroups sets the group of every restriction, a runtime_error is thrown if there is not one group per restriction.
+     * @param groups group of every restriction, in the order given to the constructor, -1 for the background restrictions.
+     */
+    void setGroups(const std::vector<int> & groups) throw(std::runtime_error);
+    inline const std::vector<int> & getGroups() const {
+        return groupOf;
+    }
+
+    /**
+     * @brief explain looks for a minimal conflict of a set of input states.
+     *
+     * @param inputStates map with the name as key and the value of the variables that are fixed. A runtime_error is thrown if any of
+     * the names is not a variable of the machine.
+     * @param conflict filled with the minimal conflict if the method returns true.
+     * @return true if the input states have no route, false if they have one and so there is no conflict.
+     */
+    bool explain(const std::unordered_map<std::string, long long> & inputStates, Conflict & conflict) const throw(std::runtime_error);
+
+protected:
+    /**
+     * @brief The Candidate struct an element that can be part of a conflict, an input state or a group of restrictions.
+     */
+    typedef struct Candidate {
+        bool isInput;
+        /**
+         * @brief index position of the input state at the inputs, or number of the group.
+         */
+        int index;
+    } Candidate;
+
+    /**
+     * @brief The Problem struct the input states being explained and the number of checks done.
+     */
+    typedef struct Problem {
+        std::vector<int> inputPositions;
+        std::vector<long long> inputValues;
+        unsigned long numChecks;
+    } Problem;
+
+    NativeConstraintSolver solver;
+    std::vector<int> groupOf;
+    /**
+     * @brief groupMembers restrictions of every group, indexed by the number of the group.
+     */
+    std::vector<std::vector<int>> groupMembers;
+
+    /**
+     * @brief isFeasible returns true if the background restrictions and the candidates have a solution.
+     */
+    bool isFeasible(Problem & problem, const std::vector<Candidate> & candidates) const throw(std::runtime_error);
+    /**
+     * @brief quickXplain returns a minimal subset of candidates that together with background has no solution.
+     * @param problem input states being explained.
+     * @param background candidates always enforced.
+     * @param added true if background has changed since the last check, when false background is known to have a solution.
+     * @param candidates candidates to choose from, background plus candidates must have no solution.
+     */
+    std::vector<Candidate> quickXplain(Problem & problem,
+                                       const std::vector<Candidate> & background,
+                                       bool added,
+                                       const std::vector<Candidate> & candidates) const throw(std::runtime_error);
+};
+
+#endif // CONFLICTEXPLAINER_H
@@ -0,0 +1,143 @@
+#include "constraintast.h"
+
+ConstraintAst::ConstraintAst() {
+    this->borrowedNodes = NULL;
+    this->borrowedChildren = NULL;
+    this->numBorrowedNodes = 0;
+    this->numBorrowedChildren = 0;
+}
+
+ConstraintAst::~ConstraintAst() {
+
+}
+
+int ConstraintAst::internVariable(const std::string & name) {
+    auto it = variableIds.find(name);
+    if (it != variableIds.end()) {
+        return it->second;
+    } else {
+        int id = (int) variableNames.size();
+        variableNames.push_back(name);
+        variableIds.insert(std::make_pair(name, id));
+        return id;
+    }
+}
+
+int ConstraintAst::findVariable(const std::string & name) const {
+    auto it = variableIds.find(name);
+    if (it != variableIds.end()) {
+        return it->second;
+    } else {
+        return -1;
+    }
+}
+
+ConstraintAst::NodeId ConstraintAst::addVariable(int varId) {
+    detach();
+
+    Node node;
+    node.kind = variable_node;
+    node.op = 0;
+    node.reserved = 0;
+    node.numChildren = 0;
+    node.firstChild = 0;
+    node.value = varId;
+
+    nodes.push_back(node);
+    return (NodeId) (nodes.size() - 1);
+}
+
+ConstraintAst::NodeId ConstraintAst::addNumber(long long value) {
+    detach();
+
+    Node node;
+    node.kind = number_node;
+    node.op = 0;
+    node.reserved = 0;
+    node.numChildren = 0;
+    node.firstChild = 0;
+    node.value = value;
+
+    nodes.push_back(node);
+    return (NodeId) (nodes.size() - 1);
+}
+
+ConstraintAst::NodeId ConstraintAst::addNode(NodeKind kind, int op, const std::vector<NodeId> & nodeChildren) {
+    return addNode(kind, op, nodeChildren.data(), nodeChildren.size());
+}
+
+ConstraintAst::NodeId ConstraintAst::addNode(NodeKind kind, int op, const NodeId* nodeChildren, std::size_t numChildren) {
+    detach();
+
+    Node node;
+    node.kind = kind;
+    node.op = (std::uint8_t) op;
+    node.reserved = 0;
+    node.numChildren = (std::uint32_t) numChildren;
+    node.firstChild = (std::uint32_t) children.size();
+    node.value = 0;
+
+    children.insert(children.end(), nodeChildren, nodeChildren + numChildren);
+    nodes.push_back(node);
+    return (NodeId) (nodes.size() - 1);
+}
+
+ConstraintAst::NodeId ConstraintAst::addError() {
+    return addNode(error_node, 0, NULL, 0);
+}
+
+void ConstraintAst::clear() {
+    clearNodes();
+    variableNames.clear();
+    variableIds.clear();
+}
+
+void ConstraintAst::clearNodes() {
+    nodes.clear();
+    children.clear();
+    borrowedNodes = NULL;
+    borrowedChildren = NULL;
+    numBorrowedNodes = 0;
+    numBorrowedChildren = 0;
+}
+
+void ConstraintAst::borrow(const Node* nodeData, std::size_t numNodes, const NodeId* childData, std::size_t numChildren) {
+    clearNodes();
+    borrowedNodes = nodeData;
+    borrowedChildren = childData;
+    numBorrowedNodes = numNodes;
+    numBorrowedChildren = numChildren;
+}
+
+void ConstraintAst::detach() {
+    if (borrowedNodes != NULL) {
+        nodes.assign(borrowedNodes, borrowedNodes + numBorrowedNodes);
+        children.assign(borrowedChildren, borrowedChildren + numBorrowedChildren);
+        borrowedNodes = NULL;
+        borrowedChildren = NULL;
+        numBorrowedNodes = 0;
+        numBorrowedChildren = 0;
+    }
+}
+
+std::string ConstraintAst::hash(const std::vector<NodeId> & roots) const {
+    QCryptographicHash hashFunction(QCryptographicHash::Sha1);
+    for(const std::string & name: variableNames) {
+        hashFunction.addData(name.c_str(), (int) name.size() + 1);
+    }
+    for(NodeId root: roots) {
+        hashNode(root, hashFunction);
+    }
+    return hashFunction.result().toHex().toStdString();
+}
+
+void ConstraintAst::hashNode(NodeId id, QCryptographicHash & hashFunction) const {
+    const Node & node = getNode(id);
+    hashFunction.addData((const char*) &node.kind, sizeof(node.kind));
+    hashFunction.addData((const char*) &node.op, sizeof(node.op));
+    hashFunction.addData((const char*) &node.numChildren, sizeof(node.numChildren));
+    hashFunction.addData((const char*) &node.value, sizeof(node.value));
+    for(std::uint32_t i = 0; i < node.numChildren; i++) {
+        hashNode(getChild(node, i), hashFunction);
+    }
+}
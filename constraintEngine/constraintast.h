@@ -0,0 +1,241 @@
+#ifndef CONSTRAINTAST_H
+#define CONSTRAINTAST_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QByteArray>
+#include <QCryptographicHash>
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The ConstraintAst class stores the abstract syntax tree of a set of translated restrictions in a compact arena.
+ *
+ * All the nodes of all the restrictions are stored contiguously in a single vector, and the children of every node are stored
+ * contiguously in a second vector, so building a tree is a sequence of appends without one heap allocation per node, and traversing
+ * it touches only two flat arrays. A node is identified by its position in the arena (NodeId), the children of a node must be created
+ * before the node itself.
+ *
+ * The names of the variables are interned: each distinct name gets a dense integer id in order of appearance and the variable nodes
+ * store that id instead of the name.
+ *
+ * The arena can also borrow the nodes and children of a block of memory it does not own, as a mapped ConstraintProgramFile, so a
+ * tree is loaded without copying it. A borrowed arena is copied to its own vectors the first time a node is added.
+ */
+class CONSTRAINTAST_EXPORT ConstraintAst
+{
+public:
+    /**
+     * @brief NodeId position of a node in the arena.
+     */
+    typedef std::uint32_t NodeId;
+
+    /**
+     * @brief The NodeKind enum type of a node of the tree.
+     */
+    typedef enum NodeKind_ {
+        variable_node = 0,  //value: id of the variable, no children
+        number_node,        //value: the number, no children
+        binary_node,        //op: BinaryOperation::BinaryOperators, children: left, right
+        unary_node,         //op: RuleUnaryOperation::UnaryOperators, children: operand
+        equality_node,      //op: Equality::ComparatorOp, children: left, right
+        conjunction_node,   //op: Conjunction::BoolOperators, children: left, right
+        implication_node,   //children: left, right
+        domain_node,        //children: variable, min1, max1, min2, max2...
+        error_node          //malformed domain, no children
+    } NodeKind;
+
+    /**
+     * @brief The Node struct a node of the tree, 24 bytes with no pointers so the arena can be copied or mapped as a block.
+     */
+    typedef struct Node {
+        std::uint8_t kind;
+        std::uint8_t op;
+        std::uint16_t reserved;
+        std::uint32_t numChildren;
+        std::uint32_t firstChild;
+        std::int64_t value;
+    } Node;
+
+    ConstraintAst();
+    virtual ~ConstraintAst();
+
+    /**
+     * @brief internVariable returns the id of a variable, creating a new one if the name has not been seen before.
+     * @param name name of the variable.
+     * @return dense id of the variable, the first variable gets 0.
+     */
+    int internVariable(const std::string & name);
+    /**
+     * @brief findVariable returns the id of a variable without creating it.
+     * @param name name of the variable.
+     * @return id of the variable, or -1 if the name has not been interned.
+     */
+    int findVariable(const std::string & name) const;
+    /**
+     * @brief addVariable adds a variable node.
+     * @param varId id of the variable returned by internVariable().
+     * @return id of the new node.
+     */
+    NodeId addVariable(int varId);
+    /**
+     * @brief addNumber adds a number node.
+     * @param value integer value of the node.
+     * @return id of the new node.
+     */
+    NodeId addNumber(long long value);
+    /**
+     * @brief addNode adds a node with children.
+     * @param kind type of the node.
+     * @param op operator of the node, meaning depends on the kind.
+     * @param children ids of the children, in order, already added to the arena.
+     * @return id of the new node.
+     */
+    NodeId addNode(NodeKind kind, int op, const std::vector<NodeId> & children);
+    /**
+     * @brief addNode adds a node with children.
+     * @param kind type of the node.
+     * @param op operator of the node, meaning depends on the kind.
+     * @param nodeChildren pointer to the ids of the children, in order, already added to the arena.
+     * @param numChildren number of children.
+     * @return id of the new node.
+     */
+    NodeId addNode(NodeKind kind, int op, const NodeId* nodeChildren, std::size_t numChildren);
+    /**
+     * @brief addError adds an error node.
+     * @return id of the new node.
+     */
+    NodeId addError();
+
+    /**
+     * @brief getNode returns a node of the arena.
+     * @param id id of the node.
+     * @return a constant reference to the node.
+     */
+    inline const Node & getNode(NodeId id) const {
+        return (borrowedNodes != NULL) ? borrowedNodes[id] : nodes[id];
+    }
+    /**
+     * @brief getChild returns the id of a child of a node.
+     * @param node node of the arena.
+     * @param i position of the child, from 0 to node.numChildren - 1.
+     * @return the id of the child.
+     */
+    inline NodeId getChild(const Node & node, std::uint32_t i) const {
+        return (borrowedNodes != NULL) ? borrowedChildren[node.firstChild + i] : children[node.firstChild + i];
+    }
+    /**
+     * @brief getVariableName returns the name of an interned variable.
+     * @param varId id of the variable.
+     * @return the name of the variable.
+     */
+    inline const std::string & getVariableName(int varId) const {
+        return variableNames[varId];
+    }
+    /**
+     * @brief getVariableNames returns the names of all the interned variables, ordered by id.
+     */
+    inline const std::vector<std::string> & getVariableNames() const {
+        return variableNames;
+    }
+    /**
+     * @brief getNumNodes returns the number of nodes of the arena.
+     */
+    inline std::size_t getNumNodes() const {
+        return (borrowedNodes != NULL) ? numBorrowedNodes : nodes.size();
+    }
+    /**
+     * @brief getNumChildren returns the number of ids of children of the arena.
+     */
+    inline std::size_t getNumChildren() const {
+        return (borrowedNodes != NULL) ? numBorrowedChildren : children.size();
+    }
+    /**
+     * @brief getNodeData returns a pointer to the getNumNodes() contiguous nodes of the arena.
+     */
+    inline const Node* getNodeData() const {
+        return (borrowedNodes != NULL) ? borrowedNodes : nodes.data();
+    }
+    /**
+     * @brief getChildData returns a pointer to the getNumChildren() contiguous ids of children of the arena.
+     */
+    inline const NodeId* getChildData() const {
+        return (borrowedNodes != NULL) ? borrowedChildren : children.data();
+    }
+
+    /**
+     * @brief borrow replaces the nodes of the arena with a block of memory that is not copied, the interned variables are kept.
+     *
+     * The memory must outlive the arena and every copy of it, as the copies of a borrowed arena borrow the same block.
+     *
+     * @param nodeData pointer to the nodes.
+     * @param numNodes number of nodes.
+     * @param childData pointer to the ids of the children of the nodes.
+     * @param numChildren number of ids of children.
+     */
+    void borrow(const Node* nodeData, std::size_t numNodes, const NodeId* childData, std::size_t numChildren);
+    /**
+     * @brief isBorrowed returns true if the nodes are at a block of memory that the arena does not own.
+     */
+    inline bool isBorrowed() const {
+        return borrowedNodes != NULL;
+    }
+    /**
+     * @brief detach copies the borrowed nodes to the vectors of the arena, nothing is done if they are not borrowed.
+     */
+    void detach();
+
+    /**
+     * @brief clear removes all the nodes and the interned variables, the memory of the arena is kept for reuse.
+     */
+    void clear();
+    /**
+     * @brief clearNodes removes all the nodes but keeps the interned variables, so the ids of the variables remain valid.
+     */
+    void clearNodes();
+
+    /**
+     * @brief hash calculates a hash of the trees of a set of restrictions and the names of the variables.
+     * @param roots ids of the root node of each restriction.
+     * @return hexadecimal string with the SHA-1 of the trees.
+     */
+    std::string hash(const std::vector<NodeId> & roots) const;
+
+protected:
+    /**
+     * @brief nodes arena with all the nodes.
+     */
+    std::vector<Node> nodes;
+    /**
+     * @brief children ids of the children of all the nodes, the children of a node are contiguous.
+     */
+    std::vector<NodeId> children;
+    /**
+     * @brief borrowedNodes nodes of a block of memory not owned by the arena, NULL if the nodes are at the nodes vector.
+     */
+    const Node* borrowedNodes;
+    /**
+     * @brief borrowedChildren ids of the children of the borrowed nodes.
+     */
+    const NodeId* borrowedChildren;
+    std::size_t numBorrowedNodes;
+    std::size_t numBorrowedChildren;
+    /**
+     * @brief variableNames names of the interned variables, ordered by id.
+     */
+    std::vector<std::string> variableNames;
+    /**
+     * @brief variableIds map with the name of a variable as key and its id as value.
+     */
+    std::unordered_map<std::string, int> variableIds;
+
+    /**
+     * @brief hashNode adds a node and all its descendants to a hash.
+     */
+    void hashNode(NodeId id, QCryptographicHash & hashFunction) const;
+};
+
+#endif // CONSTRAINTAST_H
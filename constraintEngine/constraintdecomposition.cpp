@@ -0,0 +1,103 @@
+#include "constraintdecomposition.h"
+
+ConstraintDecomposition::ConstraintDecomposition(const ConstraintAst & ast,
+                                                 const std::vector<ConstraintAst::NodeId> & restrictions,
+                                                 const std::set<std::string> & varTable)
+{
+    std::size_t numVars = ast.getVariableNames().size();
+    std::vector<int> parents(numVars);
+    for(std::size_t i = 0; i < numVars; i++) {
+        parents[i] = (int) i;
+    }
+
+    //variables of every restriction, the first one is the anchor of the restriction
+    std::vector<std::vector<int>> restrictionVars(restrictions.size());
+    for(std::size_t r = 0; r < restrictions.size(); r++) {
+        collectVariables(ast, restrictions[r], restrictionVars[r]);
+
+        const std::vector<int> & varIds = restrictionVars[r];
+        for(std::size_t i = 1; i < varIds.size(); i++) {
+            int a = findRoot(parents, varIds[0]);
+            int b = findRoot(parents, varIds[i]);
+            if (a != b) {
+                parents[b] = a;
+            }
+        }
+    }
+
+    //the components are numbered in order of their first restriction
+    std::vector<int> rootComponent(numVars, -1);
+    std::vector<char> usedVars(numVars, 0);
+    std::vector<ConstraintAst::NodeId> groundRestrictions;
+    for(std::size_t r = 0; r < restrictions.size(); r++) {
+        const std::vector<int> & varIds = restrictionVars[r];
+        if (varIds.empty()) {
+            groundRestrictions.push_back(restrictions[r]);
+            continue;
+        }
+
+        int root = findRoot(parents, varIds[0]);
+        if (rootComponent[root] == -1) {
+            rootComponent[root] = (int) components.size();
+            components.push_back(Component());
+        }
+
+        Component & component = components[rootComponent[root]];
+        component.restrictions.push_back(restrictions[r]);
+        for(int varId: varIds) {
+            if (!usedVars[varId]) {
+                usedVars[varId] = 1;
+                component.varTable.insert(ast.getVariableName(varId));
+            }
+        }
+    }
+
+    Component freeVariables;
+    for(const std::string & name: varTable) {
+        int varId = ast.findVariable(name);
+        if (varId == -1 || !usedVars[varId]) {
+            freeVariables.varTable.insert(name);
+        }
+    }
+    if (!freeVariables.varTable.empty()) {
+        components.push_back(freeVariables);
+    }
+
+    //restrictions without variables, as 5 #= 5, only decide if there is a solution, they go with the first component
+    if (!groundRestrictions.empty()) {
+        if (components.empty()) {
+            components.push_back(Component());
+        }
+        components[0].restrictions.insert(components[0].restrictions.end(), groundRestrictions.begin(), groundRestrictions.end());
+    }
+}
+
+ConstraintDecomposition::~ConstraintDecomposition() {
+
+}
+
+void ConstraintDecomposition::collectVariables(const ConstraintAst & ast, ConstraintAst::NodeId root, std::vector<int> & varIds) {
+    std::vector<ConstraintAst::NodeId> pending;
+    pending.push_back(root);
+    while (!pending.empty()) {
+        ConstraintAst::NodeId id = pending.back();
+        pending.pop_back();
+
+        const ConstraintAst::Node & node = ast.getNode(id);
+        if (node.kind == ConstraintAst::variable_node) {
+            varIds.push_back((int) node.value);
+        } else {
+            for(std::uint32_t i = 0; i < node.numChildren; i++) {
+                pending.push_back(ast.getChild(node, i));
+            }
+        }
+    }
+}
+
+int ConstraintDecomposition::findRoot(std::vector<int> & parents, int varId) {
+    while (parents[varId] != varId) {
+        parents[varId] = parents[parents[varId]];
+        varId = parents[varId];
+    }
+    return varId;
+}
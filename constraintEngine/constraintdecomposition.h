@@ -0,0 +1,84 @@
+#ifndef CONSTRAINTDECOMPOSITION_H
+#define CONSTRAINTDECOMPOSITION_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "constraintengine/constraintast.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The ConstraintDecomposition class splits the restrictions of a machine into independent sub-problems.
+ *
+ * Two variables interact if they appear in the same restriction. The ConstraintDecomposition class builds the connected components of
+ * that graph with a union-find over the variables of every restriction: the restrictions of different components share no variable,
+ * so each component can be solved on its own and the solutions joined. The minimization of the labeling is also separable, the
+ * minimal number of pumps and valves of the machine is the sum of the minimum of every component.
+ *
+ * Components are ordered by their first restriction, keeping the order of translation, and their variables in alphabetical order.
+ * The variables of the machine that no restriction uses are grouped in one last component without restrictions, and the restrictions
+ * without variables are added to the first component.
+ *
+ * @sa ConstraintAst
+ */
+class CONSTRAINTDECOMPOSITION_EXPORT ConstraintDecomposition
+{
+public:
+    /**
+     * @brief The Component struct an independent sub-problem.
+     */
+    typedef struct Component {
+        /**
+         * @brief restrictions id of the root node of every restriction of the component, in order of translation.
+         */
+        std::vector<ConstraintAst::NodeId> restrictions;
+        /**
+         * @brief varTable names of the variables of the component, in alphabetical order.
+         */
+        std::set<std::string> varTable;
+    } Component;
+
+    /**
+     * @brief ConstraintDecomposition calculates the components of a set of restrictions.
+     * @param ast tree with the restrictions.
+     * @param restrictions id of the root node of every restriction.
+     * @param varTable names of all the variables of the machine, in alphabetical order.
+     */
+    ConstraintDecomposition(const ConstraintAst & ast,
+                            const std::vector<ConstraintAst::NodeId> & restrictions,
+                            const std::set<std::string> & varTable);
+    virtual ~ConstraintDecomposition();
+
+    /**
+     * @brief getComponents returns the independent sub-problems.
+     */
+    inline const std::vector<Component> & getComponents() const {
+        return components;
+    }
+    /**
+     * @brief getNumComponents returns the number of independent sub-problems.
+     */
+    inline std::size_t getNumComponents() const {
+        return components.size();
+    }
+
+protected:
+    /**
+     * @brief components independent sub-problems.
+     */
+    std::vector<Component> components;
+
+    /**
+     * @brief collectVariables appends to varIds the ids of the variables used by a restriction, repetitions included.
+     */
+    static void collectVariables(const ConstraintAst & ast, ConstraintAst::NodeId root, std::vector<int> & varIds);
+    /**
+     * @brief findRoot returns the representative of the set of a variable, halving the path on the way.
+     */
+    static int findRoot(std::vector<int> & parents, int varId);
+};
+
+#endif // CONSTRAINTDECOMPOSITION_H
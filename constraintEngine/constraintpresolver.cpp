@@ -0,0 +1,529 @@
+#include "constraintpresolver.h"
+
+ConstraintPresolver::ConstraintPresolver() {
+    this->in = NULL;
+    this->work = NULL;
+    this->stats = Stats();
+}
+
+ConstraintPresolver::~ConstraintPresolver() {
+
+}
+
+ConstraintPresolver::Stats ConstraintPresolver::presolve(const ConstraintAst & in,
+                                                         const std::vector<ConstraintAst::NodeId> & restrictions,
+                                                         ConstraintAst & out,
+                                                         std::vector<ConstraintAst::NodeId> & outRestrictions)
+{
+    //the restrictions are simplified in a scratch tree, only the ones that survive are copied to out
+    ConstraintAst scratch;
+    this->in = &in;
+    this->work = &scratch;
+    this->stats = Stats();
+    stats.restrictionsIn = restrictions.size();
+
+    std::vector<ConstraintAst::NodeId> roots;
+    bool contradiction = false;
+    for(ConstraintAst::NodeId root: restrictions) {
+        stats.nodesIn += countNodes(in, root);
+        if (contradiction) {
+            continue;
+        }
+
+        Value value = simplify(root);
+        if (value.kind == truth_value) {
+            if (value.number != 0) {
+                stats.tautologies++;
+            } else {
+                contradiction = true;
+            }
+        } else {
+            split(materialize(value), roots);
+        }
+    }
+
+    //repeated restrictions are dropped, the domains of the same variable are intersected at the position of the first one
+    std::vector<std::pair<ConstraintAst::NodeId, int>> entries;
+    std::map<int, std::vector<Interval>> domains;
+    std::unordered_set<std::string> seen;
+    for(std::size_t i = 0; i < roots.size() && !contradiction; i++) {
+        ConstraintAst::NodeId id = roots[i];
+
+        int varId;
+        std::vector<Interval> intervals;
+        if (readDomain(id, varId, intervals)) {
+            normalize(intervals);
+            auto it = domains.find(varId);
+            if (it == domains.end()) {
+                domains.insert(std::make_pair(varId, intervals));
+                entries.push_back(std::make_pair(id, varId));
+            } else {
+                it->second = intersect(it->second, intervals);
+                intervals = it->second;
+                stats.mergedDomains++;
+            }
+            contradiction = intervals.empty();
+        } else {
+            std::string key;
+            appendKey(id, key);
+            if (seen.insert(key).second) {
+                entries.push_back(std::make_pair(id, -1));
+            } else {
+                stats.duplicates++;
+            }
+        }
+    }
+
+    outRestrictions.clear();
+    if (contradiction) {
+        stats.contradiction = true;
+        std::vector<ConstraintAst::NodeId> children = {out.addNumber(0), out.addNumber(1)};
+        outRestrictions.push_back(out.addNode(ConstraintAst::equality_node, Equality::equal, children));
+    } else {
+        for(const std::pair<ConstraintAst::NodeId, int> & entry: entries) {
+            if (entry.second == -1) {
+                outRestrictions.push_back(copyTree(scratch, entry.first, out));
+            } else {
+                const std::vector<Interval> & intervals = domains[entry.second];
+                std::vector<ConstraintAst::NodeId> children;
+                children.reserve(1 + 2 * intervals.size());
+                children.push_back(out.addVariable(out.internVariable(scratch.getVariableName(entry.second))));
+                for(const Interval & interval: intervals) {
+                    children.push_back(out.addNumber(interval.first));
+                    children.push_back(out.addNumber(interval.second));
+                }
+                outRestrictions.push_back(out.addNode(ConstraintAst::domain_node, 0, children));
+            }
+        }
+    }
+
+    stats.restrictionsOut = outRestrictions.size();
+    for(ConstraintAst::NodeId root: outRestrictions) {
+        stats.nodesOut += countNodes(out, root);
+    }
+
+    this->in = NULL;
+    this->work = NULL;
+    return stats;
+}
+
+ConstraintPresolver::Value ConstraintPresolver::simplify(ConstraintAst::NodeId id) {
+    const ConstraintAst::Node & node = in->getNode(id);
+
+    Value value;
+    switch (node.kind) {
+    case ConstraintAst::variable_node:
+        value.kind = expression_value;
+        value.id = work->addVariable(work->internVariable(in->getVariableName((int) node.value)));
+        break;
+    case ConstraintAst::number_node:
+        value.kind = number_value;
+        value.number = node.value;
+        break;
+    case ConstraintAst::binary_node:
+        value = simplifyBinary(node);
+        break;
+    case ConstraintAst::unary_node: {
+        Value operand = simplify(in->getChild(node, 0));
+        if (operand.kind == number_value &&
+                (RuleUnaryOperation::UnaryOperators) node.op == RuleUnaryOperation::absolute_value &&
+                operand.number != std::numeric_limits<long long>::min())
+        {
+            stats.foldedNodes++;
+            value.kind = number_value;
+            value.number = std::abs(operand.number);
+        } else {
+            std::vector<ConstraintAst::NodeId> children = {materialize(operand)};
+            value.kind = expression_value;
+            value.id = work->addNode(ConstraintAst::unary_node, node.op, children);
+        }
+        break;
+    }
+    case ConstraintAst::equality_node:
+        value = simplifyEquality(node);
+        break;
+    case ConstraintAst::conjunction_node:
+        value = simplifyConjunction(node);
+        break;
+    case ConstraintAst::implication_node:
+        value = simplifyImplication(node);
+        break;
+    case ConstraintAst::domain_node:
+        value = simplifyDomain(node);
+        break;
+    default:
+        value.kind = expression_value;
+        value.id = copyTree(*in, id, *work);
+        break;
+    }
+    return value;
+}
+
+ConstraintPresolver::Value ConstraintPresolver::simplifyBinary(const ConstraintAst::Node & node) {
+    Value left = simplify(in->getChild(node, 0));
+    Value right = simplify(in->getChild(node, 1));
+    BinaryOperation::BinaryOperators op = (BinaryOperation::BinaryOperators) node.op;
+
+    long long result;
+    if (left.kind == number_value && right.kind == number_value && foldOperation(op, left.number, right.number, result)) {
+        stats.foldedNodes++;
+        Value value;
+        value.kind = number_value;
+        value.number = result;
+        return value;
+    }
+
+    //neutral elements
+    bool leftIs0 = (left.kind == number_value && left.number == 0);
+    bool leftIs1 = (left.kind == number_value && left.number == 1);
+    bool rightIs0 = (right.kind == number_value && right.number == 0);
+    bool rightIs1 = (right.kind == number_value && right.number == 1);
+    if ((op == BinaryOperation::add && rightIs0) ||
+            (op == BinaryOperation::subtract && rightIs0) ||
+            (op == BinaryOperation::multiply && rightIs1) ||
+            (op == BinaryOperation::divide && rightIs1))
+    {
+        stats.foldedNodes++;
+        return left;
+    } else if ((op == BinaryOperation::add && leftIs0) || (op == BinaryOperation::multiply && leftIs1)) {
+        stats.foldedNodes++;
+        return right;
+    }
+
+    std::vector<ConstraintAst::NodeId> children = {materialize(left), materialize(right)};
+    Value value;
+    value.kind = expression_value;
+    value.id = work->addNode(ConstraintAst::binary_node, node.op, children);
+    return value;
+}
+
+ConstraintPresolver::Value ConstraintPresolver::simplifyEquality(const ConstraintAst::Node & node) {
+    Value left = simplify(in->getChild(node, 0));
+    Value right = simplify(in->getChild(node, 1));
+    Equality::ComparatorOp op = (Equality::ComparatorOp) node.op;
+
+    Value value;
+    if (left.kind == number_value && right.kind == number_value) {
+        stats.foldedNodes++;
+        value.kind = truth_value;
+        value.number = compare(op, left.number, right.number) ? 1 : 0;
+        return value;
+    }
+
+    //an expression compared with itself, only if it has no division that could be undefined
+    if (left.kind == expression_value && right.kind == expression_value && isTotal(left.id) && sameTree(left.id, right.id)) {
+        stats.foldedNodes++;
+        value.kind = truth_value;
+        value.number = compare(op, 0, 0) ? 1 : 0;
+        return value;
+    }
+
+    std::vector<ConstraintAst::NodeId> children = {materialize(left), materialize(right)};
+    value.kind = expression_value;
+    value.id = work->addNode(ConstraintAst::equality_node, node.op, children);
+    return value;
+}
+
+ConstraintPresolver::Value ConstraintPresolver::simplifyConjunction(const ConstraintAst::Node & node) {
+    Value left = simplify(in->getChild(node, 0));
+    Value right = simplify(in->getChild(node, 1));
+    bool isAnd = ((Conjunction::BoolOperators) node.op == Conjunction::predicate_and);
+
+    //true is the neutral element of #/\ and false of #\/, the other one absorbs the operation
+    if (left.kind == truth_value) {
+        stats.foldedNodes++;
+        return ((left.number != 0) == isAnd) ? right : left;
+    } else if (right.kind == truth_value) {
+        stats.foldedNodes++;
+        return ((right.number != 0) == isAnd) ? left : right;
+    }
+
+    std::vector<ConstraintAst::NodeId> children = {materialize(left), materialize(right)};
+    Value value;
+    value.kind = expression_value;
+    value.id = work->addNode(ConstraintAst::conjunction_node, node.op, children);
+    return value;
+}
+
+ConstraintPresolver::Value ConstraintPresolver::simplifyImplication(const ConstraintAst::Node & node) {
+    Value left = simplify(in->getChild(node, 0));
+    Value right = simplify(in->getChild(node, 1));
+
+    Value value;
+    if ((left.kind == truth_value && left.number == 0) || (right.kind == truth_value && right.number != 0)) {
+        stats.foldedNodes++;
+        value.kind = truth_value;
+        value.number = 1;
+        return value;
+    } else if (left.kind == truth_value) {
+        stats.foldedNodes++;
+        return right;
+    }
+
+    std::vector<ConstraintAst::NodeId> children = {materialize(left), materialize(right)};
+    value.kind = expression_value;
+    value.id = work->addNode(ConstraintAst::implication_node, node.op, children);
+    return value;
+}
+
+ConstraintPresolver::Value ConstraintPresolver::simplifyDomain(const ConstraintAst::Node & node) {
+    std::vector<ConstraintAst::NodeId> children;
+    children.reserve(node.numChildren);
+
+    Value variable = simplify(in->getChild(node, 0));
+    children.push_back(materialize(variable));
+
+    bool allNumbers = true;
+    std::vector<Interval> intervals;
+    for(std::uint32_t i = 1; i + 1 < node.numChildren; i += 2) {
+        Value min = simplify(in->getChild(node, i));
+        Value max = simplify(in->getChild(node, i + 1));
+        allNumbers = allNumbers && min.kind == number_value && max.kind == number_value;
+        if (allNumbers) {
+            intervals.push_back(std::make_pair(min.number, max.number));
+        }
+        children.push_back(materialize(min));
+        children.push_back(materialize(max));
+    }
+
+    Value value;
+    if (allNumbers && variable.kind == expression_value && work->getNode(variable.id).kind == ConstraintAst::variable_node) {
+        normalize(intervals);
+        if (intervals.empty()) {
+            value.kind = truth_value;
+            value.number = 0;
+            return value;
+        }
+
+        children.resize(1);
+        for(const Interval & interval: intervals) {
+            children.push_back(work->addNumber(interval.first));
+            children.push_back(work->addNumber(interval.second));
+        }
+    }
+    value.kind = expression_value;
+    value.id = work->addNode(ConstraintAst::domain_node, node.op, children);
+    return value;
+}
+
+ConstraintAst::NodeId ConstraintPresolver::materialize(const Value & value) {
+    if (value.kind == number_value) {
+        return work->addNumber(value.number);
+    } else if (value.kind == truth_value) {
+        std::vector<ConstraintAst::NodeId> children = {work->addNumber(0), work->addNumber(value.number != 0 ? 0 : 1)};
+        return work->addNode(ConstraintAst::equality_node, Equality::equal, children);
+    } else {
+        return value.id;
+    }
+}
+
+void ConstraintPresolver::split(ConstraintAst::NodeId id, std::vector<ConstraintAst::NodeId> & roots) const {
+    const ConstraintAst::Node & node = work->getNode(id);
+    if (node.kind == ConstraintAst::conjunction_node && (Conjunction::BoolOperators) node.op == Conjunction::predicate_and) {
+        split(work->getChild(node, 0), roots);
+        split(work->getChild(node, 1), roots);
+    } else {
+        roots.push_back(id);
+    }
+}
+
+bool ConstraintPresolver::sameTree(ConstraintAst::NodeId a, ConstraintAst::NodeId b) const {
+    const ConstraintAst::Node & nodeA = work->getNode(a);
+    const ConstraintAst::Node & nodeB = work->getNode(b);
+    if (nodeA.kind != nodeB.kind || nodeA.op != nodeB.op || nodeA.value != nodeB.value || nodeA.numChildren != nodeB.numChildren) {
+        return false;
+    }
+    for(std::uint32_t i = 0; i < nodeA.numChildren; i++) {
+        if (!sameTree(work->getChild(nodeA, i), work->getChild(nodeB, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ConstraintPresolver::isTotal(ConstraintAst::NodeId id) const {
+    const ConstraintAst::Node & node = work->getNode(id);
+    if (node.kind == ConstraintAst::binary_node &&
+            ((BinaryOperation::BinaryOperators) node.op == BinaryOperation::divide ||
+             (BinaryOperation::BinaryOperators) node.op == BinaryOperation::module))
+    {
+        return false;
+    }
+    for(std::uint32_t i = 0; i < node.numChildren; i++) {
+        if (!isTotal(work->getChild(node, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ConstraintPresolver::appendKey(ConstraintAst::NodeId id, std::string & key) const {
+    const ConstraintAst::Node & node = work->getNode(id);
+    key += std::to_string(node.kind) + ":" + std::to_string(node.op) + ":" + std::to_string(node.value);
+    if (node.numChildren > 0) {
+        key += "(";
+        for(std::uint32_t i = 0; i < node.numChildren; i++) {
+            appendKey(work->getChild(node, i), key);
+            key += ",";
+        }
+        key += ")";
+    }
+}
+
+std::size_t ConstraintPresolver::countNodes(const ConstraintAst & ast, ConstraintAst::NodeId id) {
+    const ConstraintAst::Node & node = ast.getNode(id);
+    std::size_t count = 1;
+    for(std::uint32_t i = 0; i < node.numChildren; i++) {
+        count += countNodes(ast, ast.getChild(node, i));
+    }
+    return count;
+}
+
+ConstraintAst::NodeId ConstraintPresolver::copyTree(const ConstraintAst & from, ConstraintAst::NodeId id, ConstraintAst & to) {
+    const ConstraintAst::Node & node = from.getNode(id);
+    switch (node.kind) {
+    case ConstraintAst::variable_node:
+        return to.addVariable(to.internVariable(from.getVariableName((int) node.value)));
+    case ConstraintAst::number_node:
+        return to.addNumber(node.value);
+    case ConstraintAst::error_node:
+        return to.addError();
+    default: {
+        std::vector<ConstraintAst::NodeId> children;
+        children.reserve(node.numChildren);
+        for(std::uint32_t i = 0; i < node.numChildren; i++) {
+            children.push_back(copyTree(from, from.getChild(node, i), to));
+        }
+        return to.addNode((ConstraintAst::NodeKind) node.kind, node.op, children);
+    }
+    }
+}
+
+bool ConstraintPresolver::readDomain(ConstraintAst::NodeId id, int & varId, std::vector<Interval> & intervals) const {
+    const ConstraintAst::Node & node = work->getNode(id);
+    if (node.kind != ConstraintAst::domain_node || node.numChildren < 3 || (node.numChildren % 2) == 0) {
+        return false;
+    }
+
+    const ConstraintAst::Node & variable = work->getNode(work->getChild(node, 0));
+    if (variable.kind != ConstraintAst::variable_node) {
+        return false;
+    }
+    for(std::uint32_t i = 1; i < node.numChildren; i++) {
+        if (work->getNode(work->getChild(node, i)).kind != ConstraintAst::number_node) {
+            return false;
+        }
+    }
+
+    varId = (int) variable.value;
+    intervals.clear();
+    for(std::uint32_t i = 1; i + 1 < node.numChildren; i += 2) {
+        intervals.push_back(std::make_pair((long long) work->getNode(work->getChild(node, i)).value,
+                                           (long long) work->getNode(work->getChild(node, i + 1)).value));
+    }
+    return true;
+}
+
+void ConstraintPresolver::normalize(std::vector<Interval> & intervals) {
+    intervals.erase(std::remove_if(intervals.begin(), intervals.end(), [](const Interval & interval) {
+                        return interval.first > interval.second;
+                    }), intervals.end());
+    std::sort(intervals.begin(), intervals.end());
+
+    std::size_t last = 0;
+    for(std::size_t i = 1; i < intervals.size(); i++) {
+        Interval & current = intervals[last];
+        if (current.second == std::numeric_limits<long long>::max() || intervals[i].first <= current.second + 1) {
+            current.second = std::max(current.second, intervals[i].second);
+        } else {
+            intervals[++last] = intervals[i];
+        }
+    }
+    if (!intervals.empty()) {
+        intervals.resize(last + 1);
+    }
+}
+
+std::vector<ConstraintPresolver::Interval> ConstraintPresolver::intersect(const std::vector<Interval> & a, const std::vector<Interval> & b) {
+    std::vector<Interval> result;
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        long long lo = std::max(a[i].first, b[j].first);
+        long long hi = std::min(a[i].second, b[j].second);
+        if (lo <= hi) {
+            result.push_back(std::make_pair(lo, hi));
+        }
+        if (a[i].second < b[j].second) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    return result;
+}
+
+bool ConstraintPresolver::foldOperation(BinaryOperation::BinaryOperators op, long long a, long long b, long long & result) {
+    const long long maxValue = std::numeric_limits<long long>::max();
+    const long long minValue = std::numeric_limits<long long>::min();
+
+    switch (op) {
+    case BinaryOperation::add:
+        if ((b > 0 && a > maxValue - b) || (b < 0 && a < minValue - b)) {
+            return false;
+        }
+        result = a + b;
+        return true;
+    case BinaryOperation::subtract:
+        if ((b < 0 && a > maxValue + b) || (b > 0 && a < minValue + b)) {
+            return false;
+        }
+        result = a - b;
+        return true;
+    case BinaryOperation::multiply:
+        if (a == 0 || b == 0) {
+            result = 0;
+            return true;
+        }
+        if (a == minValue || b == minValue || std::abs(a) > maxValue / std::abs(b)) {
+            return false;
+        }
+        result = a * b;
+        return true;
+    case BinaryOperation::divide:
+        //clpfd // truncates toward zero, as C++ does
+        if (b == 0 || (a == minValue && b == -1)) {
+            return false;
+        }
+        result = a / b;
+        return true;
+    case BinaryOperation::module:
+        //rem takes the sign of the dividend, as C++ % does
+        if (b == 0 || (a == minValue && b == -1)) {
+            return false;
+        }
+        result = a % b;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ConstraintPresolver::compare(Equality::ComparatorOp op, long long a, long long b) {
+    switch (op) {
+    case Equality::not_equal:
+        return a != b;
+    case Equality::equal:
+        return a == b;
+    case Equality::bigger:
+        return a > b;
+    case Equality::bigger_equal:
+        return a >= b;
+    case Equality::lesser:
+        return a < b;
+    case Equality::lesser_equal:
+        return a <= b;
+    default:
+        return false;
+    }
+}
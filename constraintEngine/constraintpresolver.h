@@ -0,0 +1,206 @@
+#ifndef CONSTRAINTPRESOLVER_H
+#define CONSTRAINTPRESOLVER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fluidicmachinemodel/rules/conjunction.h>
+#include <fluidicmachinemodel/rules/arithmetic/binaryoperation.h>
+#include <fluidicmachinemodel/rules/arithmetic/unaryoperation.h>
+#include <fluidicmachinemodel/rules/equality.h>
+
+#include "constraintengine/constraintast.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The ConstraintPresolver class simplifies a set of translated restrictions before they are sent to a solver.
+ *
+ * The ConstraintPresolver class copies the restrictions of a ConstraintAst to a new tree, simplifying them on the way:
+ *
+ * - operations between numbers are folded, (3 + 4) becomes 7 and abs(-2) becomes 2, as well as the neutral elements of the
+ * operations, X + 0, X - 0, X * 1 and X // 1. Divisions by zero and results that overflow are left as they are, so the solver
+ * reports them as before.
+ * - comparisons between numbers and between the same expression, as X #= X, become true or false, and the boolean operations and
+ * implications with a true or false operand are reduced.
+ * - restrictions that are always true are dropped, the top level #/\ are split in separate restrictions and repeated restrictions are
+ * kept only once.
+ * - all the domains of the same variable are intersected in a single domain with sorted and disjoint intervals.
+ *
+ * If a restriction is always false, or the domain of a variable becomes empty, the machine has no solution for any input: the
+ * presolve stops and the result is a single restriction 0 #= 1, so the solver fails right away.
+ *
+ * The simplified restrictions have the same solutions as the original ones.
+ *
+ * @sa ConstraintAst, @sa AstTranslationStack::setPresolve
+ */
+class CONSTRAINTPRESOLVER_EXPORT ConstraintPresolver
+{
+public:
+    /**
+     * @brief The Stats struct what has been removed by the presolve.
+     */
+    typedef struct Stats {
+        std::size_t restrictionsIn;
+        std::size_t restrictionsOut;
+        /**
+         * @brief nodesIn nodes of the trees of the original restrictions.
+         */
+        std::size_t nodesIn;
+        /**
+         * @brief nodesOut nodes of the trees of the simplified restrictions.
+         */
+        std::size_t nodesOut;
+        /**
+         * @brief foldedNodes operations and comparisons replaced by their value or by one of their operands.
+         */
+        std::size_t foldedNodes;
+        /**
+         * @brief tautologies restrictions dropped because they are always true.
+         */
+        std::size_t tautologies;
+        /**
+         * @brief duplicates restrictions dropped because they were repeated.
+         */
+        std::size_t duplicates;
+        /**
+         * @brief mergedDomains domain restrictions joined with another domain of the same variable.
+         */
+        std::size_t mergedDomains;
+        /**
+         * @brief contradiction true if the restrictions have no solution.
+         */
+        bool contradiction;
+    } Stats;
+
+    ConstraintPresolver();
+    virtual ~ConstraintPresolver();
+
+    /**
+     * @brief presolve simplifies a set of restrictions.
+     * @param in tree with the original restrictions.
+     * @param restrictions id of the root node of every original restriction.
+     * @param out empty tree where the simplified restrictions are added.
+     * @param outRestrictions filled with the id of the root node of every simplified restriction, in order of translation.
+     * @return what has been removed.
+     */
+    Stats presolve(const ConstraintAst & in,
+                   const std::vector<ConstraintAst::NodeId> & restrictions,
+                   ConstraintAst & out,
+                   std::vector<ConstraintAst::NodeId> & outRestrictions);
+
+protected:
+    /**
+     * @brief The ValueKind enum what a simplified subtree is.
+     */
+    typedef enum ValueKind_ {
+        /**
+         * @brief expression_value a subtree of the output tree.
+         */
+        expression_value,
+        /**
+         * @brief number_value an integer not yet added to the output tree.
+         */
+        number_value,
+        /**
+         * @brief truth_value a restriction that is always true or always false.
+         */
+        truth_value
+    } ValueKind;
+
+    /**
+     * @brief The Value struct result of simplifying a subtree.
+     */
+    typedef struct Value {
+        ValueKind kind;
+        /**
+         * @brief number the integer of a number_value, 1 or 0 for a truth_value.
+         */
+        long long number;
+        /**
+         * @brief id node at the output tree of an expression_value.
+         */
+        ConstraintAst::NodeId id;
+    } Value;
+
+    /**
+     * @brief Interval a closed interval of a domain.
+     */
+    typedef std::pair<long long, long long> Interval;
+
+    const ConstraintAst* in;
+    /**
+     * @brief work scratch tree where the restrictions are simplified, only the ones that are kept are copied to the output tree.
+     */
+    ConstraintAst* work;
+    Stats stats;
+
+    /**
+     * @brief simplify copies a subtree to the output tree simplifying it.
+     */
+    Value simplify(ConstraintAst::NodeId id);
+    Value simplifyBinary(const ConstraintAst::Node & node);
+    Value simplifyEquality(const ConstraintAst::Node & node);
+    Value simplifyConjunction(const ConstraintAst::Node & node);
+    Value simplifyImplication(const ConstraintAst::Node & node);
+    Value simplifyDomain(const ConstraintAst::Node & node);
+    /**
+     * @brief copyTree copies a subtree to another tree without simplifying it.
+     */
+    static ConstraintAst::NodeId copyTree(const ConstraintAst & from, ConstraintAst::NodeId id, ConstraintAst & to);
+
+    /**
+     * @brief materialize returns the node of a value, numbers are added to the output tree.
+     */
+    ConstraintAst::NodeId materialize(const Value & value);
+    /**
+     * @brief split appends to roots the top level operands of the #/\ of a restriction of the output tree.
+     */
+    void split(ConstraintAst::NodeId id, std::vector<ConstraintAst::NodeId> & roots) const;
+    /**
+     * @brief sameTree returns true if two subtrees of the output tree are equal.
+     */
+    bool sameTree(ConstraintAst::NodeId a, ConstraintAst::NodeId b) const;
+    /**
+     * @brief isTotal returns false if a subtree of the output tree has a division, that could be undefined.
+     */
+    bool isTotal(ConstraintAst::NodeId id) const;
+    /**
+     * @brief appendKey appends to key a text that identifies a subtree of the output tree, equal trees give equal keys.
+     */
+    void appendKey(ConstraintAst::NodeId id, std::string & key) const;
+    /**
+     * @brief countNodes returns the number of nodes of a subtree.
+     */
+    static std::size_t countNodes(const ConstraintAst & ast, ConstraintAst::NodeId id);
+
+    /**
+     * @brief readDomain reads the intervals of a domain restriction of the output tree, false if any bound is not a number.
+     */
+    bool readDomain(ConstraintAst::NodeId id, int & varId, std::vector<Interval> & intervals) const;
+    /**
+     * @brief normalize sorts the intervals, removes the empty ones and joins the ones that overlap or are contiguous.
+     */
+    static void normalize(std::vector<Interval> & intervals);
+    /**
+     * @brief intersect returns the intersection of two normalized sets of intervals.
+     */
+    static std::vector<Interval> intersect(const std::vector<Interval> & a, const std::vector<Interval> & b);
+
+    /**
+     * @brief foldOperation calculates an arithmetic operation between numbers, false if it can not be folded.
+     */
+    static bool foldOperation(BinaryOperation::BinaryOperators op, long long a, long long b, long long & result);
+    /**
+     * @brief compare evaluates a comparison between numbers.
+     */
+    static bool compare(Equality::ComparatorOp op, long long a, long long b);
+};
+
+#endif // CONSTRAINTPRESOLVER_H
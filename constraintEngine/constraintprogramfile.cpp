@@ -0,0 +1,269 @@
+#include "constraintprogramfile.h"
+
+#define CONSTRAINT_PROGRAM_MAGIC 0x43505247
+#define CONSTRAINT_PROGRAM_VERSION 1
+#define CONSTRAINT_PROGRAM_BYTE_ORDER 0x01020304
+#define CONSTRAINT_PROGRAM_WRITE_NODES 4096
+
+static_assert(sizeof(ConstraintProgramFile::Header) == 64, "ConstraintProgramFile::Header must be 64 bytes");
+static_assert(sizeof(ConstraintAst::Node) == 24, "ConstraintAst::Node must be 24 bytes");
+
+void ConstraintProgramFile::save(const std::string & path,
+                                 const ConstraintAst & ast,
+                                 const std::vector<ConstraintAst::NodeId> & restrictions,
+                                 const std::set<std::string> & varTable) throw(std::runtime_error)
+{
+    std::string strings;
+    for(const std::string & name: ast.getVariableNames()) {
+        appendString(name, strings);
+    }
+    for(const std::string & name: varTable) {
+        appendString(name, strings);
+    }
+
+    Header header;
+    header.magic = CONSTRAINT_PROGRAM_MAGIC;
+    header.version = CONSTRAINT_PROGRAM_VERSION;
+    header.byteOrder = CONSTRAINT_PROGRAM_BYTE_ORDER;
+    header.nodeSize = sizeof(ConstraintAst::Node);
+    header.numNodes = ast.getNumNodes();
+    header.numChildren = ast.getNumChildren();
+    header.numRestrictions = restrictions.size();
+    header.numVariables = ast.getVariableNames().size();
+    header.numVarTable = varTable.size();
+    header.stringsSize = strings.size();
+
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw(std::runtime_error("ConstraintProgramFile::save(). Impossible to open " + path + ", " + file.errorString().toStdString()));
+    }
+
+    //the header is 64 bytes and a node 24, so every block starts aligned to its type
+    long long childrenSize = (long long) (header.numChildren * sizeof(ConstraintAst::NodeId));
+    long long restrictionsSize = (long long) (header.numRestrictions * sizeof(ConstraintAst::NodeId));
+    bool ok = file.write((const char*) &header, sizeof(Header)) == (long long) sizeof(Header);
+    ok = ok && writeNodes(file, ast.getNodeData(), header.numNodes);
+    ok = ok && file.write((const char*) ast.getChildData(), childrenSize) == childrenSize;
+    ok = ok && file.write((const char*) restrictions.data(), restrictionsSize) == restrictionsSize;
+    ok = ok && file.write(strings.data(), (long long) strings.size()) == (long long) strings.size();
+    if (!ok) {
+        std::string error = file.errorString().toStdString();
+        file.close();
+        file.remove();
+        throw(std::runtime_error("ConstraintProgramFile::save(). Impossible to write " + path + ", " + error));
+    }
+    file.close();
+}
+
+bool ConstraintProgramFile::writeNodes(QFile & file, const ConstraintAst::Node* nodes, std::uint64_t numNodes) {
+    //the padding between firstChild and value is not initialized by the tree, the nodes are copied field by field to a zeroed
+    //buffer so the file only depends on the restrictions
+    std::vector<ConstraintAst::Node> buffer;
+    buffer.reserve((std::size_t) std::min<std::uint64_t>(numNodes, CONSTRAINT_PROGRAM_WRITE_NODES));
+    for(std::uint64_t first = 0; first < numNodes; first += CONSTRAINT_PROGRAM_WRITE_NODES) {
+        std::uint64_t count = std::min<std::uint64_t>(numNodes - first, CONSTRAINT_PROGRAM_WRITE_NODES);
+        buffer.resize((std::size_t) count);
+        std::memset((void*) buffer.data(), 0, (std::size_t) count * sizeof(ConstraintAst::Node));
+        for(std::uint64_t i = 0; i < count; i++) {
+            const ConstraintAst::Node & node = nodes[first + i];
+            ConstraintAst::Node & copy = buffer[(std::size_t) i];
+            copy.kind = node.kind;
+            copy.op = node.op;
+            copy.numChildren = node.numChildren;
+            copy.firstChild = node.firstChild;
+            copy.value = node.value;
+        }
+
+        long long size = (long long) (count * sizeof(ConstraintAst::Node));
+        if (file.write((const char*) buffer.data(), size) != size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ConstraintProgramFile::ConstraintProgramFile(const std::string & path) throw(std::runtime_error) :
+    file(QString::fromStdString(path))
+{
+    this->data = NULL;
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). Impossible to open " + path + ", " +
+                                 file.errorString().toStdString()));
+    }
+
+    std::uint64_t fileSize = (std::uint64_t) file.size();
+    if (fileSize < sizeof(Header)) {
+        throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). " + path + " is not a constraint program"));
+    }
+    data = file.map(0, file.size());
+    if (data == NULL) {
+        throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). Impossible to map " + path + ", " +
+                                 file.errorString().toStdString()));
+    }
+
+    try {
+        const Header* header = (const Header*) data;
+        if (header->magic != CONSTRAINT_PROGRAM_MAGIC) {
+            throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). " + path + " is not a constraint program"));
+        }
+        if (header->version != CONSTRAINT_PROGRAM_VERSION) {
+            throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). Unsupported version " +
+                                     std::to_string(header->version) + " at " + path));
+        }
+        if (header->byteOrder != CONSTRAINT_PROGRAM_BYTE_ORDER || header->nodeSize != sizeof(ConstraintAst::Node)) {
+            throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). " + path +
+                                     " was written by a machine with a different byte order or node layout"));
+        }
+
+        //the counts are checked one by one against the size of the file so the offsets can not overflow
+        std::uint64_t available = fileSize - sizeof(Header);
+        if (header->numNodes > available / sizeof(ConstraintAst::Node) ||
+            header->numNodes > (std::uint64_t) UINT32_MAX)
+        {
+            throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). " + path + " is truncated"));
+        }
+        available -= header->numNodes * sizeof(ConstraintAst::Node);
+        if (header->numChildren > available / sizeof(ConstraintAst::NodeId)) {
+            throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). " + path + " is truncated"));
+        }
+        available -= header->numChildren * sizeof(ConstraintAst::NodeId);
+        if (header->numRestrictions > available / sizeof(ConstraintAst::NodeId)) {
+            throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). " + path + " is truncated"));
+        }
+        available -= header->numRestrictions * sizeof(ConstraintAst::NodeId);
+        if (header->stringsSize > available) {
+            throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). " + path + " is truncated"));
+        }
+
+        const unsigned char* position = data + sizeof(Header);
+        const ConstraintAst::Node* nodes = (const ConstraintAst::Node*) position;
+        position += header->numNodes * sizeof(ConstraintAst::Node);
+        const ConstraintAst::NodeId* children = (const ConstraintAst::NodeId*) position;
+        position += header->numChildren * sizeof(ConstraintAst::NodeId);
+        const ConstraintAst::NodeId* roots = (const ConstraintAst::NodeId*) position;
+        position += header->numRestrictions * sizeof(ConstraintAst::NodeId);
+        const unsigned char* strings = position;
+
+        std::uint64_t offset = 0;
+        for(std::uint64_t i = 0; i < header->numVariables; i++) {
+            std::string name = readString(strings, header->stringsSize, offset);
+            if (ast.internVariable(name) != (int) i) {
+                throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). Repeated variable " + name + " at " + path));
+            }
+        }
+        for(std::uint64_t i = 0; i < header->numVarTable; i++) {
+            varTable.insert(readString(strings, header->stringsSize, offset));
+        }
+
+        validate(nodes, header->numNodes, children, header->numChildren, header->numVariables);
+        restrictions.reserve(header->numRestrictions);
+        for(std::uint64_t i = 0; i < header->numRestrictions; i++) {
+            if (roots[i] >= header->numNodes) {
+                throw(std::runtime_error("ConstraintProgramFile::ConstraintProgramFile(). Restriction " + std::to_string(i) +
+                                         " refers to an unknown node"));
+            }
+            restrictions.push_back(roots[i]);
+        }
+        ast.borrow(nodes, header->numNodes, children, header->numChildren);
+    } catch (std::runtime_error & e) {
+        file.unmap(data);
+        data = NULL;
+        throw;
+    }
+}
+
+ConstraintProgramFile::~ConstraintProgramFile() {
+    ast.clear();
+    if (data != NULL) {
+        file.unmap(data);
+    }
+}
+
+PrologExecutor* ConstraintProgramFile::createPrologExecutor() const throw(std::runtime_error) {
+    return new PrologExecutor(ast, restrictions, varTable);
+}
+
+NativeConstraintSolver* ConstraintProgramFile::createNativeConstraintSolver() const throw(std::runtime_error) {
+    return new NativeConstraintSolver(ast, restrictions, varTable);
+}
+
+void ConstraintProgramFile::validate(const ConstraintAst::Node* nodes,
+                                     std::uint64_t numNodes,
+                                     const ConstraintAst::NodeId* children,
+                                     std::uint64_t numChildren,
+                                     std::uint64_t numVariables) throw(std::runtime_error)
+{
+    for(std::uint64_t i = 0; i < numNodes; i++) {
+        const ConstraintAst::Node & node = nodes[i];
+        if (node.kind > ConstraintAst::error_node) {
+            throw(std::runtime_error("ConstraintProgramFile::validate(). Node " + std::to_string(i) + " has an unknown kind"));
+        }
+        if (!isValidShape(node)) {
+            throw(std::runtime_error("ConstraintProgramFile::validate(). Node " + std::to_string(i) +
+                                     " has a wrong operator or number of children for its kind"));
+        }
+        if (node.kind == ConstraintAst::variable_node && (node.value < 0 || (std::uint64_t) node.value >= numVariables)) {
+            throw(std::runtime_error("ConstraintProgramFile::validate(). Node " + std::to_string(i) + " refers to an unknown variable"));
+        }
+        if ((std::uint64_t) node.firstChild + node.numChildren > numChildren) {
+            throw(std::runtime_error("ConstraintProgramFile::validate(). Node " + std::to_string(i) + " has children out of the file"));
+        }
+        for(std::uint32_t j = 0; j < node.numChildren; j++) {
+            if (children[node.firstChild + j] >= i) {
+                throw(std::runtime_error("ConstraintProgramFile::validate(). Node " + std::to_string(i) +
+                                         " has a child that is not created before it"));
+            }
+        }
+    }
+}
+
+bool ConstraintProgramFile::isValidShape(const ConstraintAst::Node & node) {
+    switch (node.kind) {
+    case ConstraintAst::variable_node:
+    case ConstraintAst::number_node:
+    case ConstraintAst::error_node:
+        return node.numChildren == 0 && node.op == 0;
+    case ConstraintAst::unary_node:
+        return node.numChildren == 1 && node.op == RuleUnaryOperation::absolute_value;
+    case ConstraintAst::binary_node:
+        return node.numChildren == 2 &&
+                (node.op == BinaryOperation::add || node.op == BinaryOperation::subtract || node.op == BinaryOperation::multiply ||
+                 node.op == BinaryOperation::divide || node.op == BinaryOperation::module);
+    case ConstraintAst::equality_node:
+        return node.numChildren == 2 &&
+                (node.op == Equality::not_equal || node.op == Equality::equal || node.op == Equality::bigger ||
+                 node.op == Equality::bigger_equal || node.op == Equality::lesser || node.op == Equality::lesser_equal);
+    case ConstraintAst::conjunction_node:
+        return node.numChildren == 2 && (node.op == Conjunction::predicate_and || node.op == Conjunction::predicate_or);
+    case ConstraintAst::implication_node:
+        return node.numChildren == 2 && node.op == 0;
+    case ConstraintAst::domain_node:
+        //the variable followed by pairs of bounds
+        return node.numChildren >= 3 && (node.numChildren % 2) == 1 && node.op == 0;
+    default:
+        return false;
+    }
+}
+
+std::string ConstraintProgramFile::readString(const unsigned char* strings, std::uint64_t stringsSize, std::uint64_t & offset)
+    throw(std::runtime_error)
+{
+    std::uint32_t length;
+    if (stringsSize - offset < sizeof(length)) {
+        throw(std::runtime_error("ConstraintProgramFile::readString(). The names of the variables are truncated"));
+    }
+    std::memcpy(&length, strings + offset, sizeof(length));
+    offset += sizeof(length);
+    if (stringsSize - offset < length) {
+        throw(std::runtime_error("ConstraintProgramFile::readString(). The names of the variables are truncated"));
+    }
+    std::string text((const char*) strings + offset, length);
+    offset += length;
+    return text;
+}
+
+void ConstraintProgramFile::appendString(const std::string & text, std::string & strings) {
+    std::uint32_t length = (std::uint32_t) text.size();
+    strings.append((const char*) &length, sizeof(length));
+    strings.append(text);
+}
@@ -0,0 +1,150 @@
+#ifndef CONSTRAINTPROGRAMFILE_H
+#define CONSTRAINTPROGRAMFILE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <QFile>
+
+#include <fluidicmachinemodel/rules/conjunction.h>
+#include <fluidicmachinemodel/rules/arithmetic/binaryoperation.h>
+#include <fluidicmachinemodel/rules/arithmetic/unaryoperation.h>
+#include <fluidicmachinemodel/rules/equality.h>
+
+#include "constraintengine/constraintast.h"
+#include "constraintengine/nativeconstraintsolver.h"
+#include "constraintengine/prologexecutor.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The ConstraintProgramFile class stores a translated machine in a binary file that is loaded without parsing it.
+ *
+ * The file holds the arena of a ConstraintAst, the roots of the restrictions, the interned variables and the variable table, laid
+ * out as:
+ * - a 64 bytes header with the magic number, the version, a byte order mark, the size of a node and the number of elements of each block.
+ * - the nodes, the ids of the children and the ids of the roots, as the raw arrays of the arena.
+ * - the names of the interned variables and the names of the variable table, each as a 32 bits length followed by its bytes.
+ *
+ * A loaded file is mapped into memory and its ast borrows the nodes from the mapping, so loading a machine costs the validation of the
+ * nodes and the interning of the names, not the translation of the rules nor the parsing of a prolog program. The files are only
+ * valid on machines with the same byte order and node layout, the ones that do not match are rejected.
+ *
+ * The ConstraintProgramFile must outlive its ast and every RoutingEngine created from it that keeps the tree, as NativeConstraintSolver.
+ *
+ * @sa ConstraintAst, @sa AstTranslationStack::saveProgram
+ */
+class CONSTRAINTPROGRAMFILE_EXPORT ConstraintProgramFile
+{
+public:
+    /**
+     * @brief The Header struct first bytes of the file.
+     */
+    typedef struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t nodeSize;
+        std::uint64_t numNodes;
+        std::uint64_t numChildren;
+        std::uint64_t numRestrictions;
+        std::uint64_t numVariables;
+        std::uint64_t numVarTable;
+        std::uint64_t stringsSize;
+    } Header;
+
+    /**
+     * @brief save writes a translated machine to a file, a runtime_error is thrown if the file can not be written.
+     * @param path path of the file, it is overwritten.
+     * @param ast tree with the translated restrictions.
+     * @param restrictions id of the root node of every restriction.
+     * @param varTable name of the variables of the machine, in alphabetical order.
+     */
+    static void save(const std::string & path,
+                     const ConstraintAst & ast,
+                     const std::vector<ConstraintAst::NodeId> & restrictions,
+                     const std::set<std::string> & varTable) throw(std::runtime_error);
+
+    /**
+     * @brief ConstraintProgramFile maps a file written by save(). A runtime_error is thrown if the file can not be mapped or is not
+     * a valid program for this machine.
+     * @param path path of the file.
+     */
+    ConstraintProgramFile(const std::string & path) throw(std::runtime_error);
+    virtual ~ConstraintProgramFile();
+
+    /**
+     * @brief getAst returns the tree of the restrictions, its nodes are at the mapped file.
+     */
+    inline const ConstraintAst & getAst() const {
+        return ast;
+    }
+    /**
+     * @brief getRestrictions returns the id of the root node of every restriction.
+     */
+    inline const std::vector<ConstraintAst::NodeId> & getRestrictions() const {
+        return restrictions;
+    }
+    /**
+     * @brief getVarTable returns the name of the variables of the machine, in alphabetical order.
+     */
+    inline const std::set<std::string> & getVarTable() const {
+        return varTable;
+    }
+
+    /**
+     * @brief createPrologExecutor creates a PrologExecutor with the loaded restrictions, the executor does not use the file after
+     * it is created. The caller must free the memory.
+     */
+    PrologExecutor* createPrologExecutor() const throw(std::runtime_error);
+    /**
+     * @brief createNativeConstraintSolver creates a NativeConstraintSolver with the loaded restrictions, the solver reads the nodes
+     * from the mapped file so it must not outlive this object. The caller must free the memory.
+     */
+    NativeConstraintSolver* createNativeConstraintSolver() const throw(std::runtime_error);
+
+protected:
+    QFile file;
+    /**
+     * @brief data start of the mapped file.
+     */
+    unsigned char* data;
+    ConstraintAst ast;
+    std::vector<ConstraintAst::NodeId> restrictions;
+    std::set<std::string> varTable;
+
+    /**
+     * @brief validate checks that every node of the mapped arena has the shape of its kind and refers to existing children and
+     * variables, and that the children of a node are created before it, so a corrupted file can not make a traversal read out of the
+     * mapping or loop forever.
+     */
+    void validate(const ConstraintAst::Node* nodes,
+                  std::uint64_t numNodes,
+                  const ConstraintAst::NodeId* children,
+                  std::uint64_t numChildren,
+                  std::uint64_t numVariables) throw(std::runtime_error);
+    /**
+     * @brief isValidShape returns true if a node has the number of children and an operator allowed for its kind.
+     */
+    static bool isValidShape(const ConstraintAst::Node & node);
+    /**
+     * @brief writeNodes writes the nodes of an arena with their padding set to zero.
+     * @return false if the file can not be written.
+     */
+    static bool writeNodes(QFile & file, const ConstraintAst::Node* nodes, std::uint64_t numNodes);
+    /**
+     * @brief readString reads a string of the strings block, a runtime_error is thrown if it is not inside the block.
+     */
+    static std::string readString(const unsigned char* strings, std::uint64_t stringsSize, std::uint64_t & offset) throw(std::runtime_error);
+    /**
+     * @brief appendString appends a string to the strings block.
+     */
+    static void appendString(const std::string & text, std::string & strings);
+};
+
+#endif // CONSTRAINTPROGRAMFILE_H
@@ -6,9 +6,47 @@
 #if defined(CONSTRAINTSENGINELIBRARY_LIBRARY)
 #  define PROLOGEXECUTOR_EXPORT Q_DECL_EXPORT
 #  define PROLOGTRANSLATIONSTACK_EXPORT Q_DECL_EXPORT
+#  define PROLOGEXECUTORPOOL_EXPORT Q_DECL_EXPORT
+#  define ROUTECACHE_EXPORT Q_DECL_EXPORT
+#  define CONSTRAINTAST_EXPORT Q_DECL_EXPORT
+#  define ASTTRANSLATIONSTACK_EXPORT Q_DECL_EXPORT
+#  define PROLOGTERMBUILDER_EXPORT Q_DECL_EXPORT
+#  define PROLOGTERMTRANSLATIONSTACK_EXPORT Q_DECL_EXPORT
+#  define INCREMENTALPROLOGEXECUTOR_EXPORT Q_DECL_EXPORT
+#  define NATIVECONSTRAINTSOLVER_EXPORT Q_DECL_EXPORT
+#  define NATIVETRANSLATIONSTACK_EXPORT Q_DECL_EXPORT
+#  define EXECUTORSTATS_EXPORT Q_DECL_EXPORT
+#  define COMPILEDPROGRAMCACHE_EXPORT Q_DECL_EXPORT
+#  define CONSTRAINTDECOMPOSITION_EXPORT Q_DECL_EXPORT
+#  define CONSTRAINTPRESOLVER_EXPORT Q_DECL_EXPORT
+#  define SPECIALIZATIONTABLE_EXPORT Q_DECL_EXPORT
+#  define LABELINGSTRATEGY_EXPORT Q_DECL_EXPORT
+#  define PROGRAMSINK_EXPORT Q_DECL_EXPORT
+#  define CONSTRAINTPROGRAMFILE_EXPORT Q_DECL_EXPORT
+#  define VARIABLETABLE_EXPORT Q_DECL_EXPORT
+#  define CONFLICTEXPLAINER_EXPORT Q_DECL_EXPORT
 #else
 #  define PROLOGEXECUTOR_EXPORT Q_DECL_IMPORT
 #  define PROLOGTRANSLATIONSTACK_EXPORT Q_DECL_IMPORT
+#  define PROLOGEXECUTORPOOL_EXPORT Q_DECL_IMPORT
+#  define ROUTECACHE_EXPORT Q_DECL_IMPORT
+#  define CONSTRAINTAST_EXPORT Q_DECL_IMPORT
+#  define ASTTRANSLATIONSTACK_EXPORT Q_DECL_IMPORT
+#  define PROLOGTERMBUILDER_EXPORT Q_DECL_IMPORT
+#  define PROLOGTERMTRANSLATIONSTACK_EXPORT Q_DECL_IMPORT
+#  define INCREMENTALPROLOGEXECUTOR_EXPORT Q_DECL_IMPORT
+#  define NATIVECONSTRAINTSOLVER_EXPORT Q_DECL_IMPORT
+#  define NATIVETRANSLATIONSTACK_EXPORT Q_DECL_IMPORT
+#  define EXECUTORSTATS_EXPORT Q_DECL_IMPORT
+#  define COMPILEDPROGRAMCACHE_EXPORT Q_DECL_IMPORT
+#  define CONSTRAINTDECOMPOSITION_EXPORT Q_DECL_IMPORT
+#  define CONSTRAINTPRESOLVER_EXPORT Q_DECL_IMPORT
+#  define SPECIALIZATIONTABLE_EXPORT Q_DECL_IMPORT
+#  define LABELINGSTRATEGY_EXPORT Q_DECL_IMPORT
+#  define PROGRAMSINK_EXPORT Q_DECL_IMPORT
+#  define CONSTRAINTPROGRAMFILE_EXPORT Q_DECL_IMPORT
+#  define VARIABLETABLE_EXPORT Q_DECL_IMPORT
+#  define CONFLICTEXPLAINER_EXPORT Q_DECL_IMPORT
 #endif
 
 #endif // CONSTRAINTSENGINELIBRARY_GLOBAL_H
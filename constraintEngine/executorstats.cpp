@@ -0,0 +1,92 @@
+#include "executorstats.h"
+
+ExecutorStats::ExecutorStats(const std::string & name) :
+    name(name)
+{
+    this->stats = Stats();
+    this->profiling = false;
+    this->traceLog = NULL;
+    this->sampleEvery = 1;
+    this->numRecords = 0;
+}
+
+ExecutorStats::~ExecutorStats() {
+
+}
+
+void ExecutorStats::recordLoad(double loadMs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.loadMs = loadMs;
+}
+
+void ExecutorStats::recordQuery(const QueryRecord & record) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    stats.queries += record.numQueries;
+    if (record.exception) {
+        stats.exceptions++;
+    } else {
+        stats.successes += record.numFound;
+        stats.failures += record.numQueries - record.numFound - record.numTimedOut;
+        stats.timeouts += record.numTimedOut;
+    }
+    stats.setupMsTotal += record.setupMs;
+    stats.solveMsTotal += record.solveMs;
+    stats.readoutMsTotal += record.readoutMs;
+    stats.solveMsMax = std::max(stats.solveMsMax, record.solveMs);
+    stats.inferencesTotal += (unsigned long long) record.inferences;
+    stats.inferencesMax = std::max(stats.inferencesMax, record.inferences);
+    stats.globalUsedMax = std::max(stats.globalUsedMax, record.globalUsed);
+    stats.trailUsedMax = std::max(stats.trailUsedMax, record.trailUsed);
+    stats.localUsedMax = std::max(stats.localUsedMax, record.localUsed);
+
+    if (traceLog != NULL && (numRecords++ % sampleEvery) == 0) {
+        *traceLog << name
+                  << " queries " << record.numQueries
+                  << " found " << record.numFound
+                  << " timed_out " << record.numTimedOut
+                  << " exception " << record.exception
+                  << " setup_ms " << record.setupMs
+                  << " solve_ms " << record.solveMs
+                  << " readout_ms " << record.readoutMs
+                  << " inferences " << record.inferences
+                  << " global " << record.globalUsed
+                  << " trail " << record.trailUsed
+                  << " local " << record.localUsed
+                  << std::endl;
+    }
+}
+
+void ExecutorStats::recordCached() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.cachedQueries++;
+}
+
+ExecutorStats::Stats ExecutorStats::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void ExecutorStats::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    double loadMs = stats.loadMs;
+    stats = Stats();
+    stats.loadMs = loadMs;
+}
+
+void ExecutorStats::setProfiling(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    profiling = enabled;
+}
+
+bool ExecutorStats::isProfiling() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return profiling;
+}
+
+void ExecutorStats::setTraceLog(std::ostream* log, unsigned int sampleEvery) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->traceLog = log;
+    this->sampleEvery = (sampleEvery == 0) ? 1 : sampleEvery;
+    this->numRecords = 0;
+}
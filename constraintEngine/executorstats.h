@@ -0,0 +1,177 @@
+#ifndef EXECUTORSTATS_H
+#define EXECUTORSTATS_H
+
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The ExecutorStats class accumulates the metrics of the queries made to a PrologExecutor.
+ *
+ * Every query is split in three phases: setup, the creation of the terms and the grounding of the input variables; solve, the call to
+ * the predicate that posts the restrictions and runs the labeling; and readout, the copy of the values of the variables. The time of
+ * each phase is always recorded. When profiling is enabled the inferences made by the query and the usage of the global, trail and
+ * local stacks of the engine, that grows with the choicepoints left by the search, are also read with statistics/2, at the cost of
+ * some extra calls to the interpreter.
+ *
+ * Optionally one of every N queries can be written as a line to a trace log.
+ *
+ * All the methods are thread safe.
+ */
+class EXECUTORSTATS_EXPORT ExecutorStats
+{
+public:
+    /**
+     * @brief The QueryRecord struct measures of a single call to the solver.
+     */
+    typedef struct QueryRecord {
+        /**
+         * @brief numQueries number of routes calculated by the call, more than one for a batch.
+         */
+        unsigned int numQueries;
+        /**
+         * @brief numFound number of routes with solution.
+         */
+        unsigned int numFound;
+        /**
+         * @brief numTimedOut number of routes whose search was cut by the budget of the query, they are not counted in numFound
+         * even if the best state found so far was returned.
+         */
+        unsigned int numTimedOut;
+        /**
+         * @brief exception true if the interpreter threw an exception.
+         */
+        bool exception;
+        double setupMs;
+        double solveMs;
+        double readoutMs;
+        /**
+         * @brief inferences inferences made by the query, 0 if profiling is disabled.
+         */
+        long long inferences;
+        /**
+         * @brief globalUsed bytes of the global stack in use after the solution was found, 0 if profiling is disabled.
+         */
+        long long globalUsed;
+        /**
+         * @brief trailUsed bytes of the trail stack in use after the solution was found, 0 if profiling is disabled.
+         */
+        long long trailUsed;
+        /**
+         * @brief localUsed bytes of the local stack in use after the solution was found, it holds the choicepoints, 0 if
+         * profiling is disabled.
+         */
+        long long localUsed;
+    } QueryRecord;
+
+    /**
+     * @brief The Stats struct accumulated metrics of an executor.
+     */
+    typedef struct Stats {
+        /**
+         * @brief loadMs time spent loading or asserting the program.
+         */
+        double loadMs;
+        /**
+         * @brief queries number of routes calculated by the solver, the ones answered by the route cache are not included.
+         */
+        unsigned long long queries;
+        unsigned long long successes;
+        unsigned long long failures;
+        unsigned long long exceptions;
+        /**
+         * @brief timeouts number of routes whose search was cut by the budget of the query.
+         */
+        unsigned long long timeouts;
+        /**
+         * @brief cachedQueries number of routes answered by the route cache.
+         */
+        unsigned long long cachedQueries;
+        double setupMsTotal;
+        double solveMsTotal;
+        double readoutMsTotal;
+        double solveMsMax;
+        unsigned long long inferencesTotal;
+        long long inferencesMax;
+        long long globalUsedMax;
+        long long trailUsedMax;
+        long long localUsedMax;
+    } Stats;
+
+    /**
+     * @brief ExecutorStats creates empty counters.
+     * @param name name of the executor, written at the trace log.
+     */
+    ExecutorStats(const std::string & name);
+    virtual ~ExecutorStats();
+
+    /**
+     * @brief recordLoad stores the time spent loading the program.
+     */
+    void recordLoad(double loadMs);
+    /**
+     * @brief recordQuery adds the measures of a call to the solver.
+     */
+    void recordQuery(const QueryRecord & record);
+    /**
+     * @brief recordCached counts a route answered by the route cache.
+     */
+    void recordCached();
+
+    /**
+     * @brief getStats returns a copy of the accumulated metrics.
+     */
+    Stats getStats() const;
+    /**
+     * @brief reset sets all the counters to 0, the load time is kept.
+     */
+    void reset();
+
+    /**
+     * @brief setProfiling enables or disables the collection of the prolog statistics, disabled by default.
+     */
+    void setProfiling(bool enabled);
+    /**
+     * @brief isProfiling returns true if the prolog statistics must be collected.
+     */
+    bool isProfiling() const;
+    /**
+     * @brief setTraceLog writes one of every sampleEvery queries to log, NULL disables the trace. The stream must outlive this object.
+     */
+    void setTraceLog(std::ostream* log, unsigned int sampleEvery);
+
+protected:
+    /**
+     * @brief name name of the executor.
+     */
+    std::string name;
+    /**
+     * @brief stats accumulated metrics.
+     */
+    Stats stats;
+    /**
+     * @brief profiling true if the prolog statistics must be collected.
+     */
+    bool profiling;
+    /**
+     * @brief traceLog stream where the sampled queries are written, NULL if the trace is disabled.
+     */
+    std::ostream* traceLog;
+    /**
+     * @brief sampleEvery one of every sampleEvery queries is written to the trace.
+     */
+    unsigned int sampleEvery;
+    /**
+     * @brief numRecords number of calls recorded since the trace was set.
+     */
+    unsigned long long numRecords;
+    /**
+     * @brief mutex protects all the attributes.
+     */
+    mutable std::mutex mutex;
+};
+
+#endif // EXECUTORSTATS_H
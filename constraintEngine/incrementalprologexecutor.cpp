@@ -0,0 +1,367 @@
+#include "incrementalprologexecutor.h"
+
+IncrementalPrologExecutor::IncrementalPrologExecutor(const ConstraintAst & ast,
+                                                     const std::vector<ConstraintAst::NodeId> & restrictions,
+                                                     const std::set<std::string> & varTable)
+    throw(std::runtime_error) :
+    RoutingEngine()
+{
+    static std::atomic<unsigned long> machineCounter(0);
+    this->moduleName = "incremental_machine_" + std::to_string(machineCounter++);
+    this->nextRestrictionId = 0;
+    this->routeCache = std::unique_ptr<RouteCache>(new RouteCache(0));
+
+    try {
+        PlCall(moduleName.c_str(), "use_module", PlTermv(PlCompound("library(clpfd)")));
+
+        PlTerm indicator = PlCompound("/", PlTermv(PlAtom(INCREMENTAL_RESTRICTION_NAME), PlTerm(2L)));
+        PlCall("dynamic", PlTermv(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), indicator))));
+    } catch (PlException ex) {
+        throw(std::runtime_error("IncrementalPrologExecutor::IncrementalPrologExecutor(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+    }
+
+    for(const std::string & varName: varTable) {
+        addSlot(varName);
+    }
+    for(ConstraintAst::NodeId root: restrictions) {
+        addRestriction(ast, root);
+    }
+}
+
+IncrementalPrologExecutor::~IncrementalPrologExecutor() {
+    try {
+        PlTerm indicator = PlCompound("/", PlTermv(PlAtom(INCREMENTAL_RESTRICTION_NAME), PlTerm(2L)));
+        PlCall("abolish", PlTermv(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), indicator))));
+    } catch (PlException ex) {
+        //the destructor must not throw, the clauses are left in the module
+    }
+}
+
+bool IncrementalPrologExecutor::calculateNewRoute(const std::unordered_map<std::string, long long> & inputStates,
+                                                  std::unordered_map<std::string, long long> & outStates)
+    throw(std::runtime_error)
+{
+    std::vector<int> inputSlots;
+    std::vector<long long> inputValues;
+    inputSlots.reserve(inputStates.size());
+    inputValues.reserve(inputStates.size());
+    for(const auto & statePair: inputStates) {
+        auto it = varSlots.find(statePair.first);
+        if (it == varSlots.end()) {
+            throw(std::runtime_error("IncrementalPrologExecutor::calculateNewRoute(). Unknown variable " + statePair.first));
+        }
+        inputSlots.push_back(it->second);
+        inputValues.push_back(statePair.second);
+    }
+
+    bool found;
+    std::vector<long long> states;
+    if (!routeCache->lookup(inputSlots, inputValues, found, states)) {
+        try {
+            PlFrame frame;
+            int numSlots = getNumSlots();
+            PlTermv slots(numSlots);
+            for(std::size_t i = 0; i < inputSlots.size(); i++) {
+                slots[inputSlots[i]] = (long) inputValues[i];
+            }
+
+            //the variables to label, in alphabetical order, are the slots of the current variables
+            std::vector<std::string> names;
+            names.reserve(varSlots.size());
+            PlTermv active((int) varSlots.size());
+            int i = 0;
+            for(const auto & slotPair: varSlots) {
+                names.push_back(slotPair.first);
+                PL_put_term(active[i].ref, slots[slotPair.second].ref);
+                i++;
+            }
+
+            PlTerm vars;
+            if (numSlots > 0) {
+                PL_put_term(vars.ref, PlCompound("vars", slots).ref);
+            } else {
+                PL_put_term(vars.ref, PlTerm(PlAtom("vars")).ref);
+            }
+
+            ConstraintAst noRestrictions;
+            PrologTermBuilder builder(noRestrictions, names);
+            PlTerm post = PlCompound("post_restrictions", PlTermv(PlAtom(moduleName.c_str()), vars));
+            PlTerm goal = PlCompound(",", PlTermv(PlCompound(":", PlTermv(PlAtom("constraint_engine"), post)),
+                                                  builder.buildLabeling(active)));
+
+            PlQuery q(moduleName.c_str(), "call", PlTermv(goal));
+            found = q.next_solution();
+            if (found) {
+                states.assign(numSlots, 0);
+                for(const auto & slotPair: varSlots) {
+                    states[slotPair.second] = (long) slots[slotPair.second];
+                }
+            }
+        } catch (PlException ex) {
+            throw(std::runtime_error("IncrementalPrologExecutor::calculateNewRoute(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+        }
+        routeCache->insert(inputSlots, inputValues, found, states);
+    }
+
+    if (found) {
+        for(const auto & slotPair: varSlots) {
+            outStates[slotPair.first] = states[slotPair.second];
+        }
+    }
+    return found;
+}
+
+IncrementalPrologExecutor::RestrictionId IncrementalPrologExecutor::addRestriction(const ConstraintAst & ast, ConstraintAst::NodeId root)
+    throw(std::runtime_error)
+{
+    RestrictionId id = nextRestrictionId;
+    std::vector<int> slots = assertRestriction(id, ast, root, false);
+
+    nextRestrictionId++;
+    restrictionSlots.insert(std::make_pair(id, std::move(slots)));
+    std::string domainVariable = getDomainVariable(ast, root);
+    if (!domainVariable.empty()) {
+        int slot = varSlots[domainVariable];
+        domainSlots.insert(std::make_pair(id, slot));
+        slotDomains[slot]++;
+    }
+    routeCache->clear();
+    return id;
+}
+
+void IncrementalPrologExecutor::removeRestriction(RestrictionId id) throw(std::runtime_error) {
+    auto it = restrictionSlots.find(id);
+    if (it == restrictionSlots.end()) {
+        throw(std::runtime_error("IncrementalPrologExecutor::removeRestriction(). Unknown restriction " + std::to_string(id)));
+    }
+
+    //without its last domain a variable is unbounded and the labeling fails, so the variable goes with it
+    auto domainIt = domainSlots.find(id);
+    bool lastDomain = (domainIt != domainSlots.end() && slotDomains[domainIt->second] == 1);
+    if (lastDomain && slotRefs[domainIt->second] > 1) {
+        throw(std::runtime_error("IncrementalPrologExecutor::removeRestriction(). Restriction " + std::to_string(id) +
+                                 " is the domain of variable " + getSlotName(domainIt->second) + ", that is still used by " +
+                                 std::to_string(slotRefs[domainIt->second] - 1) + " restrictions"));
+    }
+
+    try {
+        PlTerm head = PlCompound(INCREMENTAL_RESTRICTION_NAME, PlTermv(PlTerm((long) id), PlTerm()));
+        PlCall("retractall", PlTermv(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), head))));
+    } catch (PlException ex) {
+        throw(std::runtime_error("IncrementalPrologExecutor::removeRestriction(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+    }
+
+    releaseSlots(it->second);
+    restrictionSlots.erase(it);
+    if (domainIt != domainSlots.end()) {
+        int slot = domainIt->second;
+        slotDomains[slot]--;
+        domainSlots.erase(domainIt);
+        if (lastDomain) {
+            removeVariable(getSlotName(slot));
+        }
+    }
+    routeCache->clear();
+}
+
+void IncrementalPrologExecutor::replaceRestriction(RestrictionId id, const ConstraintAst & ast, ConstraintAst::NodeId root)
+    throw(std::runtime_error)
+{
+    auto it = restrictionSlots.find(id);
+    if (it == restrictionSlots.end()) {
+        throw(std::runtime_error("IncrementalPrologExecutor::replaceRestriction(). Unknown restriction " + std::to_string(id)));
+    }
+
+    auto domainIt = domainSlots.find(id);
+    std::string domainVariable = getDomainVariable(ast, root);
+    if (domainIt != domainSlots.end()) {
+        std::string oldVariable = getSlotName(domainIt->second);
+        if (slotDomains[domainIt->second] == 1 && domainVariable != oldVariable) {
+            throw(std::runtime_error("IncrementalPrologExecutor::replaceRestriction(). Restriction " + std::to_string(id) +
+                                     " is the only domain of variable " + oldVariable + ", it can only be replaced by another domain of " +
+                                     oldVariable));
+        }
+    }
+
+    std::vector<int> slots = assertRestriction(id, ast, root, true);
+
+    releaseSlots(it->second);
+    it->second = std::move(slots);
+    if (domainIt != domainSlots.end()) {
+        slotDomains[domainIt->second]--;
+        domainSlots.erase(domainIt);
+    }
+    if (!domainVariable.empty()) {
+        int slot = varSlots[domainVariable];
+        domainSlots.insert(std::make_pair(id, slot));
+        slotDomains[slot]++;
+    }
+    routeCache->clear();
+}
+
+void IncrementalPrologExecutor::addVariable(const std::string & name) {
+    if (varSlots.find(name) == varSlots.end()) {
+        addSlot(name);
+        routeCache->clear();
+    }
+}
+
+void IncrementalPrologExecutor::removeVariable(const std::string & name) throw(std::runtime_error) {
+    auto it = varSlots.find(name);
+    if (it == varSlots.end()) {
+        throw(std::runtime_error("IncrementalPrologExecutor::removeVariable(). Unknown variable " + name));
+    }
+    if (slotRefs[it->second] > 0) {
+        throw(std::runtime_error("IncrementalPrologExecutor::removeVariable(). Variable " + name + " is used by " +
+                                 std::to_string(slotRefs[it->second]) + " restrictions"));
+    }
+
+    freeSlots.push_back(it->second);
+    varSlots.erase(it);
+    routeCache->clear();
+}
+
+std::vector<IncrementalPrologExecutor::RestrictionId> IncrementalPrologExecutor::getRestrictionIds() const {
+    std::vector<RestrictionId> ids;
+    ids.reserve(restrictionSlots.size());
+    for(const auto & restrictionPair: restrictionSlots) {
+        ids.push_back(restrictionPair.first);
+    }
+    return ids;
+}
+
+std::set<std::string> IncrementalPrologExecutor::getVarTable() const {
+    std::set<std::string> varTable;
+    for(const auto & slotPair: varSlots) {
+        varTable.insert(varTable.end(), slotPair.first);
+    }
+    return varTable;
+}
+
+void IncrementalPrologExecutor::setRouteCacheCapacity(std::size_t capacity) {
+    routeCache->setCapacity(capacity);
+}
+
+RouteCache::Stats IncrementalPrologExecutor::getRouteCacheStats() const {
+    return routeCache->getStats();
+}
+
+std::vector<int> IncrementalPrologExecutor::assertRestriction(RestrictionId id,
+                                                              const ConstraintAst & ast,
+                                                              ConstraintAst::NodeId root,
+                                                              bool replace)
+    throw(std::runtime_error)
+{
+    std::vector<int> varIds;
+    collectVariables(ast, root, varIds);
+
+    //the variables new to the machine are remembered so they can be removed again if the clause can not be asserted
+    std::vector<std::string> names;
+    std::vector<int> slots;
+    std::vector<std::string> newNames;
+    names.reserve(varIds.size());
+    slots.reserve(varIds.size());
+    for(int varId: varIds) {
+        names.push_back(ast.getVariableName(varId));
+        if (varSlots.find(names.back()) == varSlots.end()) {
+            newNames.push_back(names.back());
+        }
+        slots.push_back(addSlot(names.back()));
+    }
+
+    try {
+        PlFrame frame;
+        PrologTermBuilder builder(ast, names);
+        PlTermv locals((int) names.size());
+        PlTerm vars;
+
+        //restriction(Id, Vars) :- arg(Slot1, Vars, X1), ..., Constraint.
+        PlTerm body = builder.buildRestriction(root, locals);
+        for(int i = (int) slots.size() - 1; i >= 0; i--) {
+            PlTerm argGoal = PlCompound("arg", PlTermv(PlTerm((long) slots[i] + 1), vars, locals[i]));
+            PL_put_term(body.ref, PlCompound(",", PlTermv(argGoal, body)).ref);
+        }
+        PlTerm head = PlCompound(INCREMENTAL_RESTRICTION_NAME, PlTermv(PlTerm((long) id), vars));
+        PlTerm clause = PlCompound(":-", PlTermv(head, body));
+
+        //the old clause is only retracted once the new one has been built
+        if (replace) {
+            PlTerm oldHead = PlCompound(INCREMENTAL_RESTRICTION_NAME, PlTermv(PlTerm((long) id), PlTerm()));
+            PlCall("retractall", PlTermv(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), oldHead))));
+        }
+        PlCall("assertz", PlTermv(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), clause))));
+    } catch (PlException ex) {
+        for(const std::string & name: newNames) {
+            auto it = varSlots.find(name);
+            freeSlots.push_back(it->second);
+            varSlots.erase(it);
+        }
+        throw(std::runtime_error("IncrementalPrologExecutor::assertRestriction(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+    }
+
+    for(int slot: slots) {
+        slotRefs[slot]++;
+    }
+    return slots;
+}
+
+void IncrementalPrologExecutor::collectVariables(const ConstraintAst & ast, ConstraintAst::NodeId id, std::vector<int> & varIds) const {
+    const ConstraintAst::Node & node = ast.getNode(id);
+    if (node.kind == ConstraintAst::variable_node) {
+        int varId = (int) node.value;
+        if (std::find(varIds.begin(), varIds.end(), varId) == varIds.end()) {
+            varIds.push_back(varId);
+        }
+    } else {
+        for(std::uint32_t i = 0; i < node.numChildren; i++) {
+            collectVariables(ast, ast.getChild(node, i), varIds);
+        }
+    }
+}
+
+int IncrementalPrologExecutor::addSlot(const std::string & name) {
+    auto it = varSlots.find(name);
+    if (it != varSlots.end()) {
+        return it->second;
+    }
+
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = (int) slotRefs.size();
+        slotRefs.push_back(0);
+        slotDomains.push_back(0);
+    }
+    varSlots.insert(std::make_pair(name, slot));
+    return slot;
+}
+
+void IncrementalPrologExecutor::releaseSlots(const std::vector<int> & slots) {
+    for(int slot: slots) {
+        slotRefs[slot]--;
+    }
+}
+
+std::string IncrementalPrologExecutor::getDomainVariable(const ConstraintAst & ast, ConstraintAst::NodeId root) const {
+    const ConstraintAst::Node & node = ast.getNode(root);
+    if (node.kind != ConstraintAst::domain_node || node.numChildren == 0) {
+        return "";
+    }
+
+    const ConstraintAst::Node & variable = ast.getNode(ast.getChild(node, 0));
+    if (variable.kind != ConstraintAst::variable_node) {
+        return "";
+    }
+    return ast.getVariableName((int) variable.value);
+}
+
+std::string IncrementalPrologExecutor::getSlotName(int slot) const {
+    for(const auto & slotPair: varSlots) {
+        if (slotPair.second == slot) {
+            return slotPair.first;
+        }
+    }
+    return "";
+}
@@ -0,0 +1,230 @@
+#ifndef INCREMENTALPROLOGEXECUTOR_H
+#define INCREMENTALPROLOGEXECUTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define PL_SAFE_ARG_MACROS //define this flag so SWI-cpp macros dont colide with boost one
+#include <SWI-cpp.h>
+
+#include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+
+#include "constraintengine/constraintast.h"
+#include "constraintengine/prologexecutor.h"
+#include "constraintengine/prologtermbuilder.h"
+#include "constraintengine/routecache.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief INCREMENTAL_RESTRICTION_NAME name of the dynamic predicate that holds each restriction of an IncrementalPrologExecutor.
+ */
+#define INCREMENTAL_RESTRICTION_NAME "restriction"
+
+/**
+ * @brief The IncrementalPrologExecutor class is a RoutingEngine whose restrictions and variables can be changed after it is created.
+ *
+ * PrologExecutor loads the whole machine as a single clause, so any change in the machine means translating all the rules again and
+ * loading a new program. The IncrementalPrologExecutor class instead keeps every restriction as a separate dynamic clause of its module:
+ *
+ * restriction(Id, Vars) :- arg(Slot1, Vars, X1), arg(Slot2, Vars, X2), ..., Constraint.
+ *
+ * Every variable of the machine gets a stable slot, its position in the Vars compound, so a clause only depends on the slots of the
+ * variables it uses and never has to be rewritten when other variables are added or removed. Each restriction is identified by the
+ * RestrictionId returned when it is added, and adding, removing or replacing a restriction only asserts or retracts its own clause,
+ * the cost of a change is proportional to the size of the change and not to the size of the machine.
+ *
+ * Every query posts all the restrictions with the helper predicate constraint_engine:post_restrictions/2 and labels the variables
+ * minimizing the number of pumps and valves in use, the same objective as the predicate generated by PrologTranslationStack.
+ *
+ * The methods that change the restrictions must not be invoked at the same time as calculateNewRoute().
+ *
+ * @sa PrologExecutor, @sa PrologTermBuilder
+ */
+class INCREMENTALPROLOGEXECUTOR_EXPORT IncrementalPrologExecutor : public RoutingEngine
+{
+public:
+    /**
+     * @brief RestrictionId identifier of a restriction of the executor, never reused.
+     */
+    typedef unsigned long RestrictionId;
+
+    /**
+     * @brief IncrementalPrologExecutor creates a new executor with an initial set of restrictions.
+     *
+     * PrologExecutor::createEngine() must have been invoked before.
+     *
+     * @param ast tree with the translated restrictions.
+     * @param restrictions id of the root node of every initial restriction, the id of each restriction is returned by getRestrictionIds().
+     * @param varTable name of the variables of the machine, the variables used by the restrictions are added even if they are not in varTable.
+     */
+    IncrementalPrologExecutor(const ConstraintAst & ast,
+                              const std::vector<ConstraintAst::NodeId> & restrictions,
+                              const std::set<std::string> & varTable) throw(std::runtime_error);
+    /**
+     * @brief ~IncrementalPrologExecutor removes all the restrictions from the module of this executor.
+     */
+    virtual ~IncrementalPrologExecutor();
+
+    /**
+     * @brief calculateNewRoute posts all the current restrictions and returns the new state of the machine.
+     *
+     * @param inputStates map with the name as key and the value of the variables that are going to be ground. A runtime_error is thrown
+     * if any of the names is not a variable of the machine.
+     * @param outStates map with the name as key and the value of every variable of the machine. If no solution is found for the given
+     * input, the map is returned intact.
+     * @return true if a state compatible with the input data is found, false otherwise.
+     */
+    virtual bool calculateNewRoute(const std::unordered_map<std::string, long long> & inputStates,
+                                   std::unordered_map<std::string, long long> & outStates) throw(std::runtime_error);
+
+    /**
+     * @brief addRestriction asserts a new restriction, the variables it uses that are not in the machine are added.
+     * @param ast tree that contains the restriction.
+     * @param root id of the root node of the restriction.
+     * @return the id of the new restriction.
+     */
+    RestrictionId addRestriction(const ConstraintAst & ast, ConstraintAst::NodeId root) throw(std::runtime_error);
+    /**
+     * @brief removeRestriction retracts a restriction. A runtime_error is thrown if the id does not exist.
+     *
+     * A variable without domain is unbounded and can not be labeled, so when the restriction is the last domain of a variable a
+     * runtime_error is thrown if any other restriction still uses the variable, and otherwise the variable is removed with it.
+     *
+     * @param id id of the restriction returned by addRestriction().
+     */
+    void removeRestriction(RestrictionId id) throw(std::runtime_error);
+    /**
+     * @brief replaceRestriction changes the constraint of an existing restriction, the restriction keeps its id.
+     *
+     * The last domain of a variable can only be replaced by another domain of the same variable, a runtime_error is thrown otherwise.
+     *
+     * @param id id of the restriction returned by addRestriction().
+     * @param ast tree that contains the new restriction.
+     * @param root id of the root node of the new restriction.
+     */
+    void replaceRestriction(RestrictionId id, const ConstraintAst & ast, ConstraintAst::NodeId root) throw(std::runtime_error);
+
+    /**
+     * @brief addVariable adds a new variable to the machine, nothing is done if the variable already exists.
+     * @param name name of the variable.
+     */
+    void addVariable(const std::string & name);
+    /**
+     * @brief removeVariable removes a variable from the machine. A runtime_error is thrown if the variable does not exist or if any
+     * restriction still uses it.
+     * @param name name of the variable.
+     */
+    void removeVariable(const std::string & name) throw(std::runtime_error);
+
+    /**
+     * @brief getRestrictionIds returns the ids of all the current restrictions, in order of creation.
+     */
+    std::vector<RestrictionId> getRestrictionIds() const;
+    /**
+     * @brief getVarTable returns the names of all the current variables, in alphabetical order.
+     */
+    std::set<std::string> getVarTable() const;
+    /**
+     * @brief getModuleName returns the name of the prolog module where the restrictions of this executor are asserted.
+     */
+    inline const std::string & getModuleName() const {
+        return moduleName;
+    }
+
+    /**
+     * @brief setRouteCacheCapacity changes the maximum number of routes remembered by the executor, 0 disables the cache.
+     *
+     * The cache is cleared every time the restrictions or the variables change.
+     */
+    void setRouteCacheCapacity(std::size_t capacity);
+    /**
+     * @brief getRouteCacheStats returns the counters of the route cache.
+     */
+    RouteCache::Stats getRouteCacheStats() const;
+
+protected:
+    /**
+     * @brief moduleName name of the prolog module where the restrictions of this executor are asserted, unique for each executor.
+     */
+    std::string moduleName;
+    /**
+     * @brief varSlots map with the name of a variable as key and its slot as value, in alphabetical order.
+     */
+    std::map<std::string, int> varSlots;
+    /**
+     * @brief slotRefs number of restrictions that use each slot, indexed by slot.
+     */
+    std::vector<int> slotRefs;
+    /**
+     * @brief freeSlots slots of removed variables, reused by new variables.
+     */
+    std::vector<int> freeSlots;
+    /**
+     * @brief restrictionSlots slots of the variables used by each restriction, ordered by id.
+     */
+    std::map<RestrictionId, std::vector<int>> restrictionSlots;
+    /**
+     * @brief slotDomains number of domain restrictions of the variable of each slot, indexed by slot.
+     */
+    std::vector<int> slotDomains;
+    /**
+     * @brief domainSlots slot of the variable of each domain restriction, ordered by id.
+     */
+    std::map<RestrictionId, int> domainSlots;
+    /**
+     * @brief nextRestrictionId id of the next restriction to be added.
+     */
+    RestrictionId nextRestrictionId;
+    /**
+     * @brief routeCache results of previous calls to calculateNewRoute, a unique pointer because the cache holds a mutex.
+     */
+    std::unique_ptr<RouteCache> routeCache;
+
+    /**
+     * @brief assertRestriction builds the clause of a restriction and asserts it, the variables used are added if needed.
+     * @param id id of the restriction.
+     * @param ast tree that contains the restriction.
+     * @param root id of the root node of the restriction.
+     * @param replace if true the previous clause of the restriction is retracted, after the new one has been built.
+     * @return the slots of the variables used by the restriction, their references are already increased. If the clause can not be
+     * asserted the variables added for it are removed again.
+     */
+    std::vector<int> assertRestriction(RestrictionId id, const ConstraintAst & ast, ConstraintAst::NodeId root, bool replace)
+        throw(std::runtime_error);
+    /**
+     * @brief collectVariables adds to varIds the ids of the variables used by a node and all its descendants, without repetitions.
+     */
+    void collectVariables(const ConstraintAst & ast, ConstraintAst::NodeId id, std::vector<int> & varIds) const;
+    /**
+     * @brief addSlot returns the slot of a variable, creating a new one if the variable does not exist.
+     */
+    int addSlot(const std::string & name);
+    /**
+     * @brief releaseSlots decreases the references of the slots used by a restriction.
+     */
+    void releaseSlots(const std::vector<int> & slots);
+    /**
+     * @brief getDomainVariable returns the name of the variable bounded by a restriction, or an empty string if it is not a domain.
+     */
+    std::string getDomainVariable(const ConstraintAst & ast, ConstraintAst::NodeId root) const;
+    /**
+     * @brief getSlotName returns the name of the variable of a slot, or an empty string if the slot is free.
+     */
+    std::string getSlotName(int slot) const;
+    /**
+     * @brief getNumSlots returns the arity of the Vars compound, free slots included.
+     */
+    inline int getNumSlots() const {
+        return (int) slotRefs.size();
+    }
+};
+
+#endif // INCREMENTALPROLOGEXECUTOR_H
@@ -0,0 +1,232 @@
+#include "labelingstrategy.h"
+
+LabelingStrategy::LabelingStrategy() {
+    this->selection = select_ff;
+    this->valueOrder = value_up;
+    this->branching = branch_step;
+    this->objective = lexicographic_objective;
+    this->mode = optimal_mode;
+    this->pumpWeight = 1;
+    this->valveWeight = 1;
+}
+
+LabelingStrategy::~LabelingStrategy() {
+
+}
+
+void LabelingStrategy::setVariableOrder(const std::vector<std::string> & order) throw(std::runtime_error) {
+    for(const std::string & var: order) {
+        VariableNominator::VariableType type = VariableNominator::getVariableType(var);
+        if (type != VariableNominator::pump && type != VariableNominator::valve) {
+            throw(std::runtime_error("LabelingStrategy::setVariableOrder(). " + var + " is not a pump nor a valve"));
+        }
+    }
+    this->order = order;
+}
+
+std::string LabelingStrategy::generateLabeling(const VariableTable & variables) const {
+    std::vector<std::string> pumpCosts;
+    for(int id: variables.getIds(VariableNominator::pump)) {
+        pumpCosts.push_back("abs(" + variables.getName(id) + ")");
+    }
+    std::vector<std::string> valveCosts;
+    for(int id: variables.getIds(VariableNominator::valve)) {
+        valveCosts.push_back("min(" + variables.getName(id) + ", 1)");
+    }
+
+    std::vector<std::string> options;
+    for(const char* name: optionNames()) {
+        options.push_back(name);
+    }
+    if (mode == optimal_mode) {
+        std::string pumpsCost = sumText(pumpCosts);
+        std::string valvesCost = sumText(valveCosts);
+        if (objective == lexicographic_objective) {
+            if (!pumpsCost.empty()) {
+                options.push_back("min(" + pumpsCost + ")");
+            }
+            if (!valvesCost.empty()) {
+                options.push_back("min(" + valvesCost + ")");
+            }
+        } else {
+            std::vector<std::string> weighted;
+            if (!pumpsCost.empty()) {
+                weighted.push_back(std::to_string(pumpWeight) + "*(" + pumpsCost + ")");
+            }
+            if (!valvesCost.empty()) {
+                weighted.push_back(std::to_string(valveWeight) + "*(" + valvesCost + ")");
+            }
+            if (!weighted.empty()) {
+                options.push_back("min(" + sumText(weighted) + ")");
+            }
+        }
+    }
+
+    std::string text = "once(labeling([";
+    for(std::size_t i = 0; i < options.size(); i++) {
+        if (i > 0) {
+            text += ",";
+        }
+        text += options[i];
+    }
+    text += "],[";
+
+    std::vector<int> positions = labelingPositions(variables);
+    for(std::size_t i = 0; i < positions.size(); i++) {
+        if (i > 0) {
+            text += ",";
+        }
+        text += variables.getName(positions[i]);
+    }
+    text += "]))";
+    return text;
+}
+
+PlTerm LabelingStrategy::buildLabeling(const VariableTable & variables, const PlTermv & vars) const {
+    std::vector<PlTerm> pumpCosts;
+    for(int id: variables.getIds(VariableNominator::pump)) {
+        pumpCosts.push_back(PlCompound("abs", PlTermv(vars[id])));
+    }
+    std::vector<PlTerm> valveCosts;
+    for(int id: variables.getIds(VariableNominator::valve)) {
+        valveCosts.push_back(PlCompound("min", PlTermv(vars[id], PlTerm(1L))));
+    }
+
+    PlTerm options;
+    PlTail optionsTail(options);
+    for(const char* name: optionNames()) {
+        optionsTail.append(PlAtom(name));
+    }
+    if (mode == optimal_mode) {
+        if (objective == lexicographic_objective) {
+            if (!pumpCosts.empty()) {
+                optionsTail.append(PlCompound("min", PlTermv(sumTerm(pumpCosts))));
+            }
+            if (!valveCosts.empty()) {
+                optionsTail.append(PlCompound("min", PlTermv(sumTerm(valveCosts))));
+            }
+        } else {
+            std::vector<PlTerm> weighted;
+            if (!pumpCosts.empty()) {
+                weighted.push_back(PlCompound("*", PlTermv(PlTerm(pumpWeight), sumTerm(pumpCosts))));
+            }
+            if (!valveCosts.empty()) {
+                weighted.push_back(PlCompound("*", PlTermv(PlTerm(valveWeight), sumTerm(valveCosts))));
+            }
+            if (!weighted.empty()) {
+                optionsTail.append(PlCompound("min", PlTermv(sumTerm(weighted))));
+            }
+        }
+    }
+    optionsTail.close();
+
+    PlTerm labelingVars;
+    PlTail varsTail(labelingVars);
+    for(int id: labelingPositions(variables)) {
+        varsTail.append(vars[id]);
+    }
+    varsTail.close();
+
+    return PlCompound("once", PlTermv(PlCompound("labeling", PlTermv(options, labelingVars))));
+}
+
+PlTerm LabelingStrategy::buildLabeling(const std::vector<std::string> & varNames, const PlTermv & vars) const {
+    //the terms are put in the order of the ids of the table
+    VariableTable variables(std::set<std::string>(varNames.begin(), varNames.end()));
+    PlTermv ordered(variables.size());
+    for(int pos = 0; pos < (int) varNames.size(); pos++) {
+        PL_put_term(ordered[variables.find(varNames[pos])].ref, vars[pos].ref);
+    }
+    return buildLabeling(variables, ordered);
+}
+
+std::string LabelingStrategy::toString() const {
+    std::string text;
+    for(const char* name: optionNames()) {
+        text += std::string(name) + ",";
+    }
+    text += (mode == optimal_mode) ? "optimal," : "first_feasible,";
+    if (objective == lexicographic_objective) {
+        text += "lexicographic,";
+    } else {
+        text += "weighted(" + std::to_string(pumpWeight) + "," + std::to_string(valveWeight) + "),";
+    }
+    text += "[";
+    for(const std::string & var: order) {
+        text += var + ",";
+    }
+    text += "]";
+    return text;
+}
+
+std::vector<int> LabelingStrategy::labelingPositions(const VariableTable & variables) const {
+    std::vector<char> labeled(variables.size(), 0);
+    std::vector<int> positions;
+    for(const std::string & var: order) {
+        int id = variables.find(var);
+        if (id >= 0 && !labeled[id]) {
+            labeled[id] = 1;
+            positions.push_back(id);
+        }
+    }
+
+    //the rest of pumps go before the rest of valves, as in the objective
+    for(int id: variables.getLabelingIds()) {
+        if (!labeled[id]) {
+            positions.push_back(id);
+        }
+    }
+    return positions;
+}
+
+std::vector<const char*> LabelingStrategy::optionNames() const {
+    std::vector<const char*> names;
+    switch (selection) {
+    case select_leftmost:
+        names.push_back("leftmost");
+        break;
+    case select_ffc:
+        names.push_back("ffc");
+        break;
+    case select_min:
+        names.push_back("min");
+        break;
+    case select_max:
+        names.push_back("max");
+        break;
+    default:
+        names.push_back("ff");
+        break;
+    }
+
+    if (valueOrder == value_down) {
+        names.push_back("down");
+    }
+
+    if (branching == branch_enum) {
+        names.push_back("enum");
+    } else if (branching == branch_bisect) {
+        names.push_back("bisect");
+    }
+    return names;
+}
+
+std::string LabelingStrategy::sumText(const std::vector<std::string> & terms) {
+    std::string sum;
+    for(std::size_t i = 0; i < terms.size(); i++) {
+        if (i > 0) {
+            sum += " + ";
+        }
+        sum += terms[i];
+    }
+    return sum;
+}
+
+PlTerm LabelingStrategy::sumTerm(const std::vector<PlTerm> & terms) {
+    PlTerm sum;
+    PL_put_term(sum.ref, terms[0].ref);
+    for(std::size_t i = 1; i < terms.size(); i++) {
+        PL_put_term(sum.ref, PlCompound("+", PlTermv(sum, terms[i])).ref);
+    }
+    return sum;
+}
@@ -0,0 +1,213 @@
+#ifndef LABELINGSTRATEGY_H
+#define LABELINGSTRATEGY_H
+
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define PL_SAFE_ARG_MACROS //define this flag so SWI-cpp macros dont colide with boost one
+#include <SWI-cpp.h>
+
+#include <fluidicmachinemodel/machine_graph_utils/variablenominator.h>
+
+#include "constraintengine/variabletable.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The LabelingStrategy class describes how the clpfd labeling of a machine searches for a route.
+ *
+ * The default strategy is the labeling that has always been generated for the machines: the pumps and the valves are labeled with the
+ * first fail heuristic, minimizing first the sum of the absolute value of the pumps and then the number of open valves,
+ * once(labeling([ff,min(abs(P1) + ...),min(min(V1, 1) + ...)], [P1, ..., V1, ...])).
+ *
+ * Every part can be changed:
+ * - the variable selection, any of leftmost, ff, ffc, min or max. A custom order of variables can also be given, those variables are
+ * labeled first and in that order, followed by the rest of pumps and valves.
+ * - the value order, up or down, and the branching, step, enum or bisect.
+ * - the objective, the lexicographic minimization of the pumps and then the valves, or a single weighted sum of both.
+ * - the mode, the optimal route or the first feasible one, that skips the branch and bound of the minimization and is usually much faster.
+ *
+ * The labeling can be generated as the text of a prolog program, for PrologTranslationStack, or as a term, for the queries of PrologExecutor
+ * that choose the strategy on every call.
+ *
+ * @sa http://www.swi-prolog.org/pldoc/man?predicate=labeling/2
+ */
+class LABELINGSTRATEGY_EXPORT LabelingStrategy
+{
+public:
+    /**
+     * @brief The VariableSelection enum labeling/2 option that selects the next variable to label.
+     */
+    typedef enum VariableSelection_ {
+        select_leftmost,
+        select_ff,
+        select_ffc,
+        select_min,
+        select_max
+    } VariableSelection;
+
+    /**
+     * @brief The ValueOrder enum labeling/2 option that selects the order of the values of a variable.
+     */
+    typedef enum ValueOrder_ {
+        value_up,
+        value_down
+    } ValueOrder;
+
+    /**
+     * @brief The Branching enum labeling/2 option that selects how the domain of a variable is split.
+     */
+    typedef enum Branching_ {
+        branch_step,
+        branch_enum,
+        branch_bisect
+    } Branching;
+
+    /**
+     * @brief The Objective enum what is minimized by an optimal labeling.
+     */
+    typedef enum Objective_ {
+        /**
+         * @brief lexicographic_objective the sum of the absolute value of the pumps, and then the number of open valves.
+         */
+        lexicographic_objective,
+        /**
+         * @brief weighted_objective pumpWeight times the pumps cost plus valveWeight times the valves cost.
+         */
+        weighted_objective
+    } Objective;
+
+    /**
+     * @brief The Mode enum when the labeling stops.
+     */
+    typedef enum Mode_ {
+        /**
+         * @brief optimal_mode the route with the minimal cost.
+         */
+        optimal_mode,
+        /**
+         * @brief first_feasible_mode the first route found, without minimizing.
+         */
+        first_feasible_mode
+    } Mode;
+
+    /**
+     * @brief LabelingStrategy creates the default strategy.
+     */
+    LabelingStrategy();
+    virtual ~LabelingStrategy();
+
+    inline void setVariableSelection(VariableSelection selection) {
+        this->selection = selection;
+    }
+    inline VariableSelection getVariableSelection() const {
+        return selection;
+    }
+    /**
+     * @brief setVariableOrder sets the variables that are labeled first, in the given order, the names that are not variables of
+     * the machine are ignored. An empty order labels the pumps and then the valves in alphabetical order.
+     *
+     * Only the pumps and the valves are labeled, a runtime_error is thrown if any of the names is not the name of a pump or a valve.
+     */
+    void setVariableOrder(const std::vector<std::string> & order) throw(std::runtime_error);
+    inline const std::vector<std::string> & getVariableOrder() const {
+        return order;
+    }
+    inline void setValueOrder(ValueOrder valueOrder) {
+        this->valueOrder = valueOrder;
+    }
+    inline ValueOrder getValueOrder() const {
+        return valueOrder;
+    }
+    inline void setBranching(Branching branching) {
+        this->branching = branching;
+    }
+    inline Branching getBranching() const {
+        return branching;
+    }
+    inline void setObjective(Objective objective) {
+        this->objective = objective;
+    }
+    inline Objective getObjective() const {
+        return objective;
+    }
+    /**
+     * @brief setWeights sets the weights of the weighted_objective.
+     */
+    inline void setWeights(long pumpWeight, long valveWeight) {
+        this->pumpWeight = pumpWeight;
+        this->valveWeight = valveWeight;
+    }
+    inline long getPumpWeight() const {
+        return pumpWeight;
+    }
+    inline long getValveWeight() const {
+        return valveWeight;
+    }
+    inline void setMode(Mode mode) {
+        this->mode = mode;
+    }
+    inline Mode getMode() const {
+        return mode;
+    }
+
+    /**
+     * @brief generateLabeling generates the text of the labeling goal of a set of variables, without the final dot.
+     * @param variables variables of the rule, a std::set of names can also be given.
+     * @return a string with the once(labeling(...)) goal.
+     */
+    std::string generateLabeling(const VariableTable & variables) const;
+    /**
+     * @brief buildLabeling builds the term of the labeling goal.
+     * @param variables variables of the predicate.
+     * @param vars prolog variables of the predicate, ordered by id.
+     * @return the once(labeling(...)) term.
+     */
+    PlTerm buildLabeling(const VariableTable & variables, const PlTermv & vars) const;
+    /**
+     * @brief buildLabeling builds the term of the labeling goal of variables in any order.
+     * @param varNames names of the variables of the predicate, ordered by position.
+     * @param vars prolog variables of the predicate, ordered by position.
+     * @return the once(labeling(...)) term.
+     */
+    PlTerm buildLabeling(const std::vector<std::string> & varNames, const PlTermv & vars) const;
+
+    /**
+     * @brief toString returns a text that identifies the strategy, equal strategies give equal texts.
+     */
+    std::string toString() const;
+
+protected:
+    VariableSelection selection;
+    ValueOrder valueOrder;
+    Branching branching;
+    Objective objective;
+    Mode mode;
+    long pumpWeight;
+    long valveWeight;
+    /**
+     * @brief order variables labeled first.
+     */
+    std::vector<std::string> order;
+
+    /**
+     * @brief labelingPositions returns the ids of the variables to label, in labeling order.
+     */
+    std::vector<int> labelingPositions(const VariableTable & variables) const;
+    /**
+     * @brief optionNames returns the names of the search options, the ones with the clpfd default value are skipped.
+     */
+    std::vector<const char*> optionNames() const;
+    /**
+     * @brief sumText returns the text of the sum of the terms, or an empty string if there are no terms.
+     */
+    static std::string sumText(const std::vector<std::string> & terms);
+    /**
+     * @brief sumTerm returns the term of the sum of the terms, that must not be empty.
+     */
+    static PlTerm sumTerm(const std::vector<PlTerm> & terms);
+};
+
+#endif // LABELINGSTRATEGY_H
@@ -0,0 +1,768 @@
+#include "nativeconstraintsolver.h"
+
+NativeConstraintSolver::NativeConstraintSolver(const ConstraintAst & ast,
+                                               const std::vector<ConstraintAst::NodeId> & restrictions,
+                                               const VariableTable & varTable)
+    throw(std::runtime_error) :
+    RoutingEngine(), ast(ast), restrictions(restrictions), variables(varTable)
+{
+    const std::vector<std::string> & astNames = ast.getVariableNames();
+    varPositions.resize(astNames.size(), -1);
+    for(int varId = 0; varId < (int) astNames.size(); varId++) {
+        varPositions[varId] = getVarPosition(astNames[varId]);
+    }
+
+    //variables used by every restriction, to build the watch lists
+    std::vector<std::vector<std::uint32_t>> watches(variables.size());
+    std::vector<ConstraintAst::NodeId> pending;
+    for(std::uint32_t r = 0; r < (std::uint32_t) restrictions.size(); r++) {
+        pending.push_back(restrictions[r]);
+        while(!pending.empty()) {
+            const ConstraintAst::Node & node = ast.getNode(pending.back());
+            pending.pop_back();
+
+            if (node.kind == ConstraintAst::error_node) {
+                throw(std::runtime_error("NativeConstraintSolver::NativeConstraintSolver(). VAR DOMAIN ERROR: NOT EVEN SIZE"));
+            } else if (node.kind == ConstraintAst::variable_node) {
+                int pos = varPositions[node.value];
+                if (pos < 0) {
+                    throw(std::runtime_error("NativeConstraintSolver::NativeConstraintSolver(). Unknown variable " +
+                                             ast.getVariableName((int) node.value)));
+                }
+                if (watches[pos].empty() || watches[pos].back() != r) {
+                    watches[pos].push_back(r);
+                }
+            } else {
+                for(std::uint32_t c = 0; c < node.numChildren; c++) {
+                    pending.push_back(ast.getChild(node, c));
+                }
+            }
+        }
+    }
+
+    watchStart.reserve(variables.size() + 1);
+    for(const std::vector<std::uint32_t> & varWatches: watches) {
+        watchStart.push_back((std::uint32_t) watchList.size());
+        watchList.insert(watchList.end(), varWatches.begin(), varWatches.end());
+    }
+    watchStart.push_back((std::uint32_t) watchList.size());
+}
+
+NativeConstraintSolver::~NativeConstraintSolver() {
+
+}
+
+bool NativeConstraintSolver::calculateNewRoute(const std::unordered_map<std::string, long long> & inputStates,
+                                               std::unordered_map<std::string, long long> & outStates)
+    throw(std::runtime_error)
+{
+    SearchState state;
+    initState(state, NULL);
+
+    for(const auto & statePair: inputStates) {
+        int pos = getVarPosition(statePair.first);
+        if (pos < 0) {
+            throw(std::runtime_error("NativeConstraintSolver::calculateNewRoute(). Unknown variable " + statePair.first));
+        }
+        if (!fix(state, pos, statePair.second)) {
+            return false;
+        }
+    }
+    if (!propagate(state)) {
+        return false;
+    }
+
+    Objective best = {0, 0};
+    bool hasBest = false;
+    std::vector<long long> bestValues;
+    search(state, best, hasBest, bestValues);
+
+    if (hasBest) {
+        for(int pos = 0; pos < variables.size(); pos++) {
+            outStates[variables.getName(pos)] = bestValues[pos];
+        }
+    }
+    return hasBest;
+}
+
+bool NativeConstraintSolver::isFeasible(const std::vector<int> & inputPositions,
+                                        const std::vector<long long> & inputValues,
+                                        const std::vector<char> & enabled) const
+    throw(std::runtime_error)
+{
+    if (inputPositions.size() != inputValues.size()) {
+        throw(std::runtime_error("NativeConstraintSolver::isFeasible(). inputPositions and inputValues have different sizes"));
+    }
+    if (enabled.size() != restrictions.size()) {
+        throw(std::runtime_error("NativeConstraintSolver::isFeasible(). enabled must have a flag for every restriction"));
+    }
+
+    SearchState state;
+    initState(state, &enabled);
+    for(std::size_t i = 0; i < inputPositions.size(); i++) {
+        int pos = inputPositions[i];
+        if (pos < 0 || pos >= variables.size()) {
+            throw(std::runtime_error("NativeConstraintSolver::isFeasible(). Position out of range " + std::to_string(pos)));
+        }
+        if (!fix(state, pos, inputValues[i])) {
+            return false;
+        }
+    }
+    if (!propagate(state)) {
+        return false;
+    }
+
+    std::vector<long long> values;
+    return complete(state, values);
+}
+
+int NativeConstraintSolver::getVarPosition(const std::string & name) const {
+    return variables.find(name);
+}
+
+void NativeConstraintSolver::initState(SearchState & state, const std::vector<char>* enabled) const {
+    state.lo.assign(variables.size(), -NATIVE_SOLVER_INF);
+    state.hi.assign(variables.size(), NATIVE_SOLVER_INF);
+    state.enabled = enabled;
+    //a disabled restriction is marked as queued so it is never queued again
+    state.queued.assign(restrictions.size(), 1);
+    state.queue.reserve(restrictions.size());
+    for(int r = (int) restrictions.size() - 1; r >= 0; r--) {
+        if (enabled == NULL || (*enabled)[r]) {
+            state.queue.push_back(r);
+        }
+    }
+}
+
+void NativeConstraintSolver::search(SearchState & state, Objective & best, bool & hasBest, std::vector<long long> & bestValues) const
+    throw(std::runtime_error)
+{
+    if (hasBest) {
+        Objective bound = objectiveBound(state);
+        if (bound.pumps > best.pumps || (bound.pumps == best.pumps && bound.valves >= best.valves)) {
+            return;
+        }
+    }
+
+    //first fail: the pump or valve with the smallest domain
+    int pos = -1;
+    for(int candidate: variables.getLabelingIds()) {
+        if (state.lo[candidate] != state.hi[candidate] &&
+            (pos == -1 || state.hi[candidate] - state.lo[candidate] < state.hi[pos] - state.lo[pos]))
+        {
+            pos = candidate;
+        }
+    }
+
+    if (pos == -1) {
+        SearchState completeState = state;
+        std::vector<long long> values;
+        if (complete(completeState, values)) {
+            best = objectiveBound(completeState);
+            hasBest = true;
+            bestValues = std::move(values);
+        }
+        return;
+    }
+
+    long long lo = state.lo[pos];
+    long long hi = state.hi[pos];
+    if (!isFinite(lo) || !isFinite(hi)) {
+        throw(std::runtime_error("NativeConstraintSolver::search(). Unbounded variable " + variables.getName(pos)));
+    }
+
+    //the pumps are tried by absolute value so the first labelings found are already cheap, the valves in ascending order
+    bool byAbsolute = (variables.getType(pos) == VariableNominator::pump);
+    long long up = byAbsolute ? std::max(lo, std::min(0LL, hi)) : lo;
+    long long down = up - 1;
+    while (up <= hi || down >= lo) {
+        long long value;
+        if (!byAbsolute || down < lo) {
+            value = up++;
+        } else if (up > hi || std::llabs(down) < std::llabs(up)) {
+            value = down--;
+        } else {
+            value = up++;
+        }
+
+        SearchState child = state;
+        if (fix(child, pos, value) && propagate(child)) {
+            search(child, best, hasBest, bestValues);
+        }
+    }
+}
+
+bool NativeConstraintSolver::complete(SearchState & state, std::vector<long long> & values) const throw(std::runtime_error) {
+    int pos = -1;
+    for(int candidate = 0; candidate < variables.size(); candidate++) {
+        if (state.lo[candidate] != state.hi[candidate] &&
+            (pos == -1 || state.hi[candidate] - state.lo[candidate] < state.hi[pos] - state.lo[pos]) &&
+            isUsed(state, candidate))
+        {
+            pos = candidate;
+        }
+    }
+
+    if (pos == -1) {
+        //propagation may have stopped early, every restriction is checked with all the values fixed
+        for(std::size_t r = 0; r < restrictions.size(); r++) {
+            if ((state.enabled == NULL || (*state.enabled)[r]) && truth(state, restrictions[r], true) != entailed) {
+                return false;
+            }
+        }
+        values = state.lo;
+        //the variables without enabled restrictions can take any value
+        for(int unused = 0; unused < variables.size(); unused++) {
+            if (state.lo[unused] != state.hi[unused]) {
+                values[unused] = std::max(state.lo[unused], std::min(0LL, state.hi[unused]));
+            }
+        }
+        return true;
+    }
+
+    long long lo = state.lo[pos];
+    long long hi = state.hi[pos];
+    if (!isFinite(lo) || !isFinite(hi)) {
+        throw(std::runtime_error("NativeConstraintSolver::complete(). Unbounded variable " + variables.getName(pos)));
+    }
+    for(long long value = lo; value <= hi; value++) {
+        SearchState child = state;
+        if (fix(child, pos, value) && propagate(child) && complete(child, values)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NativeConstraintSolver::isUsed(const SearchState & state, int pos) const {
+    if (state.enabled == NULL) {
+        return true;
+    }
+    for(std::uint32_t i = watchStart[pos]; i < watchStart[pos + 1]; i++) {
+        if ((*state.enabled)[watchList[i]]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+NativeConstraintSolver::Objective NativeConstraintSolver::objectiveBound(const SearchState & state) const {
+    Objective bound = {0, 0};
+    for(int pos: variables.getLabelingIds()) {
+        long long lo = state.lo[pos];
+        long long hi = state.hi[pos];
+        if (variables.getType(pos) == VariableNominator::pump) {
+            long long minAbs = (lo <= 0 && hi >= 0) ? 0 : std::min(std::llabs(lo), std::llabs(hi));
+            bound.pumps = add(bound.pumps, minAbs);
+        } else {
+            bound.valves = add(bound.valves, std::min(lo, 1LL));
+        }
+    }
+    return bound;
+}
+
+bool NativeConstraintSolver::propagate(SearchState & state) const {
+    //each revision can narrow a bound by only one unit, the limit stops cycles over huge domains
+    std::size_t maxRevisions = 64 * restrictions.size() + 1024;
+    std::size_t revisions = 0;
+
+    while (!state.queue.empty() && revisions < maxRevisions) {
+        int r = state.queue.back();
+        state.queue.pop_back();
+        state.queued[r] = 0;
+        revisions++;
+
+        if (!revise(state, restrictions[r], true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NativeConstraintSolver::fix(SearchState & state, int pos, long long value) const {
+    return narrow(state, pos, value, value);
+}
+
+bool NativeConstraintSolver::narrow(SearchState & state, int pos, long long lo, long long hi) const {
+    long long newLo = std::max(state.lo[pos], lo);
+    long long newHi = std::min(state.hi[pos], hi);
+    if (newLo > newHi) {
+        return false;
+    }
+
+    if (newLo != state.lo[pos] || newHi != state.hi[pos]) {
+        state.lo[pos] = newLo;
+        state.hi[pos] = newHi;
+        for(std::uint32_t w = watchStart[pos]; w < watchStart[pos + 1]; w++) {
+            std::uint32_t r = watchList[w];
+            if (!state.queued[r]) {
+                state.queued[r] = 1;
+                state.queue.push_back(r);
+            }
+        }
+    }
+    return true;
+}
+
+bool NativeConstraintSolver::revise(SearchState & state, ConstraintAst::NodeId id, bool positive) const {
+    const ConstraintAst::Node & node = ast.getNode(id);
+
+    switch (node.kind) {
+    case ConstraintAst::equality_node: {
+        Equality::ComparatorOp op = (Equality::ComparatorOp) node.op;
+        return reviseComparison(state, node, positive ? op : negate(op));
+    }
+    case ConstraintAst::conjunction_node: {
+        bool isAnd = ((Conjunction::BoolOperators) node.op == Conjunction::predicate_and);
+        ConstraintAst::NodeId left = ast.getChild(node, 0);
+        ConstraintAst::NodeId right = ast.getChild(node, 1);
+        //not (A or B) is (not A and not B), not (A and B) is (not A or not B)
+        if (isAnd == positive) {
+            return revise(state, left, positive) && revise(state, right, positive);
+        } else {
+            return reviseDisjunction(state, left, positive, right, positive);
+        }
+    }
+    case ConstraintAst::implication_node: {
+        ConstraintAst::NodeId left = ast.getChild(node, 0);
+        ConstraintAst::NodeId right = ast.getChild(node, 1);
+        if (positive) {
+            return reviseDisjunction(state, left, false, right, true);
+        } else {
+            return revise(state, left, true) && revise(state, right, false);
+        }
+    }
+    case ConstraintAst::domain_node:
+        return reviseDomain(state, node, positive);
+    case ConstraintAst::error_node:
+        return false;
+    default:
+        return true;
+    }
+}
+
+bool NativeConstraintSolver::reviseDisjunction(SearchState & state,
+                                               ConstraintAst::NodeId left, bool leftPositive,
+                                               ConstraintAst::NodeId right, bool rightPositive) const
+{
+    Truth leftTruth = truth(state, left, leftPositive);
+    Truth rightTruth = truth(state, right, rightPositive);
+
+    if (leftTruth == entailed || rightTruth == entailed) {
+        return true;
+    } else if (leftTruth == disentailed && rightTruth == disentailed) {
+        return false;
+    } else if (leftTruth == disentailed) {
+        return revise(state, right, rightPositive);
+    } else if (rightTruth == disentailed) {
+        return revise(state, left, leftPositive);
+    } else {
+        return true;
+    }
+}
+
+NativeConstraintSolver::Truth NativeConstraintSolver::truth(const SearchState & state, ConstraintAst::NodeId id, bool positive) const {
+    const ConstraintAst::Node & node = ast.getNode(id);
+
+    switch (node.kind) {
+    case ConstraintAst::equality_node: {
+        Interval a = evaluate(state, ast.getChild(node, 0));
+        Interval b = evaluate(state, ast.getChild(node, 1));
+        if (a.lo > a.hi || b.lo > b.hi) {
+            return disentailed;
+        }
+
+        Equality::ComparatorOp op = (Equality::ComparatorOp) node.op;
+        if (!positive) {
+            op = negate(op);
+        }
+        switch (op) {
+        case Equality::equal:
+            if (a.lo == a.hi && b.lo == b.hi && a.lo == b.lo) {
+                return entailed;
+            } else if (a.hi < b.lo || b.hi < a.lo) {
+                return disentailed;
+            }
+            return unknown;
+        case Equality::not_equal:
+            if (a.hi < b.lo || b.hi < a.lo) {
+                return entailed;
+            } else if (a.lo == a.hi && b.lo == b.hi && a.lo == b.lo) {
+                return disentailed;
+            }
+            return unknown;
+        case Equality::bigger:
+            return (a.lo > b.hi) ? entailed : ((a.hi <= b.lo) ? disentailed : unknown);
+        case Equality::bigger_equal:
+            return (a.lo >= b.hi) ? entailed : ((a.hi < b.lo) ? disentailed : unknown);
+        case Equality::lesser:
+            return (a.hi < b.lo) ? entailed : ((a.lo >= b.hi) ? disentailed : unknown);
+        case Equality::lesser_equal:
+            return (a.hi <= b.lo) ? entailed : ((a.lo > b.hi) ? disentailed : unknown);
+        default:
+            return unknown;
+        }
+    }
+    case ConstraintAst::conjunction_node:
+    case ConstraintAst::implication_node: {
+        ConstraintAst::NodeId left = ast.getChild(node, 0);
+        ConstraintAst::NodeId right = ast.getChild(node, 1);
+
+        bool isAnd;
+        bool leftPositive = positive;
+        if (node.kind == ConstraintAst::conjunction_node) {
+            isAnd = (((Conjunction::BoolOperators) node.op == Conjunction::predicate_and) == positive);
+        } else {
+            //A #==> B is (not A or B), its negation is (A and not B)
+            isAnd = !positive;
+            leftPositive = !positive;
+        }
+
+        Truth leftTruth = truth(state, left, leftPositive);
+        Truth rightTruth = truth(state, right, positive);
+        if (isAnd) {
+            if (leftTruth == disentailed || rightTruth == disentailed) {
+                return disentailed;
+            }
+            return (leftTruth == entailed && rightTruth == entailed) ? entailed : unknown;
+        } else {
+            if (leftTruth == entailed || rightTruth == entailed) {
+                return entailed;
+            }
+            return (leftTruth == disentailed && rightTruth == disentailed) ? disentailed : unknown;
+        }
+    }
+    case ConstraintAst::domain_node: {
+        Interval v = evaluate(state, ast.getChild(node, 0));
+        bool inside = false;
+        bool intersects = false;
+        for(std::uint32_t i = 1; i + 1 < node.numChildren; i += 2) {
+            Interval min = evaluate(state, ast.getChild(node, i));
+            Interval max = evaluate(state, ast.getChild(node, i + 1));
+            if (v.lo >= min.hi && v.hi <= max.lo) {
+                inside = true;
+            }
+            if (v.hi >= min.lo && v.lo <= max.hi) {
+                intersects = true;
+            }
+        }
+        if (inside) {
+            return positive ? entailed : disentailed;
+        } else if (!intersects) {
+            return positive ? disentailed : entailed;
+        }
+        return unknown;
+    }
+    case ConstraintAst::error_node:
+        return disentailed;
+    default:
+        return unknown;
+    }
+}
+
+bool NativeConstraintSolver::reviseComparison(SearchState & state, const ConstraintAst::Node & node, Equality::ComparatorOp op) const {
+    ConstraintAst::NodeId left = ast.getChild(node, 0);
+    ConstraintAst::NodeId right = ast.getChild(node, 1);
+
+    Interval a = evaluate(state, left);
+    Interval b = evaluate(state, right);
+    if (a.lo > a.hi || b.lo > b.hi) {
+        return false;
+    }
+
+    switch (op) {
+    case Equality::equal: {
+        Interval both = {std::max(a.lo, b.lo), std::min(a.hi, b.hi)};
+        return project(state, left, both) && project(state, right, both);
+    }
+    case Equality::not_equal:
+        //only a bound equal to a fixed value can be removed from an interval
+        if (a.lo == a.hi && b.lo == b.hi) {
+            return a.lo != b.lo;
+        } else if (a.lo == a.hi) {
+            if (b.lo == a.lo) {
+                return project(state, right, {add(b.lo, 1), b.hi});
+            } else if (b.hi == a.lo) {
+                return project(state, right, {b.lo, add(b.hi, -1)});
+            }
+        } else if (b.lo == b.hi) {
+            if (a.lo == b.lo) {
+                return project(state, left, {add(a.lo, 1), a.hi});
+            } else if (a.hi == b.lo) {
+                return project(state, left, {a.lo, add(a.hi, -1)});
+            }
+        }
+        return true;
+    case Equality::bigger:
+        if (!project(state, left, {add(b.lo, 1), NATIVE_SOLVER_INF})) {
+            return false;
+        }
+        a = evaluate(state, left);
+        return project(state, right, {-NATIVE_SOLVER_INF, add(a.hi, -1)});
+    case Equality::bigger_equal:
+        if (!project(state, left, {b.lo, NATIVE_SOLVER_INF})) {
+            return false;
+        }
+        a = evaluate(state, left);
+        return project(state, right, {-NATIVE_SOLVER_INF, a.hi});
+    case Equality::lesser:
+        if (!project(state, left, {-NATIVE_SOLVER_INF, add(b.hi, -1)})) {
+            return false;
+        }
+        a = evaluate(state, left);
+        return project(state, right, {add(a.lo, 1), NATIVE_SOLVER_INF});
+    case Equality::lesser_equal:
+        if (!project(state, left, {-NATIVE_SOLVER_INF, b.hi})) {
+            return false;
+        }
+        a = evaluate(state, left);
+        return project(state, right, {a.lo, NATIVE_SOLVER_INF});
+    default:
+        return true;
+    }
+}
+
+bool NativeConstraintSolver::reviseDomain(SearchState & state, const ConstraintAst::Node & node, bool positive) const {
+    ConstraintAst::NodeId variable = ast.getChild(node, 0);
+    Interval v = evaluate(state, variable);
+
+    if (positive) {
+        //the smallest and the biggest values of the domain that are inside any of the intervals
+        Interval hull = {NATIVE_SOLVER_INF, -NATIVE_SOLVER_INF};
+        for(std::uint32_t i = 1; i + 1 < node.numChildren; i += 2) {
+            long long min = evaluate(state, ast.getChild(node, i)).lo;
+            long long max = evaluate(state, ast.getChild(node, i + 1)).hi;
+            if (max >= v.lo && min <= v.hi) {
+                hull.lo = std::min(hull.lo, std::max(min, v.lo));
+                hull.hi = std::max(hull.hi, std::min(max, v.hi));
+            }
+        }
+        return project(state, variable, hull);
+    } else {
+        //the bounds are moved out of the intervals until none of them contains a bound
+        bool changed = true;
+        while (changed && v.lo <= v.hi) {
+            changed = false;
+            for(std::uint32_t i = 1; i + 1 < node.numChildren; i += 2) {
+                Interval min = evaluate(state, ast.getChild(node, i));
+                Interval max = evaluate(state, ast.getChild(node, i + 1));
+                if (min.lo != min.hi || max.lo != max.hi) {
+                    continue;
+                }
+                if (v.lo >= min.lo && v.lo <= max.hi) {
+                    v.lo = add(max.hi, 1);
+                    changed = true;
+                }
+                if (v.hi >= min.lo && v.hi <= max.hi) {
+                    v.hi = add(min.lo, -1);
+                    changed = true;
+                }
+            }
+        }
+        return project(state, variable, v);
+    }
+}
+
+NativeConstraintSolver::Interval NativeConstraintSolver::evaluate(const SearchState & state, ConstraintAst::NodeId id) const {
+    const ConstraintAst::Node & node = ast.getNode(id);
+
+    switch (node.kind) {
+    case ConstraintAst::variable_node: {
+        int pos = varPositions[node.value];
+        return {state.lo[pos], state.hi[pos]};
+    }
+    case ConstraintAst::number_node:
+        return {(long long) node.value, (long long) node.value};
+    case ConstraintAst::unary_node: {
+        Interval a = evaluate(state, ast.getChild(node, 0));
+        if ((RuleUnaryOperation::UnaryOperators) node.op != RuleUnaryOperation::absolute_value || a.lo >= 0) {
+            return a;
+        } else if (a.hi <= 0) {
+            return {-a.hi, -a.lo};
+        } else {
+            return {0, std::max(-a.lo, a.hi)};
+        }
+    }
+    case ConstraintAst::binary_node: {
+        Interval a = evaluate(state, ast.getChild(node, 0));
+        Interval b = evaluate(state, ast.getChild(node, 1));
+        if (a.lo > a.hi || b.lo > b.hi) {
+            return {1, 0};
+        }
+
+        switch ((BinaryOperation::BinaryOperators) node.op) {
+        case BinaryOperation::add:
+            return {add(a.lo, b.lo), add(a.hi, b.hi)};
+        case BinaryOperation::subtract:
+            return {add(a.lo, -b.hi), add(a.hi, -b.lo)};
+        case BinaryOperation::multiply: {
+            long long p1 = multiply(a.lo, b.lo);
+            long long p2 = multiply(a.lo, b.hi);
+            long long p3 = multiply(a.hi, b.lo);
+            long long p4 = multiply(a.hi, b.hi);
+            return {std::min(std::min(p1, p2), std::min(p3, p4)), std::max(std::max(p1, p2), std::max(p3, p4))};
+        }
+        case BinaryOperation::divide: {
+            //truncated division is monotone for a divisor of constant sign, the negative and positive divisors are evaluated apart
+            Interval result = {NATIVE_SOLVER_INF, -NATIVE_SOLVER_INF};
+            Interval parts[] = {{b.lo, std::min(b.hi, -1LL)}, {std::max(b.lo, 1LL), b.hi}};
+            for(const Interval & part: parts) {
+                if (part.lo <= part.hi) {
+                    long long q[] = {a.lo / part.lo, a.lo / part.hi, a.hi / part.lo, a.hi / part.hi};
+                    for(long long value: q) {
+                        result.lo = std::min(result.lo, value);
+                        result.hi = std::max(result.hi, value);
+                    }
+                }
+            }
+            return result;
+        }
+        case BinaryOperation::module: {
+            //the remainder has the sign of the dividend and its absolute value is lesser than the divisor
+            if (b.lo == 0 && b.hi == 0) {
+                return {1, 0};
+            } else if (a.lo == a.hi && b.lo == b.hi) {
+                return {a.lo % b.lo, a.lo % b.lo};
+            }
+            long long m = std::max(std::llabs(b.lo), std::llabs(b.hi)) - 1;
+            return {(a.lo >= 0) ? 0 : std::max(a.lo, -m), (a.hi <= 0) ? 0 : std::min(a.hi, m)};
+        }
+        default:
+            return {-NATIVE_SOLVER_INF, NATIVE_SOLVER_INF};
+        }
+    }
+    default:
+        return {-NATIVE_SOLVER_INF, NATIVE_SOLVER_INF};
+    }
+}
+
+bool NativeConstraintSolver::project(SearchState & state, ConstraintAst::NodeId id, Interval target) const {
+    if (target.lo > target.hi) {
+        return false;
+    }
+
+    const ConstraintAst::Node & node = ast.getNode(id);
+    switch (node.kind) {
+    case ConstraintAst::variable_node:
+        return narrow(state, varPositions[node.value], target.lo, target.hi);
+    case ConstraintAst::number_node:
+        return node.value >= target.lo && node.value <= target.hi;
+    case ConstraintAst::unary_node: {
+        ConstraintAst::NodeId operand = ast.getChild(node, 0);
+        if ((RuleUnaryOperation::UnaryOperators) node.op != RuleUnaryOperation::absolute_value) {
+            return project(state, operand, target);
+        }
+        if (target.hi < 0 || !project(state, operand, {-target.hi, target.hi})) {
+            return false;
+        }
+        //abs(X) >= k with k > 0 removes the values between -k and k, only a bound can be moved
+        if (target.lo > 0) {
+            Interval a = evaluate(state, operand);
+            if (a.lo > -target.lo) {
+                return project(state, operand, {target.lo, a.hi});
+            } else if (a.hi < target.lo) {
+                return project(state, operand, {a.lo, -target.lo});
+            }
+        }
+        return true;
+    }
+    case ConstraintAst::binary_node: {
+        ConstraintAst::NodeId left = ast.getChild(node, 0);
+        ConstraintAst::NodeId right = ast.getChild(node, 1);
+        Interval a = evaluate(state, left);
+        Interval b = evaluate(state, right);
+
+        switch ((BinaryOperation::BinaryOperators) node.op) {
+        case BinaryOperation::add:
+            if (!project(state, left, {add(target.lo, -b.hi), add(target.hi, -b.lo)})) {
+                return false;
+            }
+            a = evaluate(state, left);
+            return project(state, right, {add(target.lo, -a.hi), add(target.hi, -a.lo)});
+        case BinaryOperation::subtract:
+            if (!project(state, left, {add(target.lo, b.lo), add(target.hi, b.hi)})) {
+                return false;
+            }
+            a = evaluate(state, left);
+            return project(state, right, {add(a.lo, -target.hi), add(a.hi, -target.lo)});
+        case BinaryOperation::multiply:
+            //only multiplications by a fixed value are projected
+            if (b.lo == b.hi && b.lo != 0) {
+                long long c = b.lo;
+                return project(state, left, (c > 0) ? Interval{divideCeil(target.lo, c), divideFloor(target.hi, c)}
+                                                    : Interval{divideCeil(target.hi, c), divideFloor(target.lo, c)});
+            } else if (a.lo == a.hi && a.lo != 0) {
+                long long c = a.lo;
+                return project(state, right, (c > 0) ? Interval{divideCeil(target.lo, c), divideFloor(target.hi, c)}
+                                                     : Interval{divideCeil(target.hi, c), divideFloor(target.lo, c)});
+            }
+            break;
+        default:
+            break;
+        }
+
+        Interval value = evaluate(state, id);
+        return value.lo <= value.hi && value.hi >= target.lo && value.lo <= target.hi;
+    }
+    default:
+        return true;
+    }
+}
+
+Equality::ComparatorOp NativeConstraintSolver::negate(Equality::ComparatorOp op) {
+    switch (op) {
+    case Equality::equal:
+        return Equality::not_equal;
+    case Equality::not_equal:
+        return Equality::equal;
+    case Equality::bigger:
+        return Equality::lesser_equal;
+    case Equality::bigger_equal:
+        return Equality::lesser;
+    case Equality::lesser:
+        return Equality::bigger_equal;
+    default:
+        return Equality::bigger;
+    }
+}
+
+long long NativeConstraintSolver::add(long long a, long long b) {
+    if (!isFinite(a)) {
+        return a;
+    } else if (!isFinite(b)) {
+        return b;
+    }
+    return std::max(-NATIVE_SOLVER_INF, std::min(NATIVE_SOLVER_INF, a + b));
+}
+
+long long NativeConstraintSolver::multiply(long long a, long long b) {
+    long double product = (long double) a * (long double) b;
+    if (product >= (long double) NATIVE_SOLVER_INF) {
+        return NATIVE_SOLVER_INF;
+    } else if (product <= (long double) -NATIVE_SOLVER_INF) {
+        return -NATIVE_SOLVER_INF;
+    }
+    return a * b;
+}
+
+long long NativeConstraintSolver::divideFloor(long long a, long long b) {
+    if (!isFinite(a)) {
+        return ((a < 0) == (b < 0)) ? NATIVE_SOLVER_INF : -NATIVE_SOLVER_INF;
+    }
+    long long q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) {
+        q--;
+    }
+    return q;
+}
+
+long long NativeConstraintSolver::divideCeil(long long a, long long b) {
+    if (!isFinite(a)) {
+        return ((a < 0) == (b < 0)) ? NATIVE_SOLVER_INF : -NATIVE_SOLVER_INF;
+    }
+    long long q = a / b;
+    if ((a % b != 0) && ((a < 0) == (b < 0))) {
+        q++;
+    }
+    return q;
+}
@@ -0,0 +1,288 @@
+#ifndef NATIVECONSTRAINTSOLVER_H
+#define NATIVECONSTRAINTSOLVER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+#include <fluidicmachinemodel/machine_graph_utils/variablenominator.h>
+#include <fluidicmachinemodel/rules/conjunction.h>
+#include <fluidicmachinemodel/rules/arithmetic/binaryoperation.h>
+#include <fluidicmachinemodel/rules/arithmetic/unaryoperation.h>
+#include <fluidicmachinemodel/rules/equality.h>
+
+#include "constraintengine/constraintast.h"
+#include "constraintengine/variabletable.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief NATIVE_SOLVER_INF bound used as infinity by NativeConstraintSolver, the result of every operation is saturated to
+ * [-NATIVE_SOLVER_INF, NATIVE_SOLVER_INF].
+ */
+#define NATIVE_SOLVER_INF 1000000000000000LL
+
+/**
+ * @brief The NativeConstraintSolver class is a RoutingEngine that solves the translated restrictions without the swi-prolog interpreter.
+ *
+ * The NativeConstraintSolver class implements in C++ the subset of clpfd used by the translated rules: integer variables with interval
+ * domains, the operations + - * // rem abs, the comparisons, #/\ #\/ and the implication. The domain of every variable is an interval
+ * stored in two flat arrays, one with the lower bounds and one with the upper bounds, and the restrictions are propagated with
+ * bounds consistency: the interval of every expression is evaluated bottom-up and then narrowed top-down to the values allowed by the
+ * comparison. Only the restrictions that use a variable whose bounds have changed are revised again.
+ *
+ * The search is the same as the labeling predicate generated by PrologTranslationStack: the pumps and the valves are labeled first fail
+ * first, minimizing first the sum of the absolute value of the pumps and then the number of open valves, with branch and bound. The
+ * rest of the variables get the smallest value compatible with the best labeling. A runtime_error is thrown if any of them is unbounded,
+ * as in the prolog implementation it would not be ground.
+ *
+ * This is the only difference in the result of both engines: clpfd does not label the variables that are not pumps nor valves, so when
+ * the propagation does not fix one of them PrologExecutor can not read its value and throws a runtime_error, while this solver returns
+ * the route with the smallest value of the variable. When PrologExecutor finds a route both engines return routes with the same cost,
+ * and the same state for the same values of the pumps and the valves.
+ *
+ * calculateNewRoute does not modify the solver, so it can be invoked at the same time from several threads.
+ *
+ * @sa RoutingEngine, @sa NativeTranslationStack
+ */
+class NATIVECONSTRAINTSOLVER_EXPORT NativeConstraintSolver : public RoutingEngine
+{
+public:
+    /**
+     * @brief NativeConstraintSolver creates a new solver for a set of translated restrictions, the tree is copied.
+     *
+     * A runtime_error is thrown if a restriction has a malformed domain or uses a variable that is not in varTable.
+     *
+     * @param ast tree with the translated restrictions.
+     * @param restrictions id of the root node of every restriction.
+     * @param varTable name of the variables of the machine, in alphabetical order.
+     */
+    NativeConstraintSolver(const ConstraintAst & ast,
+                           const std::vector<ConstraintAst::NodeId> & restrictions,
+                           const VariableTable & varTable) throw(std::runtime_error);
+    virtual ~NativeConstraintSolver();
+
+    /**
+     * @brief calculateNewRoute solves the restrictions with the values of the variables received as input.
+     *
+     * @param inputStates map with the name as key and the value of the variables that are fixed. A runtime_error is thrown if any of
+     * the names is not a variable of the machine.
+     * @param outStates map with the name as key and the value of every variable of the machine. If no solution is found for the given
+     * input, the map is returned intact.
+     * @return true if a state compatible with the input data is found, false otherwise.
+     */
+    virtual bool calculateNewRoute(const std::unordered_map<std::string, long long> & inputStates,
+                                   std::unordered_map<std::string, long long> & outStates) throw(std::runtime_error);
+
+    /**
+     * @brief isFeasible returns true if there is a value for every variable that satisfies the enabled restrictions with the given
+     * input, without minimizing anything. Used by ConflictExplainer to check subsets of the restrictions.
+     *
+     * The variables that no enabled restriction uses are ignored, they can take any value. A runtime_error is thrown if the sizes do
+     * not match, a position is out of range, or a variable used by an enabled restriction is unbounded because the restrictions that
+     * bound it are disabled.
+     *
+     * @param inputPositions positions of the fixed variables.
+     * @param inputValues value of every fixed variable, in the same order.
+     * @param enabled one flag per restriction, in the order given to the constructor, the restrictions with 0 are ignored.
+     * @return true if a solution exists, false otherwise.
+     */
+    bool isFeasible(const std::vector<int> & inputPositions,
+                    const std::vector<long long> & inputValues,
+                    const std::vector<char> & enabled) const throw(std::runtime_error);
+
+    /**
+     * @brief getVarPosition returns the position of a variable in the state vectors, -1 if the variable does not exist.
+     */
+    int getVarPosition(const std::string & name) const;
+    /**
+     * @brief getVarNames returns the names of the variables ordered by position.
+     */
+    inline const std::vector<std::string> & getVarNames() const {
+        return variables.getNames();
+    }
+
+protected:
+    /**
+     * @brief The Interval struct a closed interval of integers.
+     */
+    typedef struct Interval {
+        long long lo;
+        long long hi;
+    } Interval;
+
+    /**
+     * @brief The Truth enum state of a restriction for the current domains.
+     */
+    typedef enum Truth_ {
+        entailed,
+        disentailed,
+        unknown
+    } Truth;
+
+    /**
+     * @brief The SearchState struct domains of all the variables at a node of the search, plus the restrictions to revise.
+     */
+    typedef struct SearchState {
+        std::vector<long long> lo;
+        std::vector<long long> hi;
+        std::vector<int> queue;
+        std::vector<char> queued;
+        /**
+         * @brief enabled one flag per restriction, NULL if all of them are enabled.
+         */
+        const std::vector<char>* enabled;
+    } SearchState;
+
+    /**
+     * @brief The Objective struct cost of a labeling, pumps first and valves second.
+     */
+    typedef struct Objective {
+        long long pumps;
+        long long valves;
+    } Objective;
+
+    /**
+     * @brief ast copy of the tree with the restrictions.
+     */
+    ConstraintAst ast;
+    /**
+     * @brief restrictions id of the root node of every restriction.
+     */
+    std::vector<ConstraintAst::NodeId> restrictions;
+    /**
+     * @brief variables symbol table of the variables, the id of a variable is its position in the state vectors.
+     */
+    VariableTable variables;
+    /**
+     * @brief varPositions position of every variable of the tree, indexed by the id of the variable in the tree.
+     */
+    std::vector<int> varPositions;
+    /**
+     * @brief watchStart position in watchList of the first restriction of every variable, watchStart[numVars] is the size of watchList.
+     */
+    std::vector<std::uint32_t> watchStart;
+    /**
+     * @brief watchList indexes in restrictions of the restrictions that use each variable, contiguous by variable.
+     */
+    std::vector<std::uint32_t> watchList;
+
+    /**
+     * @brief initState sets every domain to the whole range and queues the enabled restrictions.
+     * @param enabled one flag per restriction, NULL to enable all of them.
+     */
+    void initState(SearchState & state, const std::vector<char>* enabled) const;
+    /**
+     * @brief search branch and bound over the pumps and the valves.
+     * @param state domains at the current node, already propagated.
+     * @param best cost of the best labeling found, only valid if hasBest is true.
+     * @param hasBest true if a labeling has been found.
+     * @param bestValues values of every variable at the best labeling.
+     */
+    void search(SearchState & state, Objective & best, bool & hasBest, std::vector<long long> & bestValues) const
+        throw(std::runtime_error);
+    /**
+     * @brief complete gives a value to the variables that are not pumps nor valves, the ones that no enabled restriction uses get the
+     * value of their domain closest to 0.
+     * @param state domains at the current node, already propagated.
+     * @param values filled with the value of every variable if the method returns true.
+     * @return true if a value compatible with the restrictions has been found for all the variables.
+     */
+    bool complete(SearchState & state, std::vector<long long> & values) const throw(std::runtime_error);
+    /**
+     * @brief isUsed returns true if an enabled restriction uses a variable, always true when all the restrictions are enabled.
+     */
+    bool isUsed(const SearchState & state, int pos) const;
+    /**
+     * @brief objectiveBound returns the minimum cost of any labeling compatible with the domains.
+     */
+    Objective objectiveBound(const SearchState & state) const;
+
+    /**
+     * @brief propagate revises the restrictions in the queue of the state until no domain changes.
+     * @return false if a domain becomes empty.
+     */
+    bool propagate(SearchState & state) const;
+    /**
+     * @brief fix sets the domain of a variable to a single value and queues its restrictions.
+     * @return false if the value is not in the domain.
+     */
+    bool fix(SearchState & state, int pos, long long value) const;
+    /**
+     * @brief narrow intersects the domain of a variable with an interval, the restrictions of the variable are queued if it changes.
+     * @return false if the domain becomes empty.
+     */
+    bool narrow(SearchState & state, int pos, long long lo, long long hi) const;
+
+    /**
+     * @brief revise narrows the domains so a restriction, or its negation, can hold.
+     * @param state current domains.
+     * @param id node of the restriction.
+     * @param positive true to enforce the restriction, false to enforce its negation.
+     * @return false if the restriction can not hold.
+     */
+    bool revise(SearchState & state, ConstraintAst::NodeId id, bool positive) const;
+    /**
+     * @brief truth returns if a restriction, or its negation, holds for every value of the domains, for none, or is unknown.
+     */
+    Truth truth(const SearchState & state, ConstraintAst::NodeId id, bool positive) const;
+    /**
+     * @brief reviseDisjunction narrows the domains so at least one of two restrictions can hold, a restriction is only narrowed
+     * when the other one can not hold.
+     */
+    bool reviseDisjunction(SearchState & state,
+                           ConstraintAst::NodeId left, bool leftPositive,
+                           ConstraintAst::NodeId right, bool rightPositive) const;
+    /**
+     * @brief reviseComparison narrows the domains of the operands of a comparison.
+     */
+    bool reviseComparison(SearchState & state, const ConstraintAst::Node & node, Equality::ComparatorOp op) const;
+    /**
+     * @brief reviseDomain narrows the domain of a variable to the intervals of a domain node.
+     */
+    bool reviseDomain(SearchState & state, const ConstraintAst::Node & node, bool positive) const;
+
+    /**
+     * @brief evaluate returns the interval of all the values an expression can take with the current domains.
+     */
+    Interval evaluate(const SearchState & state, ConstraintAst::NodeId id) const;
+    /**
+     * @brief project narrows the domains of the variables of an expression so its value is inside target.
+     * @return false if the expression can not take any value of target.
+     */
+    bool project(SearchState & state, ConstraintAst::NodeId id, Interval target) const;
+
+    /**
+     * @brief negate returns the comparison that holds when op does not.
+     */
+    static Equality::ComparatorOp negate(Equality::ComparatorOp op);
+    /**
+     * @brief add returns a + b saturated to [-NATIVE_SOLVER_INF, NATIVE_SOLVER_INF].
+     */
+    static long long add(long long a, long long b);
+    /**
+     * @brief multiply returns a * b saturated to [-NATIVE_SOLVER_INF, NATIVE_SOLVER_INF].
+     */
+    static long long multiply(long long a, long long b);
+    /**
+     * @brief divideFloor returns the largest integer not greater than a / b, b must not be 0.
+     */
+    static long long divideFloor(long long a, long long b);
+    /**
+     * @brief divideCeil returns the smallest integer not lesser than a / b, b must not be 0.
+     */
+    static long long divideCeil(long long a, long long b);
+    /**
+     * @brief isFinite returns true if a bound is not one of the infinities.
+     */
+    static inline bool isFinite(long long value) {
+        return value > -NATIVE_SOLVER_INF && value < NATIVE_SOLVER_INF;
+    }
+};
+
+#endif // NATIVECONSTRAINTSOLVER_H
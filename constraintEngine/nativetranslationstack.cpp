@@ -0,0 +1,17 @@
+#include "nativetranslationstack.h"
+
+NativeTranslationStack::NativeTranslationStack() :
+    AstTranslationStack()
+{
+
+}
+
+NativeTranslationStack::~NativeTranslationStack() {
+
+}
+
+RoutingEngine* NativeTranslationStack::getRoutingEngine() {
+    prepareRestrictions();
+    NativeConstraintSolver* routingEngine = new NativeConstraintSolver(ast, restrictions, getVariableTable());
+    return routingEngine;
+}
@@ -0,0 +1,40 @@
+#ifndef NATIVETRANSLATIONSTACK_H
+#define NATIVETRANSLATIONSTACK_H
+
+#include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+
+#include "constraintengine/asttranslationstack.h"
+#include "constraintengine/nativeconstraintsolver.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The NativeTranslationStack class translates a set of abstract rules to a NativeConstraintSolver.
+ *
+ * The NativeTranslationStack class keeps the translated rules as a ConstraintAst, and getRoutingEngine() hands the tree to a new
+ * NativeConstraintSolver, so the machine can be solved without starting the swi-prolog interpreter.
+ *
+ * @sa AstTranslationStack, @sa NativeConstraintSolver
+ */
+class NATIVETRANSLATIONSTACK_EXPORT NativeTranslationStack : public AstTranslationStack
+{
+public:
+    /**
+     * @brief NativeTranslationStack creates a new stack
+     */
+    NativeTranslationStack();
+    /**
+     * @brief ~NativeTranslationStack destroys the stack
+     */
+    virtual ~NativeTranslationStack();
+
+    /**
+     * @brief getRoutingEngine creates a new NativeConstraintSolver from the translated tree.
+     * @return a pointer to the newly created NativeConstraintSolver
+     *
+     * @sa NativeConstraintSolver
+     */
+    virtual RoutingEngine* getRoutingEngine();
+};
+
+#endif // NATIVETRANSLATIONSTACK_H
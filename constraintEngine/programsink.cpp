@@ -0,0 +1,46 @@
+#include "programsink.h"
+
+ProgramSink::ProgramSink(QIODevice* device, std::size_t bufferSize) {
+    this->device = device;
+    this->bufferSize = bufferSize;
+    this->bytesWritten = 0;
+    this->buffer.reserve(bufferSize);
+}
+
+ProgramSink::~ProgramSink() {
+    try {
+        flush();
+    } catch (std::runtime_error & e) {
+        //the destructor must not throw, the caller checks the device
+    }
+}
+
+void ProgramSink::write(const std::string & text) throw(std::runtime_error) {
+    write(text.data(), text.size());
+}
+
+void ProgramSink::write(const char* data, std::size_t size) throw(std::runtime_error) {
+    bytesWritten += size;
+    if (buffer.size() + size > bufferSize) {
+        flush();
+        //a piece bigger than the buffer goes straight to the device
+        if (size > bufferSize) {
+            if (device->write(data, (long long) size) != (long long) size) {
+                throw(std::runtime_error("ProgramSink::write(). Impossible to write to the device, " + device->errorString().toStdString()));
+            }
+            return;
+        }
+    }
+    buffer.append(data, size);
+}
+
+void ProgramSink::flush() throw(std::runtime_error) {
+    if (!buffer.empty()) {
+        long long size = (long long) buffer.size();
+        long long written = device->write(buffer.data(), size);
+        buffer.clear();
+        if (written != size) {
+            throw(std::runtime_error("ProgramSink::flush(). Impossible to write to the device, " + device->errorString().toStdString()));
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef PROGRAMSINK_H
+#define PROGRAMSINK_H
+
+#include <stdexcept>
+#include <string>
+
+#include <QIODevice>
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief PROGRAM_SINK_BUFFER_SIZE default number of bytes kept by a ProgramSink before they are written to its device.
+ */
+#define PROGRAM_SINK_BUFFER_SIZE 65536
+
+/**
+ * @brief The ProgramSink class writes the text of a prolog program to a device as it is generated.
+ *
+ * The ProgramSink class keeps a small buffer and writes it to the device, a file or a QBuffer in memory, each time it is full, so
+ * a program can be emitted piece by piece without holding its whole text. The text is written as it is given, the generated programs
+ * are UTF-8 std::string so no conversion is needed.
+ *
+ * The device must be open for writing and outlive the sink. The destructor writes what is left at the buffer.
+ *
+ * @sa PrologTranslationStack::setStreaming
+ */
+class PROGRAMSINK_EXPORT ProgramSink
+{
+public:
+    /**
+     * @brief ProgramSink creates a sink that writes to a device.
+     * @param device device open for writing.
+     * @param bufferSize number of bytes kept before writing them to the device.
+     */
+    ProgramSink(QIODevice* device, std::size_t bufferSize = PROGRAM_SINK_BUFFER_SIZE);
+    virtual ~ProgramSink();
+
+    /**
+     * @brief write appends text to the program.
+     */
+    void write(const std::string & text) throw(std::runtime_error);
+    /**
+     * @brief write appends size bytes of data to the program.
+     */
+    void write(const char* data, std::size_t size) throw(std::runtime_error);
+    /**
+     * @brief flush writes the buffer to the device.
+     */
+    void flush() throw(std::runtime_error);
+
+    /**
+     * @brief getBytesWritten returns the number of bytes given to the sink, including the ones still at the buffer.
+     */
+    inline unsigned long long getBytesWritten() const {
+        return bytesWritten;
+    }
+
+protected:
+    QIODevice* device;
+    std::string buffer;
+    std::size_t bufferSize;
+    unsigned long long bytesWritten;
+};
+
+#endif // PROGRAMSINK_H
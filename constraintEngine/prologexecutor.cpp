@@ -1,6 +1,10 @@
 #include "prologexecutor.h"
 
+#include "prologtermbuilder.h"
+
 PlEngine* PrologExecutor::engine = NULL;
+std::map<std::string, PrologExecutor::LoadedProgram> PrologExecutor::loadedPrograms;
+std::mutex PrologExecutor::loadedProgramsMutex;
 
 void PrologExecutor::createEngine(const std::string & appName) {
     if (engine == NULL) {
@@ -10,6 +14,266 @@ void PrologExecutor::createEngine(const std::string & appName) {
         char* argv[] = {cstr};
         engine = new PlEngine(1, argv);
         delete[] cstr;
+
+        defineHelperPredicates();
+    }
+}
+
+void PrologExecutor::defineHelperPredicates() {
+    try {
+        PlCall("assertz(constraint_engine:("
+               "load_program(Module, Id, Text) :- "
+               "setup_call_cleanup(open_string(Text, Stream), load_files(Module:Id, [stream(Stream)]), close(Stream))))");
+        PlCall("assertz(constraint_engine:solve_batch(_, _, [], []))");
+        PlCall("assertz(constraint_engine:("
+               "solve_batch(Module, Name, [Args|ArgsList], [Found|FoundList]) :- "
+               "Goal =.. [Name|Args], "
+               "(Module:Goal -> Found = 1 ; Found = 0), "
+               "solve_batch(Module, Name, ArgsList, FoundList)))");
+        PlCall("assertz(constraint_engine:("
+               "post_restrictions(Module, Vars) :- "
+               "findall(Id, clause(Module:restriction(Id, _), _), Ids), "
+               "post_restrictions(Module, Ids, Vars)))");
+        PlCall("assertz(constraint_engine:post_restrictions(_, [], _))");
+        PlCall("assertz(constraint_engine:("
+               "post_restrictions(Module, [Id|Ids], Vars) :- "
+               "Module:restriction(Id, Vars), "
+               "post_restrictions(Module, Ids, Vars)))");
+
+        //budgeted queries, the clpfd operators are written in canonical form because they are not defined at the user module
+        PlCall("constraint_engine:use_module(library(time))");
+        PlCall("constraint_engine:use_module(library(clpfd))");
+        PlCall("assertz(constraint_engine:("
+               "budget_call(Goal, limits(Time, Inferences), Result) :- "
+               "catch(time_limited_call(Goal, Time, Inferences, Result0), time_limit_exceeded, Result0 = timeout), "
+               "Result = Result0))");
+        PlCall("assertz(constraint_engine:("
+               "time_limited_call(Goal, Time, Inferences, Result) :- "
+               "(Time > 0 -> call_with_time_limit(Time, inference_limited_call(Goal, Inferences, Result)) "
+               "; inference_limited_call(Goal, Inferences, Result))))");
+        PlCall("assertz(constraint_engine:("
+               "inference_limited_call(Goal, Inferences, Result) :- "
+               "(Inferences > 0 "
+               "-> (call_with_inference_limit(once(Goal), Inferences, Limited) "
+               "-> (Limited == inference_limit_exceeded -> Result = timeout ; Result = completed) "
+               "; Result = failed) "
+               "; (once(Goal) -> Result = completed ; Result = failed))))");
+        PlCall("assertz(constraint_engine:("
+               "solve_with_budget(Module, Name, Args, Limits, Status) :- "
+               "Goal =.. [Name|Args], "
+               "budget_call(Module:Goal, Limits, Result), "
+               "budget_status(Result, Status)))");
+        PlCall("assertz(constraint_engine:budget_status(completed, found))");
+        PlCall("assertz(constraint_engine:budget_status(failed, not_found))");
+        PlCall("assertz(constraint_engine:budget_status(timeout, timed_out))");
+
+        //anytime search: the restrictions are the body of the machine clause without its last goal, the labeling, and the
+        //minimization is replaced by a branch and bound that keeps the best labeling at a global variable of the thread. The search
+        //runs under double negation so the bounds it posts are undone before the arguments are unified with the best copy
+        PlCall("assertz(constraint_engine:("
+               "solve_anytime(Module, Name, Args, Pumps, Valves, Limits, Status) :- "
+               "Head =.. [Name|Args], "
+               "machine_restrictions(Module, Head, Restrictions), "
+               "nb_setval(constraint_engine_best, none), "
+               "budget_call(\\+ \\+ anytime_search(Module:Restrictions, Args, Pumps, Valves), Limits, Result), "
+               "nb_getval(constraint_engine_best, Best), "
+               "nb_setval(constraint_engine_best, none), "
+               "anytime_status(Result, Best, Args, Status)))");
+        PlCall("assertz(constraint_engine:("
+               "machine_restrictions(Module, Head, Restrictions) :- "
+               "clause(Module:Head, Body), "
+               "body_restrictions(Module, Body, Restrictions)))");
+        PlCall("assertz(constraint_engine:("
+               "body_restrictions(Module, constraint_engine:solve_components(_, Goals), Restrictions) :- !, "
+               "strip_module(Module:Goals, GoalsModule, PlainGoals), "
+               "components_restrictions(GoalsModule, PlainGoals, Restrictions)))");
+        PlCall("assertz(constraint_engine:(body_restrictions(_, Body, Restrictions) :- drop_last_goal(Body, Restrictions)))");
+        PlCall("assertz(constraint_engine:components_restrictions(_, [], true))");
+        PlCall("assertz(constraint_engine:("
+               "components_restrictions(Module, [Goal|Goals], (Restrictions, RestrictionsList)) :- "
+               "machine_restrictions(Module, Goal, Restrictions), "
+               "components_restrictions(Module, Goals, RestrictionsList)))");
+        PlCall("assertz(constraint_engine:(drop_last_goal((Goal, Rest), (Goal, Kept)) :- Rest = (_, _), !, drop_last_goal(Rest, Kept)))");
+        PlCall("assertz(constraint_engine:(drop_last_goal((Goal, _), Goal) :- !))");
+        PlCall("assertz(constraint_engine:drop_last_goal(_, true))");
+        PlCall("assertz(constraint_engine:("
+               "anytime_search(Restrictions, Args, Pumps, Valves) :- "
+               "call(Restrictions), "
+               "abs_sum(Pumps, PumpsCost), "
+               "min_sum(Valves, ValvesCost), "
+               "append(Pumps, Valves, Vars), "
+               "anytime_improve(Vars, Args, PumpsCost, ValvesCost)))");
+        PlCall("assertz(constraint_engine:("
+               "anytime_improve(Vars, Args, PumpsCost, ValvesCost) :- "
+               "(\\+ \\+ (labeling([ff], Vars), copy_term(Args, Copy, _), "
+               "nb_setval(constraint_engine_best, best(Copy, PumpsCost, ValvesCost))) "
+               "-> nb_getval(constraint_engine_best, best(_, BestPumps, BestValves)), "
+               "#\\/(#<(PumpsCost, BestPumps), #/\\(#=(PumpsCost, BestPumps), #<(ValvesCost, BestValves))), "
+               "anytime_improve(Vars, Args, PumpsCost, ValvesCost) "
+               "; true)))");
+        PlCall("assertz(constraint_engine:abs_sum([], 0))");
+        PlCall("assertz(constraint_engine:(abs_sum([X|Xs], Sum) :- abs_sum(Xs, Sum0), #=(Sum, Sum0 + abs(X))))");
+        PlCall("assertz(constraint_engine:min_sum([], 0))");
+        PlCall("assertz(constraint_engine:(min_sum([X|Xs], Sum) :- min_sum(Xs, Sum0), #=(Sum, Sum0 + min(X, 1))))");
+        PlCall("assertz(constraint_engine:anytime_status(completed, none, _, not_found))");
+        PlCall("assertz(constraint_engine:anytime_status(completed, best(Args, _, _), Args, found))");
+        PlCall("assertz(constraint_engine:anytime_status(failed, _, _, not_found))");
+        PlCall("assertz(constraint_engine:anytime_status(timeout, none, _, timed_out))");
+        PlCall("assertz(constraint_engine:anytime_status(timeout, best(Args, _, _), Args, best_found))");
+
+        //decomposed programs, the goals of the components are qualified with the module of the machine
+        PlCall("constraint_engine:use_module(library(thread))");
+        PlCall("constraint_engine:meta_predicate(solve_components(+, :))");
+        PlCall("assertz(constraint_engine:("
+               "solve_components(Threads, Module:Goals) :- "
+               "(Threads > 1 "
+               "-> maplist(qualify_goal(Module), Goals, QualifiedGoals), concurrent(Threads, QualifiedGoals, []) "
+               "; call_components(Module, Goals))))");
+        PlCall("assertz(constraint_engine:qualify_goal(Module, Goal, Module:Goal))");
+        PlCall("assertz(constraint_engine:call_components(_, []))");
+        PlCall("assertz(constraint_engine:(call_components(Module, [Goal|Goals]) :- Module:Goal, call_components(Module, Goals)))");
+        //specialized predicates, one clause for every combination of values of the grounded variables that survives the propagation.
+        //The head has the values of the grounded variables followed by the free variables and the body has the residual constraints
+        //of the free ones, with the domains already pruned for those values, followed by the labeling. The clauses are only created
+        //if the domains of the grounded variables allow at most MaxClauses combinations
+        PlCall("assertz(constraint_engine:("
+               "specialize(Module, Name, Arity, Positions, SpecializedName, MaxClauses) :- "
+               "functor(Head, Name, Arity), "
+               "machine_parts(Module, Head, Restrictions, Labeling), "
+               "Head =.. [_|Args], "
+               "split_args(Args, 0, Positions, Grounded, Free), "
+               "\\+ \\+ (call(Module:Restrictions), grounded_size(Grounded, 1, Size), Size =< MaxClauses), "
+               "Indicator = SpecializedName/Arity, "
+               "dynamic(Module:Indicator), "
+               "forall(specialized_clause(Module, Restrictions, Labeling, Grounded, Free, SpecializedName, Clause), "
+               "assertz(Module:Clause))))");
+        PlCall("assertz(constraint_engine:grounded_size([], Size, Size))");
+        PlCall("assertz(constraint_engine:("
+               "grounded_size([Var|Vars], Size0, Size) :- "
+               "fd_size(Var, VarSize), "
+               "integer(VarSize), "
+               "Size1 is Size0 * VarSize, "
+               "grounded_size(Vars, Size1, Size)))");
+        PlCall("assertz(constraint_engine:("
+               "specialized_clause(Module, Restrictions, Labeling, Grounded, Free, SpecializedName, "
+               "(SpecializedHead :- Residual, SpecializedLabeling)) :- "
+               "call(Module:Restrictions), "
+               "label(Grounded), "
+               "copy_term(Free-Labeling, SpecializedFree-SpecializedLabeling, Goals), "
+               "goals_conj(Goals, Residual), "
+               "append(Grounded, SpecializedFree, SpecializedArgs), "
+               "SpecializedHead =.. [SpecializedName|SpecializedArgs]))");
+        PlCall("assertz(constraint_engine:("
+               "machine_parts(Module, Head, Restrictions, Labeling) :- "
+               "clause(Module:Head, Body), "
+               "body_parts(Module, Body, Restrictions, Labeling)))");
+        PlCall("assertz(constraint_engine:("
+               "body_parts(Module, constraint_engine:solve_components(_, Goals), Restrictions, Labeling) :- !, "
+               "strip_module(Module:Goals, GoalsModule, PlainGoals), "
+               "components_parts(GoalsModule, PlainGoals, Restrictions, Labeling)))");
+        PlCall("assertz(constraint_engine:("
+               "body_parts(_, Body, Restrictions, Labeling) :- "
+               "drop_last_goal(Body, Restrictions), "
+               "last_goal(Body, Labeling)))");
+        PlCall("assertz(constraint_engine:components_parts(_, [], true, true))");
+        PlCall("assertz(constraint_engine:("
+               "components_parts(Module, [Goal|Goals], (Restrictions, RestrictionsList), (Labeling, LabelingList)) :- "
+               "machine_parts(Module, Goal, Restrictions, Labeling), "
+               "components_parts(Module, Goals, RestrictionsList, LabelingList)))");
+        PlCall("assertz(constraint_engine:(last_goal((_, Rest), Goal) :- !, last_goal(Rest, Goal)))");
+        PlCall("assertz(constraint_engine:last_goal(Goal, Goal))");
+        PlCall("assertz(constraint_engine:split_args([], _, _, [], []))");
+        PlCall("assertz(constraint_engine:("
+               "split_args([Arg|Args], I, Positions, Grounded, Free) :- "
+               "Next is I + 1, "
+               "(memberchk(I, Positions) -> Grounded = [Arg|Grounded1], Free = Free1 ; Grounded = Grounded1, Free = [Arg|Free1]), "
+               "split_args(Args, Next, Positions, Grounded1, Free1)))");
+        PlCall("assertz(constraint_engine:goals_conj([], true))");
+        PlCall("assertz(constraint_engine:(goals_conj([Goal], Goal) :- !))");
+        PlCall("assertz(constraint_engine:(goals_conj([Goal|Goals], (Goal, Conj)) :- goals_conj(Goals, Conj)))");
+        //warm start, the objectives of every labeling goal of the machine are bounded by their value at the previous solution if its
+        //labeled variables are still consistent with the restrictions, as the labeling would accept them. The bound is lexicographic
+        //over the min/1 options in the order of the labeling, so a weighted objective gets a single bound, a first feasible labeling
+        //gets none, and the variables grounded by the new query keep their new value
+        PlCall("assertz(constraint_engine:("
+               "solve_warm(Module, Name, Args, Previous) :- "
+               "Head =.. [Name|Args], "
+               "machine_parts(Module, Head, Restrictions, Labeling), "
+               "call(Module:Restrictions), "
+               "warm_bound(Labeling, Args, Previous), "
+               "call(Module:Labeling)))");
+        PlCall("assertz(constraint_engine:("
+               "warm_bound((Labeling, Labelings), Args, Previous) :- !, "
+               "warm_bound(Labeling, Args, Previous), "
+               "warm_bound(Labelings, Args, Previous)))");
+        PlCall("assertz(constraint_engine:("
+               "warm_bound(once(labeling(Options, Vars)), Args, Previous) :- !, "
+               "copy_term_nat(Args-Vars-Options, PreviousArgs-PreviousVars-PreviousOptions), "
+               "bind_previous(PreviousArgs, Previous), "
+               "(labeling_objectives(Options, Objectives), Objectives \\== [], "
+               "labeling_objectives(PreviousOptions, PreviousObjectives), "
+               "ground(PreviousVars), \\+ \\+ Vars = PreviousVars "
+               "-> objective_values(PreviousObjectives, Bounds), "
+               "lexicographic_bound(Objectives, Bounds, Bound), "
+               "call(Bound) "
+               "; true)))");
+        PlCall("assertz(constraint_engine:warm_bound(_, _, _))");
+        PlCall("assertz(constraint_engine:bind_previous([], []))");
+        PlCall("assertz(constraint_engine:("
+               "bind_previous([Arg|Args], [Value|Values]) :- "
+               "(var(Arg) -> Arg = Value ; true), "
+               "bind_previous(Args, Values)))");
+        //a max/1 option can not be bounded from above, so the labeling gets no bound
+        PlCall("assertz(constraint_engine:labeling_objectives([], []))");
+        PlCall("assertz(constraint_engine:(labeling_objectives([min(Expr)|Options], [Expr|Exprs]) :- !, labeling_objectives(Options, Exprs)))");
+        PlCall("assertz(constraint_engine:(labeling_objectives([max(_)|_], _) :- !, fail))");
+        PlCall("assertz(constraint_engine:(labeling_objectives([_|Options], Exprs) :- labeling_objectives(Options, Exprs)))");
+        PlCall("assertz(constraint_engine:objective_values([], []))");
+        PlCall("assertz(constraint_engine:(objective_values([Expr|Exprs], [Value|Values]) :- Value is Expr, objective_values(Exprs, Values)))");
+        PlCall("assertz(constraint_engine:(lexicographic_bound([Objective], [Bound], #=<(Objective, Bound)) :- !))");
+        PlCall("assertz(constraint_engine:("
+               "lexicographic_bound([Objective|Objectives], [Bound|Bounds], "
+               "#/\\(#=<(Objective, Bound), #\\/(#<(Objective, Bound), Rest))) :- "
+               "lexicographic_bound(Objectives, Bounds, Rest)))");
+
+        //labeling chosen by the query, the restrictions of the predicate are posted and its own labeling is replaced
+        PlCall("assertz(constraint_engine:("
+               "solve_labeling(Module, Name, Args, Labeling) :- "
+               "Head =.. [Name|Args], "
+               "machine_parts(Module, Head, Restrictions, _), "
+               "call(Module:Restrictions), "
+               "call(Module:Labeling)))");
+
+        //alternative routes, the labeling without its once/1 is backtracked into and every solution is kept at a global variable of
+        //the thread until there are enough, so the routes found survive a budget that cuts the search
+        PlCall("assertz(constraint_engine:("
+               "solve_alternatives(Module, Name, Args, Labeling, Max, Limits, Routes, Status) :- "
+               "Head =.. [Name|Args], "
+               "machine_parts(Module, Head, Restrictions, _), "
+               "nb_setval(constraint_engine_routes, routes(0, [])), "
+               "budget_call(alternatives_search(Module:Restrictions, Labeling, Args, Max), Limits, Result), "
+               "nb_getval(constraint_engine_routes, routes(_, Reversed)), "
+               "nb_setval(constraint_engine_routes, none), "
+               "reverse(Reversed, Routes), "
+               "alternatives_status(Result, Routes, Status)))");
+        PlCall("assertz(constraint_engine:("
+               "alternatives_search(Restrictions, once(Labeling), Args, Max) :- "
+               "call(Restrictions), "
+               "(call(Labeling), alternatives_record(Args, Max) -> true ; true)))");
+        PlCall("assertz(constraint_engine:("
+               "alternatives_record(Args, Max) :- "
+               "nb_getval(constraint_engine_routes, routes(Found0, Routes0)), "
+               "copy_term(Args, Copy, _), "
+               "Found is Found0 + 1, "
+               "nb_setval(constraint_engine_routes, routes(Found, [Copy|Routes0])), "
+               "Found >= Max))");
+        PlCall("assertz(constraint_engine:(alternatives_status(completed, [], not_found) :- !))");
+        PlCall("assertz(constraint_engine:alternatives_status(completed, _, found))");
+        PlCall("assertz(constraint_engine:alternatives_status(failed, _, not_found))");
+        PlCall("assertz(constraint_engine:(alternatives_status(timeout, [], timed_out) :- !))");
+        PlCall("assertz(constraint_engine:alternatives_status(timeout, _, best_found))");
+    } catch (PlException ex) {
+        throw(std::runtime_error("PrologExecutor::defineHelperPredicates(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
     }
 }
 
@@ -19,58 +283,933 @@ void PrologExecutor::destoryEngine() {
     }
 }
 
-PrologExecutor::PrologExecutor(std::unique_ptr<QTemporaryFile> temporaryFile, const std::set<std::string> & varTable) :
+PrologExecutor::PrologExecutor(std::unique_ptr<QTemporaryFile> temporaryFile, const VariableTable & varTable) :
     RoutingEngine()
 {
-    int i = 0;
-    for(std::string varName: varTable) {
-        this->varPositionTable.insert(std::make_pair(varName, i));
-        i++;
-    }
-
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    initVariables(varTable);
     this->file = std::move(temporaryFile);
+    this->fileName = file->fileName().toStdString();
+
+    QFile programFile(file->fileName());
+    if (programFile.open(QIODevice::ReadOnly)) {
+        this->programHash = QCryptographicHash::hash(programFile.readAll(), QCryptographicHash::Sha1).toHex().toStdString();
+        programFile.close();
+    }
 
     try {
-        std::string command = std::string("consult(\"" + file->fileName().toStdString() + "\").");
-        PlCall(command.c_str());
+        PlTermv av(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), PlAtom(fileName.c_str()))), PlCompound("[]"));
+        PlCall("load_files", av);
     } catch (PlException ex) {
         throw(std::runtime_error("PrologExecutor::PrologExecutor(). Exception at the Prolog constraints engine. Impossible to read temporaryFile, message: " + std::string((char*) ex)));
     }
+    stats->recordLoad(elapsedMs(start));
+}
+
+PrologExecutor::PrologExecutor(const std::string & program, const VariableTable & varTable) throw(std::runtime_error) :
+    RoutingEngine()
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    initVariables(varTable);
+
+    this->fileName = moduleName + "_program";
+
+    QByteArray programBytes(program.data(), (int) program.size());
+    this->programHash = QCryptographicHash::hash(programBytes, QCryptographicHash::Sha1).toHex().toStdString();
+
+    try {
+        PlTermv av(PlAtom(moduleName.c_str()), PlAtom(fileName.c_str()), PlString(program.c_str()));
+        PlCall("constraint_engine", "load_program", av);
+    } catch (PlException ex) {
+        throw(std::runtime_error("PrologExecutor::PrologExecutor(). Exception at the Prolog constraints engine. Impossible to load the program, message: " + std::string((char*) ex)));
+    }
+    stats->recordLoad(elapsedMs(start));
+}
+
+PrologExecutor::PrologExecutor(const ConstraintAst & ast,
+                               const std::vector<ConstraintAst::NodeId> & restrictions,
+                               const VariableTable & varTable)
+    throw(std::runtime_error) :
+    RoutingEngine()
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    initVariables(varTable);
+    this->programHash = ast.hash(restrictions);
+    //the builder uses the default labeling
+    this->programLabeling = LabelingStrategy().toString();
+
+    try {
+        PlFrame frame;
+        PlCall(moduleName.c_str(), "use_module", PlTermv(PlCompound("library(clpfd)")));
+
+        PrologTermBuilder builder(ast, variables.getNames());
+        PlTermv vars(variables.size());
+        PlTerm clause = builder.buildClause(PREDICATE_NAME, restrictions, vars);
+
+        PlCall("assertz", PlTermv(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), clause))));
+    } catch (PlException ex) {
+        throw(std::runtime_error("PrologExecutor::PrologExecutor(). Exception at the Prolog constraints engine. Impossible to assert the predicate, message: " + std::string((char*) ex)));
+    }
+    stats->recordLoad(elapsedMs(start));
+}
+
+PrologExecutor::PrologExecutor(const CompiledProgramCache & cache,
+                               const std::string & key,
+                               const std::string & program,
+                               const VariableTable & varTable)
+    throw(std::runtime_error) :
+    RoutingEngine()
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    initVariables(varTable);
+    this->programHash = key;
+    //the .qlf file keeps the path of its source, so the clauses are unloaded by the source path in both cases
+    this->fileName = cache.getSourcePath(key);
+
+    std::lock_guard<std::mutex> lock(loadedProgramsMutex);
+    auto loaded = loadedPrograms.find(fileName);
+    if (loaded != loadedPrograms.end()) {
+        moduleName = loaded->second.moduleName;
+        loaded->second.numExecutors++;
+        sharedProgram = true;
+        stats->recordLoad(elapsedMs(start));
+        return;
+    }
+
+    if (cache.contains(key)) {
+        std::string compiledPath = cache.getCompiledPath(key);
+        try {
+            PlTermv av(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), PlAtom(compiledPath.c_str()))), PlCompound("[]"));
+            PlCall("load_files", av);
+        } catch (PlException ex) {
+            //the destructor is not run, the clauses of a partial load are removed here
+            unloadFile();
+            throw(std::runtime_error("PrologExecutor::PrologExecutor(). Exception at the Prolog constraints engine. Impossible to load the compiled program, message: " + std::string((char*) ex)));
+        }
+    } else {
+        if (program.empty()) {
+            throw(std::runtime_error("PrologExecutor::PrologExecutor(). The key " + key + " is not at the cache and no program was given"));
+        }
+
+        QFile sourceFile(QString::fromStdString(fileName));
+        if (!sourceFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            throw(std::runtime_error("PrologExecutor::PrologExecutor(). Impossible to write the program at " + fileName));
+        }
+        sourceFile.write(program.data(), program.size());
+        sourceFile.close();
+
+        try {
+            PlCall("qcompile", PlTermv(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), PlAtom(fileName.c_str())))));
+        } catch (PlException ex) {
+            unloadFile();
+            throw(std::runtime_error("PrologExecutor::PrologExecutor(). Exception at the Prolog constraints engine. Impossible to compile the program, message: " + std::string((char*) ex)));
+        }
+    }
+
+    LoadedProgram loadedProgram;
+    loadedProgram.moduleName = moduleName;
+    loadedProgram.numExecutors = 1;
+    loadedPrograms.insert(std::make_pair(fileName, loadedProgram));
+    sharedProgram = true;
+    stats->recordLoad(elapsedMs(start));
 }
 
 PrologExecutor::~PrologExecutor() {
+    try {
+        //the specialized predicates are asserted, unloading the file does not remove them
+        for(const std::string & name: specializations->getNames()) {
+            PlTerm indicator = PlCompound("/", PlTermv(PlAtom(name.c_str()), PlTerm((long) variables.size())));
+            PlCall("abolish", PlTermv(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), indicator))));
+        }
+
+        if (sharedProgram) {
+            std::lock_guard<std::mutex> lock(loadedProgramsMutex);
+            auto loaded = loadedPrograms.find(fileName);
+            if (loaded != loadedPrograms.end() && --loaded->second.numExecutors == 0) {
+                loadedPrograms.erase(loaded);
+                PlCall("unload_file", PlTermv(PlAtom(fileName.c_str())));
+            }
+        } else if (!fileName.empty()) {
+            PlCall("unload_file", PlTermv(PlAtom(fileName.c_str())));
+        } else {
+            PlTerm indicator = PlCompound("/", PlTermv(PlAtom(PREDICATE_NAME), PlTerm((long) variables.size())));
+            PlCall("abolish", PlTermv(PlCompound(":", PlTermv(PlAtom(moduleName.c_str()), indicator))));
+        }
+    } catch (PlException ex) {
+        //the destructor must not throw, the clauses are left in the module
+    }
+}
+
+void PrologExecutor::initVariables(const VariableTable & varTable) {
+    static std::atomic<unsigned long> machineCounter(0);
+    this->moduleName = "machine_" + std::to_string(machineCounter++);
+
+    this->variables = varTable;
+    this->routeCache = std::unique_ptr<RouteCache>(new RouteCache(0));
+    this->stats = std::unique_ptr<ExecutorStats>(new ExecutorStats(moduleName));
+    //the name of the executor is part of the specialized predicates because several executors can share a module
+    this->specializations = std::unique_ptr<SpecializationTable>(
+                new SpecializationTable(0, 16, std::string(SPECIALIZED_PREDICATE_NAME) + "_" + moduleName + "_"));
+    this->sharedProgram = false;
+    this->warmStart = false;
+    this->warmStartMutex = std::unique_ptr<std::mutex>(new std::mutex());
 }
 
 bool PrologExecutor::calculateNewRoute(const std::unordered_map<std::string, long long> & inputStates, std::unordered_map<std::string, long long> & outStates)
     throw(std::runtime_error)
 {
+    std::vector<int> inputPositions;
+    std::vector<long long> inputValues;
+    resolveInputStates(inputStates, inputPositions, inputValues);
+
+    std::vector<long long> states;
+    if (calculateNewRouteIndexed(inputPositions, inputValues, states)) {
+        fillOutStates(states, outStates);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+bool PrologExecutor::calculateNewRouteIndexed(const std::vector<int> & inputPositions,
+                                              const std::vector<long long> & inputValues,
+                                              std::vector<long long> & outStates)
+    throw(std::runtime_error)
+{
+    if (inputPositions.size() != inputValues.size()) {
+        throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexed(). inputPositions and inputValues have different sizes"));
+    }
+    for(int pos: inputPositions) {
+        if (pos < 0 || pos >= variables.size()) {
+            throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexed(). Position out of range " + std::to_string(pos)));
+        }
+    }
+
+    bool found;
+    if (routeCache->lookup(inputPositions, inputValues, found, outStates)) {
+        stats->recordCached();
+        if (found) {
+            storePreviousSolution(outStates);
+        }
+        return found;
+    }
+
+    std::vector<long long> previous;
+    bool useWarmStart = readPreviousSolution(previous);
+
+    //the query that reaches the threshold creates the specialized predicate, it is used from the next one on
+    std::vector<int> signature;
+    std::string specializedName;
+    std::vector<int> argIndex;
+    SpecializationTable::LookupResult lookup = SpecializationTable::not_specialized;
+    if (!useWarmStart) {
+        lookup = specializations->lookup(inputPositions, signature, specializedName, argIndex);
+        if (lookup == SpecializationTable::must_specialize) {
+            specialize(signature, specializedName);
+        }
+    }
+    bool useSpecialized = (lookup == SpecializationTable::specialized);
+
+    ExecutorStats::QueryRecord record = ExecutorStats::QueryRecord();
+    record.numQueries = 1;
+    bool profiling = stats->isProfiling();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    try {
+        PlFrame frame;
+        int numVars = variables.size();
+        PlTermv av(numVars);
+
+        if (useSpecialized) {
+            for(std::size_t i = 0; i < inputPositions.size(); i++) {
+                av[argIndex[inputPositions[i]]] = (long) inputValues[i];
+            }
+        } else {
+            setInputStates(inputPositions, inputValues, av, 0);
+        }
+        const char* queryModule = moduleName.c_str();
+        const char* queryPredicate = useSpecialized ? specializedName.c_str() : PREDICATE_NAME;
+        PlTermv warmAv(4);
+        if (useWarmStart) {
+            std::vector<int> allPositions(numVars);
+            for(int pos = 0; pos < numVars; pos++) {
+                allPositions[pos] = pos;
+            }
+            PL_put_atom_chars(warmAv[0].ref, moduleName.c_str());
+            PL_put_atom_chars(warmAv[1].ref, PREDICATE_NAME);
+            PL_put_term(warmAv[2].ref, makeList(av, allPositions).ref);
+            PL_put_term(warmAv[3].ref, makeValueList(previous, allPositions).ref);
+            queryModule = "constraint_engine";
+            queryPredicate = "solve_warm";
+        }
+        long long inferences = profiling ? readStatistic("inferences") : 0;
+        record.setupMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        PlQuery q(queryModule, queryPredicate, useWarmStart ? warmAv : av);
+
+        found = q.next_solution();
+        record.solveMs = elapsedMs(start);
+        if (profiling) {
+            //read before the query is closed, so the stacks still hold the choicepoints of the search
+            record.inferences = readStatistic("inferences") - inferences;
+            record.globalUsed = readStatistic("globalused");
+            record.trailUsed = readStatistic("trailused");
+            record.localUsed = readStatistic("localused");
+        }
+
+        start = std::chrono::steady_clock::now();
+        if (found && useSpecialized) {
+            outStates.resize(numVars);
+            for(int pos = 0; pos < numVars; pos++) {
+                outStates[pos] = (long) av[argIndex[pos]];
+            }
+        } else if (found) {
+            readOutStates(av, 0, outStates);
+        }
+        record.numFound = found ? 1 : 0;
+        record.readoutMs = elapsedMs(start);
+    } catch (PlException ex) {
+        record.exception = true;
+        stats->recordQuery(record);
+        throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexed(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+    }
+    stats->recordQuery(record);
+
+    routeCache->insert(inputPositions, inputValues, found, outStates);
+    if (found) {
+        storePreviousSolution(outStates);
+    }
+    return found;
+}
+
+PrologExecutor::RouteStatus PrologExecutor::calculateNewRouteWithBudget(const std::unordered_map<std::string, long long> & inputStates,
+                                                                      std::unordered_map<std::string, long long> & outStates,
+                                                                      const QueryBudget & budget)
+    throw(std::runtime_error)
+{
+    std::vector<int> inputPositions;
+    std::vector<long long> inputValues;
+    resolveInputStates(inputStates, inputPositions, inputValues);
+
+    std::vector<long long> states;
+    RouteStatus status = calculateNewRouteIndexedWithBudget(inputPositions, inputValues, states, budget);
+    if (status == route_found || status == route_best_found) {
+        fillOutStates(states, outStates);
+    }
+    return status;
+}
+
+PrologExecutor::RouteStatus PrologExecutor::calculateNewRouteIndexedWithBudget(const std::vector<int> & inputPositions,
+                                                                             const std::vector<long long> & inputValues,
+                                                                             std::vector<long long> & outStates,
+                                                                             const QueryBudget & budget)
+    throw(std::runtime_error)
+{
+    if (inputPositions.size() != inputValues.size()) {
+        throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexedWithBudget(). inputPositions and inputValues have different sizes"));
+    }
+    for(int pos: inputPositions) {
+        if (pos < 0 || pos >= variables.size()) {
+            throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexedWithBudget(). Position out of range " + std::to_string(pos)));
+        }
+    }
+
+    bool found;
+    if (routeCache->lookup(inputPositions, inputValues, found, outStates)) {
+        stats->recordCached();
+        if (found) {
+            storePreviousSolution(outStates);
+        }
+        return found ? route_found : route_not_found;
+    }
+
+    RouteStatus status;
+    ExecutorStats::QueryRecord record = ExecutorStats::QueryRecord();
+    record.numQueries = 1;
+    bool profiling = stats->isProfiling();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     try {
         PlFrame frame;
-        PlTermv av(varPositionTable.size());
+        int numVars = variables.size();
+        PlTermv av(numVars);
+        setInputStates(inputPositions, inputValues, av, 0);
+
+        std::vector<int> allPositions(numVars);
+        for(int pos = 0; pos < numVars; pos++) {
+            allPositions[pos] = pos;
+        }
+        PlTerm limits = makeLimits(budget);
+        PlTerm statusTerm;
 
-        for(auto statePair: inputStates) {
-            std::string varName = statePair.first;
-            int value = statePair.second;
+        bool called;
+        long long inferences = profiling ? readStatistic("inferences") : 0;
+        if (budget.returnBest) {
+            PlTermv anytimeAv(7);
+            PL_put_atom_chars(anytimeAv[0].ref, moduleName.c_str());
+            PL_put_atom_chars(anytimeAv[1].ref, PREDICATE_NAME);
+            PL_put_term(anytimeAv[2].ref, makeList(av, allPositions).ref);
+            PL_put_term(anytimeAv[3].ref, makeList(av, variables.getIds(VariableNominator::pump)).ref);
+            PL_put_term(anytimeAv[4].ref, makeList(av, variables.getIds(VariableNominator::valve)).ref);
+            PL_put_term(anytimeAv[5].ref, limits.ref);
+            PL_put_term(anytimeAv[6].ref, statusTerm.ref);
+            record.setupMs = elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            called = PlCall("constraint_engine", "solve_anytime", anytimeAv);
+        } else {
+            PlTermv budgetAv(PlAtom(moduleName.c_str()), PlAtom(PREDICATE_NAME), makeList(av, allPositions), limits, statusTerm);
+            record.setupMs = elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            called = PlCall("constraint_engine", "solve_with_budget", budgetAv);
+        }
+        record.solveMs = elapsedMs(start);
+        if (!called) {
+            throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexedWithBudget(). The predicate " + std::string(PREDICATE_NAME) +
+                                     " is not defined at module " + moduleName));
+        }
+        if (profiling) {
+            record.inferences = readStatistic("inferences") - inferences;
+            record.globalUsed = readStatistic("globalused");
+            record.trailUsed = readStatistic("trailused");
+            record.localUsed = readStatistic("localused");
+        }
+
+        start = std::chrono::steady_clock::now();
+        std::string statusName((char*) statusTerm);
+        if (statusName == "found") {
+            status = route_found;
+        } else if (statusName == "best_found") {
+            status = route_best_found;
+        } else if (statusName == "timed_out") {
+            status = route_timed_out;
+        } else {
+            status = route_not_found;
+        }
 
-            int varPos = varPositionTable[varName];
-            av[varPos] = value;
+        if (status == route_found || status == route_best_found) {
+            readOutStates(av, 0, outStates);
         }
+        record.numFound = (status == route_found) ? 1 : 0;
+        record.numTimedOut = (status == route_timed_out || status == route_best_found) ? 1 : 0;
+        record.readoutMs = elapsedMs(start);
+    } catch (PlException ex) {
+        record.exception = true;
+        stats->recordQuery(record);
+        throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexedWithBudget(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+    }
+    stats->recordQuery(record);
+
+    //a search cut by the budget says nothing about the route, only the finished ones are cached
+    if (status == route_found || status == route_not_found) {
+        routeCache->insert(inputPositions, inputValues, status == route_found, outStates);
+    }
+    //the best route found so far satisfies the restrictions, so it is also a valid bound for the next query
+    if (status == route_found || status == route_best_found) {
+        storePreviousSolution(outStates);
+    }
+    return status;
+}
+
+bool PrologExecutor::calculateNewRouteWithStrategy(const std::unordered_map<std::string, long long> & inputStates,
+                                                   std::unordered_map<std::string, long long> & outStates,
+                                                   const LabelingStrategy & strategy)
+    throw(std::runtime_error)
+{
+    std::vector<int> inputPositions;
+    std::vector<long long> inputValues;
+    resolveInputStates(inputStates, inputPositions, inputValues);
 
-        PlQuery q("stackAutoPredicate", av);
+    std::vector<long long> states;
+    if (calculateNewRouteIndexedWithStrategy(inputPositions, inputValues, states, strategy)) {
+        fillOutStates(states, outStates);
+        return true;
+    } else {
+        return false;
+    }
+}
 
-        if (q.next_solution()) {
-            for(auto pair: varPositionTable) {
-                const std::string & name = pair.first;
-                int pos = pair.second;
-                int value = (int) av[pos];
+bool PrologExecutor::calculateNewRouteIndexedWithStrategy(const std::vector<int> & inputPositions,
+                                                          const std::vector<long long> & inputValues,
+                                                          std::vector<long long> & outStates,
+                                                          const LabelingStrategy & strategy)
+    throw(std::runtime_error)
+{
+    if (inputPositions.size() != inputValues.size()) {
+        throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexedWithStrategy(). inputPositions and inputValues have different sizes"));
+    }
+    for(int pos: inputPositions) {
+        if (pos < 0 || pos >= variables.size()) {
+            throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexedWithStrategy(). Position out of range " + std::to_string(pos)));
+        }
+    }
 
-                outStates[name] = value;
+    bool found;
+    ExecutorStats::QueryRecord record = ExecutorStats::QueryRecord();
+    record.numQueries = 1;
+    bool profiling = stats->isProfiling();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    try {
+        PlFrame frame;
+        int numVars = variables.size();
+        PlTermv av(numVars);
+        setInputStates(inputPositions, inputValues, av, 0);
+
+        std::vector<int> allPositions(numVars);
+        for(int pos = 0; pos < numVars; pos++) {
+            allPositions[pos] = pos;
+        }
+        PlTermv labelingAv(PlAtom(moduleName.c_str()), PlAtom(PREDICATE_NAME), makeList(av, allPositions), strategy.buildLabeling(variables, av));
+        long long inferences = profiling ? readStatistic("inferences") : 0;
+        record.setupMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        PlQuery q("constraint_engine", "solve_labeling", labelingAv);
+
+        found = q.next_solution();
+        record.solveMs = elapsedMs(start);
+        if (profiling) {
+            record.inferences = readStatistic("inferences") - inferences;
+            record.globalUsed = readStatistic("globalused");
+            record.trailUsed = readStatistic("trailused");
+            record.localUsed = readStatistic("localused");
+        }
+
+        start = std::chrono::steady_clock::now();
+        if (found) {
+            readOutStates(av, 0, outStates);
+        }
+        record.numFound = found ? 1 : 0;
+        record.readoutMs = elapsedMs(start);
+    } catch (PlException ex) {
+        record.exception = true;
+        stats->recordQuery(record);
+        throw(std::runtime_error("PrologExecutor::calculateNewRouteIndexedWithStrategy(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+    }
+    stats->recordQuery(record);
+    return found;
+}
+
+PrologExecutor::RouteStatus PrologExecutor::calculateAlternativeRoutes(const std::unordered_map<std::string, long long> & inputStates,
+                                                                     std::size_t maxRoutes,
+                                                                     std::vector<std::unordered_map<std::string, long long>> & routes,
+                                                                     const QueryBudget & budget,
+                                                                     const LabelingStrategy & strategy)
+    throw(std::runtime_error)
+{
+    std::vector<int> inputPositions;
+    std::vector<long long> inputValues;
+    resolveInputStates(inputStates, inputPositions, inputValues);
+
+    std::vector<std::vector<long long>> states;
+    RouteStatus status = calculateAlternativeRoutesIndexed(inputPositions, inputValues, maxRoutes, states, budget, strategy);
+    routes.assign(states.size(), std::unordered_map<std::string, long long>());
+    for(std::size_t i = 0; i < states.size(); i++) {
+        fillOutStates(states[i], routes[i]);
+    }
+    return status;
+}
+
+PrologExecutor::RouteStatus PrologExecutor::calculateAlternativeRoutesIndexed(const std::vector<int> & inputPositions,
+                                                                            const std::vector<long long> & inputValues,
+                                                                            std::size_t maxRoutes,
+                                                                            std::vector<std::vector<long long>> & routes,
+                                                                            const QueryBudget & budget,
+                                                                            const LabelingStrategy & strategy)
+    throw(std::runtime_error)
+{
+    if (inputPositions.size() != inputValues.size()) {
+        throw(std::runtime_error("PrologExecutor::calculateAlternativeRoutesIndexed(). inputPositions and inputValues have different sizes"));
+    }
+    if (maxRoutes == 0) {
+        throw(std::runtime_error("PrologExecutor::calculateAlternativeRoutesIndexed(). maxRoutes must be at least 1"));
+    }
+    for(int pos: inputPositions) {
+        if (pos < 0 || pos >= variables.size()) {
+            throw(std::runtime_error("PrologExecutor::calculateAlternativeRoutesIndexed(). Position out of range " + std::to_string(pos)));
+        }
+    }
+
+    routes.clear();
+    RouteStatus status;
+    ExecutorStats::QueryRecord record = ExecutorStats::QueryRecord();
+    record.numQueries = 1;
+    bool profiling = stats->isProfiling();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    try {
+        PlFrame frame;
+        int numVars = variables.size();
+        PlTermv av(numVars);
+        setInputStates(inputPositions, inputValues, av, 0);
+
+        std::vector<int> allPositions(numVars);
+        for(int pos = 0; pos < numVars; pos++) {
+            allPositions[pos] = pos;
+        }
+        PlTerm routesTerm;
+        PlTerm statusTerm;
+        PlTermv alternativesAv(8);
+        PL_put_atom_chars(alternativesAv[0].ref, moduleName.c_str());
+        PL_put_atom_chars(alternativesAv[1].ref, PREDICATE_NAME);
+        PL_put_term(alternativesAv[2].ref, makeList(av, allPositions).ref);
+        PL_put_term(alternativesAv[3].ref, strategy.buildLabeling(variables, av).ref);
+        PL_put_term(alternativesAv[4].ref, PlTerm((long) maxRoutes).ref);
+        PL_put_term(alternativesAv[5].ref, makeLimits(budget).ref);
+        PL_put_term(alternativesAv[6].ref, routesTerm.ref);
+        PL_put_term(alternativesAv[7].ref, statusTerm.ref);
+        long long inferences = profiling ? readStatistic("inferences") : 0;
+        record.setupMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        bool called = PlCall("constraint_engine", "solve_alternatives", alternativesAv);
+        record.solveMs = elapsedMs(start);
+        if (!called) {
+            throw(std::runtime_error("PrologExecutor::calculateAlternativeRoutesIndexed(). The predicate " + std::string(PREDICATE_NAME) +
+                                     " is not defined at module " + moduleName));
+        }
+        if (profiling) {
+            record.inferences = readStatistic("inferences") - inferences;
+            record.globalUsed = readStatistic("globalused");
+            record.trailUsed = readStatistic("trailused");
+            record.localUsed = readStatistic("localused");
+        }
+
+        start = std::chrono::steady_clock::now();
+        std::string statusName((char*) statusTerm);
+        if (statusName == "found") {
+            status = route_found;
+        } else if (statusName == "best_found") {
+            status = route_best_found;
+        } else if (statusName == "timed_out") {
+            status = route_timed_out;
+        } else {
+            status = route_not_found;
+        }
+
+        PlTail routesTail(routesTerm);
+        PlTerm route;
+        while (routesTail.next(route)) {
+            std::vector<long long> states;
+            states.reserve(numVars);
+            PlTail valuesTail(route);
+            PlTerm value;
+            while (valuesTail.next(value)) {
+                states.push_back((long) value);
+            }
+            routes.push_back(std::move(states));
+        }
+        record.numFound = (status == route_found) ? 1 : 0;
+        record.numTimedOut = (status == route_timed_out || status == route_best_found) ? 1 : 0;
+        record.readoutMs = elapsedMs(start);
+    } catch (PlException ex) {
+        record.exception = true;
+        stats->recordQuery(record);
+        throw(std::runtime_error("PrologExecutor::calculateAlternativeRoutesIndexed(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+    }
+    stats->recordQuery(record);
+    return status;
+}
+
+int PrologExecutor::getVarPosition(const std::string & name) const {
+    return variables.find(name);
+}
+
+std::vector<bool> PrologExecutor::calculateNewRoutes(const std::vector<std::unordered_map<std::string, long long>> & inputStatesBatch,
+                                                     std::vector<std::unordered_map<std::string, long long>> & outStatesBatch)
+    throw(std::runtime_error)
+{
+    std::vector<bool> found(inputStatesBatch.size(), false);
+    outStatesBatch.resize(inputStatesBatch.size());
+
+    //names are resolved before entering the interpreter, queries already at the cache are not sent to it
+    std::vector<std::vector<int>> inputPositions(inputStatesBatch.size());
+    std::vector<std::vector<long long>> inputValues(inputStatesBatch.size());
+    std::vector<int> pending;
+    for(int i = 0; i < (int) inputStatesBatch.size(); i++) {
+        resolveInputStates(inputStatesBatch[i], inputPositions[i], inputValues[i]);
+
+        bool cachedFound;
+        std::vector<long long> states;
+        if (routeCache->lookup(inputPositions[i], inputValues[i], cachedFound, states)) {
+            stats->recordCached();
+            found[i] = cachedFound;
+            if (cachedFound) {
+                fillOutStates(states, outStatesBatch[i]);
             }
-            return true;
         } else {
-            return false;
+            pending.push_back(i);
+        }
+    }
+
+    if (pending.empty()) {
+        return found;
+    }
+
+    ExecutorStats::QueryRecord record = ExecutorStats::QueryRecord();
+    record.numQueries = (unsigned int) pending.size();
+    bool profiling = stats->isProfiling();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    try {
+        PlFrame frame;
+        int numVars = variables.size();
+        //one term vector for the whole batch, the arguments of the pending query j start at j * numVars
+        PlTermv av(numVars * (int) pending.size());
+
+        PlTerm argsList;
+        PlTail argsTail(argsList);
+        for(int j = 0; j < (int) pending.size(); j++) {
+            int offset = j * numVars;
+            setInputStates(inputPositions[pending[j]], inputValues[pending[j]], av, offset);
+
+            PlTerm args;
+            PlTail argsRow(args);
+            for(int pos = 0; pos < numVars; pos++) {
+                argsRow.append(av[offset + pos]);
+            }
+            argsRow.close();
+            argsTail.append(args);
+        }
+        argsTail.close();
+
+        PlTerm foundList;
+        PlTermv batchAv(PlAtom(moduleName.c_str()), PlAtom(PREDICATE_NAME), argsList, foundList);
+        long long inferences = profiling ? readStatistic("inferences") : 0;
+        record.setupMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        bool solved = PlCall("constraint_engine", "solve_batch", batchAv);
+        record.solveMs = elapsedMs(start);
+        if (profiling) {
+            record.inferences = readStatistic("inferences") - inferences;
+            record.globalUsed = readStatistic("globalused");
+            record.trailUsed = readStatistic("trailused");
+            record.localUsed = readStatistic("localused");
+        }
+
+        start = std::chrono::steady_clock::now();
+        if (solved) {
+            PlTail foundTail(foundList);
+            PlTerm foundTerm;
+            std::vector<long long> states;
+            for(int j = 0; foundTail.next(foundTerm); j++) {
+                int i = pending[j];
+                found[i] = ((int) foundTerm == 1);
+                if (found[i]) {
+                    readOutStates(av, j * numVars, states);
+                    fillOutStates(states, outStatesBatch[i]);
+                    record.numFound++;
+                }
+                routeCache->insert(inputPositions[i], inputValues[i], found[i], states);
+            }
         }
+        record.readoutMs = elapsedMs(start);
     } catch (PlException ex) {
-        throw(std::runtime_error("PrologExecutor::calculateNewRoute(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+        record.exception = true;
+        stats->recordQuery(record);
+        throw(std::runtime_error("PrologExecutor::calculateNewRoutes(). Exception at the Prolog constraints engine, message: " + std::string((char*) ex)));
+    }
+    stats->recordQuery(record);
+    return found;
+}
+
+void PrologExecutor::setRouteCacheCapacity(std::size_t capacity) {
+    routeCache->setCapacity(capacity);
+}
+
+RouteCache::Stats PrologExecutor::getRouteCacheStats() const {
+    return routeCache->getStats();
+}
+
+void PrologExecutor::clearRouteCache() {
+    routeCache->clear();
+}
+
+bool PrologExecutor::saveRouteCache(const std::string & path) const {
+    return routeCache->saveToFile(path, getMachineHash());
+}
+
+bool PrologExecutor::loadRouteCache(const std::string & path) {
+    return routeCache->loadFromFile(path, getMachineHash());
+}
+
+std::string PrologExecutor::getMachineHash() const {
+    QCryptographicHash hashFunction(QCryptographicHash::Sha1);
+    hashFunction.addData(programHash.c_str(), (int) programHash.size() + 1);
+    for(const std::string & name: variables.getNames()) {
+        hashFunction.addData(name.c_str(), (int) name.size() + 1);
+    }
+    hashFunction.addData(programLabeling.c_str(), (int) programLabeling.size() + 1);
+    return hashFunction.result().toHex().toStdString();
+}
+
+void PrologExecutor::setSpecialization(unsigned int threshold, std::size_t maxSpecializations) {
+    specializations->setThreshold(threshold, maxSpecializations);
+}
+
+std::size_t PrologExecutor::getNumSpecializations() const {
+    return specializations->getNumSpecializations();
+}
+
+void PrologExecutor::setWarmStart(bool enabled) {
+    std::lock_guard<std::mutex> lock(*warmStartMutex);
+    this->warmStart = enabled;
+    if (!enabled) {
+        previousStates.clear();
+    }
+}
+
+void PrologExecutor::clearWarmStart() {
+    std::lock_guard<std::mutex> lock(*warmStartMutex);
+    previousStates.clear();
+}
+
+ExecutorStats::Stats PrologExecutor::getStats() const {
+    return stats->getStats();
+}
+
+void PrologExecutor::resetStats() {
+    stats->reset();
+}
+
+void PrologExecutor::setProfiling(bool enabled) {
+    stats->setProfiling(enabled);
+}
+
+void PrologExecutor::setTraceLog(std::ostream* log, unsigned int sampleEvery) {
+    stats->setTraceLog(log, sampleEvery);
+}
+
+long long PrologExecutor::readStatistic(const char* key) {
+    PlTerm value;
+    PlTermv av(PlAtom(key), value);
+    PlCall("statistics", av);
+
+    //long is 32 bits at windows, the inferences of a long running engine do not fit
+    int64_t number = 0;
+    PL_get_int64(av[1].ref, &number);
+    return (long long) number;
+}
+
+void PrologExecutor::unloadFile() {
+    try {
+        PlCall("unload_file", PlTermv(PlAtom(fileName.c_str())));
+    } catch (PlException ex) {
+        //nothing was loaded
+    }
+}
+
+PlTerm PrologExecutor::makeLimits(const QueryBudget & budget) {
+    //PlTerm(long) would truncate limits of 2^31 or more at windows, and a negative limit means no limit
+    PlTerm inferences;
+    PL_put_int64(inferences.ref, (int64_t) budget.inferenceLimit);
+    return PlCompound("limits", PlTermv(PlTerm(budget.timeLimit), inferences));
+}
+
+double PrologExecutor::elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool PrologExecutor::readPreviousSolution(std::vector<long long> & states) const {
+    std::lock_guard<std::mutex> lock(*warmStartMutex);
+    if (!warmStart || previousStates.empty()) {
+        return false;
+    }
+    states = previousStates;
+    return true;
+}
+
+void PrologExecutor::storePreviousSolution(const std::vector<long long> & states) {
+    std::lock_guard<std::mutex> lock(*warmStartMutex);
+    if (warmStart) {
+        previousStates = states;
+    }
+}
+
+void PrologExecutor::specialize(const std::vector<int> & signature, const std::string & name) {
+    try {
+        PlFrame frame;
+        PlTerm positions;
+        PlTail tail(positions);
+        for(int pos: signature) {
+            tail.append(PlTerm((long) pos));
+        }
+        tail.close();
+
+        PlTermv av(6);
+        av[0] = PlAtom(moduleName.c_str());
+        av[1] = PlAtom(PREDICATE_NAME);
+        av[2] = (long) variables.size();
+        av[3] = positions;
+        av[4] = PlAtom(name.c_str());
+        av[5] = (long) MAX_SPECIALIZED_CLAUSES;
+        if (PlCall("constraint_engine", "specialize", av)) {
+            specializations->setCreated(signature, variables.size());
+            return;
+        }
+    } catch (PlException ex) {
+        //the queries with this signature keep calling the original predicate
+    }
+    specializations->setFailed(signature);
+}
+
+void PrologExecutor::resolveInputStates(const std::unordered_map<std::string, long long> & inputStates,
+                                        std::vector<int> & inputPositions,
+                                        std::vector<long long> & inputValues) const
+    throw(std::runtime_error)
+{
+    inputPositions.reserve(inputStates.size());
+    inputValues.reserve(inputStates.size());
+    for(const auto & statePair: inputStates) {
+        const std::string & varName = statePair.first;
+
+        int pos = variables.find(varName);
+        if (pos < 0) {
+            throw(std::runtime_error("PrologExecutor::calculateNewRoute(). Unknown variable " + varName));
+        }
+        inputPositions.push_back(pos);
+        inputValues.push_back(statePair.second);
+    }
+}
+
+void PrologExecutor::setInputStates(const std::vector<int> & inputPositions,
+                                    const std::vector<long long> & inputValues,
+                                    const PlTermv & av,
+                                    int offset) const
+{
+    for(std::size_t i = 0; i < inputPositions.size(); i++) {
+        av[offset + inputPositions[i]] = (long) inputValues[i];
+    }
+}
+
+void PrologExecutor::readOutStates(const PlTermv & av, int offset, std::vector<long long> & outStates) const {
+    outStates.resize(variables.size());
+    for(int pos = 0; pos < variables.size(); pos++) {
+        outStates[pos] = (long) av[offset + pos];
+    }
+}
+
+PlTerm PrologExecutor::makeList(const PlTermv & av, VariableTable::IdRange positions) const {
+    PlTerm list;
+    PlTail tail(list);
+    for(int pos: positions) {
+        tail.append(av[pos]);
+    }
+    tail.close();
+    return list;
+}
+
+PlTerm PrologExecutor::makeValueList(const std::vector<long long> & states, VariableTable::IdRange positions) const {
+    PlTerm list;
+    PlTail tail(list);
+    for(int pos: positions) {
+        tail.append(PlTerm((long) states[pos]));
+    }
+    tail.close();
+    return list;
+}
+
+void PrologExecutor::fillOutStates(const std::vector<long long> & states, std::unordered_map<std::string, long long> & outStates) const {
+    for(int pos = 0; pos < variables.size(); pos++) {
+        outStates[variables.getName(pos)] = states[pos];
     }
 }
@@ -1,17 +1,58 @@
 #ifndef PROLOGEXECUTOR_H
 #define PROLOGEXECUTOR_H
 
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
+#include <QCryptographicHash>
+#include <QFile>
 #include <QTemporaryFile>
 
+/**
+ * @brief PREDICATE_NAME name of the predicate generated for each machine, it is defined in the module of its PrologExecutor.
+ */
+#define PREDICATE_NAME "stackAutoPredicate"
+/**
+ * @brief COMPONENT_PREDICATE_NAME prefix of the predicates of the independent components of a decomposed program, followed by the
+ * number of the component.
+ */
+#define COMPONENT_PREDICATE_NAME "stackAutoComponent"
+/**
+ * @brief SPECIALIZED_PREDICATE_NAME prefix of the predicates specialized for a grounding signature, followed by the name of the executor
+ * and a number.
+ */
+#define SPECIALIZED_PREDICATE_NAME "stackAutoSpecialized"
+/**
+ * @brief MAX_SPECIALIZED_CLAUSES maximum number of combinations of values of the grounded variables of a specialized predicate, the
+ * signatures with more combinations are not specialized.
+ */
+#define MAX_SPECIALIZED_CLAUSES 1024
+/**
+ * @brief RESTRICTION_PREDICATE_NAME prefix of the predicates of the restrictions of a streamed program, followed by the number of the
+ * restriction.
+ */
+#define RESTRICTION_PREDICATE_NAME "stackAutoRestriction"
+
 #define PL_SAFE_ARG_MACROS //define this flag so SWI-cpp macros dont colide with boost one
 #include <SWI-cpp.h>
 
 #include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+#include <fluidicmachinemodel/machine_graph_utils/variablenominator.h>
+
+#include "constraintengine/compiledprogramcache.h"
+#include "constraintengine/constraintast.h"
+#include "constraintengine/executorstats.h"
+#include "constraintengine/labelingstrategy.h"
+#include "constraintengine/routecache.h"
+#include "constraintengine/specializationtable.h"
+#include "constraintengine/variabletable.h"
 
 #include "constraintengine/constraintsenginelibrary_global.h"
 
@@ -23,18 +64,68 @@
  * a constraints problems: once a set of flows are sets on a machine an state for each: valve, pump, container and tube is calculated
  * so all the flows are mantain.
  *
- * In order to do so, creates a temporary file with a prolog predicate that contains variables representing each: valve, pump, tube and
- * container of a machine and loads this file in the SWI-prolog interprete. Each time a new set flows need to be processed, the predicate
- * of the temporary file is invoqued with the value of the variables that the flows sets, thepredicate returns the value of the rests of
+ * In order to do so, loads a prolog program with a predicate that contains variables representing each: valve, pump, tube and
+ * container of a machine in the SWI-prolog interprete, either from memory or from a temporary file. Each time a new set flows need
+ * to be processed, the predicate is invoqued with the value of the variables that the flows sets, thepredicate returns the value of the rests of
  * components of the system so the flows are mantained using the minimal number of pumps and valves.
  *
+ * Each PrologExecutor loads its program into its own module, with an unique name, so several machines can be loaded at the same
+ * time without redefining the predicate of each other. The program is unloaded when the PrologExecutor is destroyed.
+ *
+ * A query can be given a QueryBudget, a wall time and an inference limit, so a search that takes too long is cancelled and reported
+ * as timed out instead of blocking the caller, optionally returning the best state found before the cancellation.
+ *
+ * The queries that ground the same set of variables over and over can be served by a predicate specialized for that set, see
+ * setSpecialization(). Consecutive queries that differ in a few flows can be seeded with the previous solution, see setWarmStart().
+ *
  * @sa RoutingEngine.
  */
 class PROLOGEXECUTOR_EXPORT PrologExecutor : public RoutingEngine
 {
 public:
     /**
-     * @brief createEngine this methdod only needs to be invoqued once in a program execution, starts the swi-prolog interpreter.
+     * @brief The RouteStatus enum result of a query with a budget.
+     */
+    typedef enum RouteStatus_ {
+        /**
+         * @brief route_found the search finished and the state with the minimal number of pumps and valves was found.
+         */
+        route_found,
+        /**
+         * @brief route_not_found the search finished and there is no state compatible with the input.
+         */
+        route_not_found,
+        /**
+         * @brief route_timed_out the budget was exhausted before any state was found.
+         */
+        route_timed_out,
+        /**
+         * @brief route_best_found the budget was exhausted, the state returned is the best found so far but it may not be the minimal.
+         */
+        route_best_found
+    } RouteStatus;
+
+    /**
+     * @brief The QueryBudget struct limits of a single query.
+     */
+    typedef struct QueryBudget {
+        /**
+         * @brief timeLimit seconds of wall time the query can run, 0 for no limit.
+         */
+        double timeLimit;
+        /**
+         * @brief inferenceLimit inferences the query can make, 0 for no limit.
+         */
+        long long inferenceLimit;
+        /**
+         * @brief returnBest if true the search keeps the best state found so far, so it can be returned if the budget is exhausted.
+         */
+        bool returnBest;
+    } QueryBudget;
+
+    /**
+     * @brief createEngine this methdod only needs to be invoqued once in a program execution, starts the swi-prolog interpreter
+     * and defines the helper predicates of the constraint_engine module.
      * @param appName path of the executable being call, arg[0] of the main method.
      */
     static void createEngine(const std::string & appName);
@@ -61,13 +152,58 @@ public:
      *
      * @sa QTemporaryFile, @sa RoutingEngine.
      */
-    PrologExecutor(std::unique_ptr<QTemporaryFile> temporaryFile, const std::set<std::string> & varTable);
+    PrologExecutor(std::unique_ptr<QTemporaryFile> temporaryFile, const VariableTable & varTable);
     /**
-     * @brief ~PrologExecutor does not call destroyEngine(), deletes the temporary file.
+     * @brief PrologExecutor creates a new interface to communicate with SWI-Prolog clpfd library loading the predicate from memory.
      *
-     * ~PrologExecutor does not call destroyEngine(), when this methdos is called the unique pointer that
-     * contains the temporary file is destroy, this tells QTemporaryFile to delete the physical file with
-     * the predicate.
+     * Same as the temporary file constructor, but the text of the predicate is loaded by the helper predicate
+     * constraint_engine:load_program/3, that reads it from a memory stream with load_files/2, so nothing is written to
+     * the filesystem.
+     *
+     * @param program text with the prolog program that contains the predicate that calculate constraints for a given machine.
+     * @param varTable name of the variables used in the predicate, in alphabetical order the same order the predicate has them.
+     */
+    PrologExecutor(const std::string & program, const VariableTable & varTable) throw(std::runtime_error);
+    /**
+     * @brief PrologExecutor creates a new interface to communicate with SWI-Prolog clpfd library building the predicate from a tree.
+     *
+     * The clause of the predicate is built as swi-prolog terms by a PrologTermBuilder and asserted in the module of this executor,
+     * so the text of the program is never generated nor parsed.
+     *
+     * @param ast tree with the translated restrictions.
+     * @param restrictions id of the root node of every restriction of the predicate.
+     * @param varTable name of the variables used in the predicate, in alphabetical order the same order the predicate has them.
+     *
+     * @sa PrologTermBuilder
+     */
+    PrologExecutor(const ConstraintAst & ast,
+                   const std::vector<ConstraintAst::NodeId> & restrictions,
+                   const VariableTable & varTable) throw(std::runtime_error);
+    /**
+     * @brief PrologExecutor creates a new interface to communicate with SWI-Prolog clpfd library loading a compiled predicate.
+     *
+     * If the cache contains the key the .qlf file of the key is loaded and program is not used, so it can be empty. Otherwise
+     * program is written to the source file of the key and compiled with qcompile/1, that loads it and leaves the .qlf file in the
+     * cache for later executions. A runtime_error is thrown if the compiled file can not be loaded, the caller can then remove the key
+     * from the cache and try again with the text of the program.
+     *
+     * @param cache directory with the compiled programs.
+     * @param key key of the program, returned by CompiledProgramCache::makeKey().
+     * @param program text with the prolog program, only used if the cache does not contain the key.
+     * @param varTable name of the variables used in the predicate, in alphabetical order the same order the predicate has them.
+     *
+     * @sa CompiledProgramCache
+     */
+    PrologExecutor(const CompiledProgramCache & cache,
+                   const std::string & key,
+                   const std::string & program,
+                   const VariableTable & varTable) throw(std::runtime_error);
+    /**
+     * @brief ~PrologExecutor does not call destroyEngine(), unloads the program and deletes the temporary file.
+     *
+     * ~PrologExecutor does not call destroyEngine(), the clauses of the program are removed from the module of this executor with
+     * unload_file/1, or with abolish/1 if the predicate was asserted, then the unique pointer that contains the temporary file is destroy, this tells QTemporaryFile to delete the
+     * physical file with the predicate.
      */
     virtual ~PrologExecutor();
 
@@ -78,34 +214,468 @@ public:
      * as grounded variables and the rest as free ones, if possible returns the state of the machine that calculated by the swi-prolog
      * interpreter. If the interprete throw any exception this is throw as a runtime_error to C++ to be handled.
      *
+     * This method does not modify the executor, so it can be invoked at the same time from several threads as long as each thread
+     * has its own swi-prolog engine attached, as PrologExecutorPool does.
+     *
      * @param inputStates map with the name as key and the value of the variables that are going to be ground when calling the swi-prolog
-     * interpreter.
+     * interpreter. A runtime_error is thrown if any of the names is not a variable of the predicate.
      * @param outStates map with the name as key and the value of every variable at the predicate fill with the corresponding value calculated
      * by the swi-prolog interpreter. If no solution is found for the gicen input, the map is returned intact.
      * @return true if a state compatible with the input data is found, false otherwise.
      */
     virtual bool calculateNewRoute(const std::unordered_map<std::string, long long> & inputStates,
                                    std::unordered_map<std::string, long long> & outStates) throw(std::runtime_error);
+    /**
+     * @brief calculateNewRoutes solves several set of flows with a single call to the swi-prolog interpreter.
+     *
+     * calculateNewRoutes does the same as calculateNewRoute for every element of inputStatesBatch, but all the terms are created inside
+     * the same frame and the whole batch is solved by one call to the helper predicate constraint_engine:solve_batch/4, that
+     * iterates over the list of arguments invoking the machine predicate for each one. This way the cost of the C++/Prolog interface
+     * is paid once per batch instead of once per query.
+     *
+     * @param inputStatesBatch vector with the input maps, each one with the name as key and the value of the variables that are going
+     * to be ground when calling the predicate.
+     * @param outStatesBatch resized to the size of inputStatesBatch, the element i is filled with the state calculated for the
+     * input i. If no solution is found for an input the corresponding map is left intact.
+     * @return a vector with the same size as inputStatesBatch, true at the positions where a state compatible with the input was found.
+     * If the interpreter throws any exception the whole batch is aborted and the exception is thrown as a runtime_error.
+     *
+     * @sa calculateNewRoute
+     */
+    virtual std::vector<bool> calculateNewRoutes(const std::vector<std::unordered_map<std::string, long long>> & inputStatesBatch,
+                                                 std::vector<std::unordered_map<std::string, long long>> & outStatesBatch) throw(std::runtime_error);
+
+    /**
+     * @brief calculateNewRouteIndexed same as calculateNewRoute but the variables are identified by their position in the predicate
+     * instead of by their name.
+     *
+     * The positions can be resolved once with getVarPosition() or taken from the order of getVarNames(), that is the same order of
+     * PrologTranslationStack::getVarTable(). No string is hashed and no map is allocated during the call.
+     *
+     * @param inputPositions positions of the variables that are going to be ground when calling the swi-prolog interpreter.
+     * @param inputValues values of the variables to be ground, inputValues[i] is the value of the variable at inputPositions[i].
+     * @param outStates resized to the number of variables of the predicate and filled with the value of every variable, the value of
+     * the variable at position i is stored at outStates[i]. If no solution is found for the given input, the vector is returned intact.
+     * @return true if a state compatible with the input data is found, false otherwise.
+     *
+     * @sa calculateNewRoute, @sa getVarPosition
+     */
+    bool calculateNewRouteIndexed(const std::vector<int> & inputPositions,
+                                  const std::vector<long long> & inputValues,
+                                  std::vector<long long> & outStates) throw(std::runtime_error);
+
+    /**
+     * @brief calculateNewRouteWithBudget same as calculateNewRoute but the search is cancelled when the budget is exhausted.
+     *
+     * The predicate is called through the helper predicate constraint_engine:solve_with_budget/5, that runs it inside
+     * call_with_time_limit/2 and call_with_inference_limit/3, so a search that takes too long returns route_timed_out instead of
+     * blocking the caller. The interpreter is left ready for the next query.
+     *
+     * If budget.returnBest is true the query is solved by constraint_engine:solve_anytime/7 instead: the restrictions of the predicate
+     * are posted and the pumps and the valves are labeled with a branch and bound that remembers every improving state, so when the
+     * budget is exhausted the best state found so far is returned with route_best_found. When the search is not cut the state
+     * has the same cost as the one returned by calculateNewRoute, although among several states with the same cost a different
+     * one can be chosen.
+     *
+     * Only the results of the searches that finished are stored at the route cache.
+     *
+     * @param inputStates map with the name as key and the value of the variables that are going to be ground.
+     * @param outStates map with the name as key and the value of every variable, filled when route_found or route_best_found
+     * is returned, otherwise the map is returned intact.
+     * @param budget limits of the query.
+     * @return the status of the query.
+     *
+     * @sa calculateNewRoute, @sa QueryBudget
+     */
+    RouteStatus calculateNewRouteWithBudget(const std::unordered_map<std::string, long long> & inputStates,
+                                            std::unordered_map<std::string, long long> & outStates,
+                                            const QueryBudget & budget) throw(std::runtime_error);
+    /**
+     * @brief calculateNewRouteIndexedWithBudget same as calculateNewRouteWithBudget but the variables are identified by their
+     * position in the predicate.
+     *
+     * @sa calculateNewRouteIndexed, @sa calculateNewRouteWithBudget
+     */
+    RouteStatus calculateNewRouteIndexedWithBudget(const std::vector<int> & inputPositions,
+                                                   const std::vector<long long> & inputValues,
+                                                   std::vector<long long> & outStates,
+                                                   const QueryBudget & budget) throw(std::runtime_error);
+    /**
+     * @brief calculateNewRouteWithStrategy same as calculateNewRoute but the pumps and valves are labeled with the given strategy
+     * instead of the labeling of the predicate, so a call that needs a fast answer can ask for the first feasible route.
+     *
+     * The predicate is called through the helper predicate constraint_engine:solve_labeling/4, that posts the restrictions of the
+     * predicate and then runs the labeling of the strategy. The result depends on the strategy, so the route cache is not used.
+     *
+     * @param inputStates map with the name as key and the value of the variables that are going to be ground.
+     * @param outStates map with the name as key and the value of every variable, filled only if a route is found.
+     * @param strategy how the labeling searches for the route.
+     * @return true if a route was found, false otherwise.
+     *
+     * @sa calculateNewRoute, @sa LabelingStrategy
+     */
+    bool calculateNewRouteWithStrategy(const std::unordered_map<std::string, long long> & inputStates,
+                                       std::unordered_map<std::string, long long> & outStates,
+                                       const LabelingStrategy & strategy) throw(std::runtime_error);
+    /**
+     * @brief calculateNewRouteIndexedWithStrategy same as calculateNewRouteWithStrategy but the variables are identified by their
+     * position in the predicate.
+     *
+     * @sa calculateNewRouteIndexed, @sa calculateNewRouteWithStrategy
+     */
+    bool calculateNewRouteIndexedWithStrategy(const std::vector<int> & inputPositions,
+                                              const std::vector<long long> & inputValues,
+                                              std::vector<long long> & outStates,
+                                              const LabelingStrategy & strategy) throw(std::runtime_error);
+    /**
+     * @brief calculateAlternativeRoutes returns up to maxRoutes distinct routes for the same input, from the best to the worst, in a
+     * single search.
+     *
+     * The query is solved by constraint_engine:solve_alternatives/8: the restrictions of the predicate are posted once and the labeling
+     * of the strategy, without the once/1 that keeps only its first solution, is backtracked into until maxRoutes routes have been
+     * collected or there are no more. With an optimal strategy the clpfd labeling generates the solutions in increasing order of cost,
+     * so the routes are the best ones by the same objective as calculateNewRoute, each with a different assignment of pumps and valves.
+     * With a first feasible strategy they are the first ones found.
+     *
+     * The time and inference limits of the budget cap the whole search, when they are exhausted the routes collected so far are
+     * returned with route_best_found, returnBest is ignored. The results are not stored at the route cache.
+     *
+     * @param inputStates map with the name as key and the value of the variables that are going to be ground.
+     * @param maxRoutes maximum number of routes to return, at least one.
+     * @param routes filled with one map per route, ordered as found, cleared if no route is found.
+     * @param budget limits of the whole search, the default has no limits.
+     * @param strategy how the labeling searches for the routes.
+     * @return route_found if the search finished, route_not_found if it finished without routes, route_best_found if the budget was
+     * exhausted after finding some routes and route_timed_out if it was exhausted before.
+     *
+     * @sa calculateNewRouteWithStrategy, @sa QueryBudget
+     */
+    RouteStatus calculateAlternativeRoutes(const std::unordered_map<std::string, long long> & inputStates,
+                                           std::size_t maxRoutes,
+                                           std::vector<std::unordered_map<std::string, long long>> & routes,
+                                           const QueryBudget & budget = QueryBudget(),
+                                           const LabelingStrategy & strategy = LabelingStrategy()) throw(std::runtime_error);
+    /**
+     * @brief calculateAlternativeRoutesIndexed same as calculateAlternativeRoutes but the variables are identified by their position
+     * in the predicate.
+     *
+     * @sa calculateNewRouteIndexed, @sa calculateAlternativeRoutes
+     */
+    RouteStatus calculateAlternativeRoutesIndexed(const std::vector<int> & inputPositions,
+                                                  const std::vector<long long> & inputValues,
+                                                  std::size_t maxRoutes,
+                                                  std::vector<std::vector<long long>> & routes,
+                                                  const QueryBudget & budget = QueryBudget(),
+                                                  const LabelingStrategy & strategy = LabelingStrategy()) throw(std::runtime_error);
+
+    /**
+     * @brief setRouteCacheCapacity sets the maximum number of results kept by the route cache.
+     *
+     * The result of calculateNewRoute only depends on the grounded variables, so the executor can keep the results of previous
+     * calls, including the ones without solution, and return them without calling the swi-prolog interpreter. The cache is
+     * disabled by default.
+     *
+     * @param capacity maximum number of results, 0 disables the cache.
+     *
+     * @sa RouteCache
+     */
+    void setRouteCacheCapacity(std::size_t capacity);
+    /**
+     * @brief getRouteCacheStats returns the hits, misses and size of the route cache.
+     * @return a copy of the counters of the cache.
+     */
+    RouteCache::Stats getRouteCacheStats() const;
+    /**
+     * @brief clearRouteCache removes all the results stored at the route cache.
+     */
+    void clearRouteCache();
+    /**
+     * @brief saveRouteCache writes the results stored at the route cache to a file, so they can be reloaded on later executions
+     * by a machine with the same predicate, the file is identified by getMachineHash().
+     * @param path path of the file to be written, usually next to the file of the predicate.
+     * @return true if the file was written, false otherwise.
+     */
+    bool saveRouteCache(const std::string & path) const;
+    /**
+     * @brief loadRouteCache adds to the route cache the results of a file written by saveRouteCache.
+     * @param path path of the file to be read.
+     * @return true if the results were loaded, false if the file does not exists or was saved by a machine with a different predicate,
+     * variables or labeling.
+     */
+    bool loadRouteCache(const std::string & path);
+    /**
+     * @brief getMachineHash returns the hash that identifies the results of the route cache: the hash of the program, the variables of
+     * the predicate in order, because the results are stored by position, and the labeling of the predicate, because it decides which
+     * route is returned.
+     * @return hexadecimal string with the SHA-1 of the three.
+     */
+    std::string getMachineHash() const;
+    /**
+     * @brief setSpecialization enables the specialized predicates for the recurring grounding signatures, disabled by default.
+     *
+     * The grounding signature of a query is the set of its grounded variables. When calculateNewRoute has been called threshold
+     * times with the same signature, the restrictions of the machine are posted and propagated once for every combination of values
+     * of the grounded variables allowed by their domains, and each one becomes a clause of a new predicate: the head has the values
+     * of the grounded variables followed by the free variables, and the body the residual constraints of the free variables, with
+     * their domains already pruned for those values, followed by the labeling. The combinations that the propagation rejects get no
+     * clause. Later queries with that signature select their clause by the values of the grounded variables, so they skip the posting
+     * and propagation of the static structure of the machine. The signatures with unbounded grounded variables, or with more than
+     * MAX_SPECIALIZED_CLAUSES combinations, keep calling the original predicate. The components of a decomposed program are solved one
+     * after the other by the specialized predicate.
+     *
+     * @param threshold number of queries with the same signature before it is specialized, 0 disables the specialization.
+     * @param maxSpecializations maximum number of specialized predicates of this machine.
+     *
+     * @sa SpecializationTable
+     */
+    void setSpecialization(unsigned int threshold, std::size_t maxSpecializations = 16);
+    /**
+     * @brief getNumSpecializations returns the number of specialized predicates created for this machine.
+     */
+    std::size_t getNumSpecializations() const;
+    /**
+     * @brief setWarmStart enables seeding every query with the last solution found by this executor, disabled by default.
+     *
+     * The restrictions are posted with the new grounded variables and, if the labeled variables of the previous solution are still
+     * consistent with them, the objectives of the labeling of the program are bounded by their value at the previous solution: the
+     * objectives of the lexicographic strategy are bounded lexicographically, a weighted objective gets a single bound and a first
+     * feasible labeling none. The minimization prunes every branch worse than the previous solution, so a query that differs in a
+     * few flows converges faster, and the returned solution is still minimal. Queries with a warm start do not use the specialized
+     * predicates.
+     *
+     * The queries with a budget are not seeded, their search is bounded by the budget instead, but the route they return, also the
+     * best one found when the budget runs out, becomes the previous solution of the next query.
+     */
+    void setWarmStart(bool enabled);
+    /**
+     * @brief clearWarmStart forgets the last solution, the next query starts the search from scratch.
+     */
+    void clearWarmStart();
+    /**
+     * @brief getStats returns the metrics of the queries made to this executor and the time spent loading its program.
+     * @return a copy of the accumulated metrics.
+     *
+     * @sa ExecutorStats
+     */
+    ExecutorStats::Stats getStats() const;
+    /**
+     * @brief resetStats sets all the query metrics to 0.
+     */
+    void resetStats();
+    /**
+     * @brief setProfiling enables the collection of the inferences and stack usage of every query, disabled by default because
+     * it needs extra calls to statistics/2.
+     */
+    void setProfiling(bool enabled);
+    /**
+     * @brief setTraceLog writes the metrics of one of every sampleEvery queries as a line to log.
+     * @param log stream where the lines are written, it must outlive this object, NULL disables the trace.
+     * @param sampleEvery sampling period, 1 writes every query.
+     */
+    void setTraceLog(std::ostream* log, unsigned int sampleEvery);
+    /**
+     * @brief getProgramHash returns a hash of the text of the predicate, that identifies the machine.
+     * @return hexadecimal string with the SHA-1 of the predicate file.
+     */
+    inline const std::string & getProgramHash() const {
+        return programHash;
+    }
+
+    /**
+     * @brief getModuleName returns the name of the prolog module where the program of this executor is loaded.
+     * @return the name of the module, unique for each executor of the process except for the executors created from the same
+     * CompiledProgramCache key, that share the module where the program was loaded first.
+     */
+    inline const std::string & getModuleName() const {
+        return moduleName;
+    }
+
+    /**
+     * @brief getVarPosition returns the position of a variable in the predicate.
+     * @param name name of the variable.
+     * @return the position of the variable, or -1 if the predicate has not a variable with that name.
+     */
+    int getVarPosition(const std::string & name) const;
+    /**
+     * @brief getVarNames returns the names of the variables of the predicate.
+     * @return a vector with the name of the variable at position i in the position i.
+     */
+    inline const std::vector<std::string> & getVarNames() const {
+        return variables.getNames();
+    }
+    /**
+     * @brief getVariableTable returns the symbol table of the variables of the predicate.
+     */
+    inline const VariableTable & getVariableTable() const {
+        return variables;
+    }
 
 private:
+    /**
+     * @brief The LoadedProgram struct a program of a CompiledProgramCache loaded in a module.
+     */
+    typedef struct LoadedProgram {
+        std::string moduleName;
+        /**
+         * @brief numExecutors number of executors using the module, the program is unloaded when it reaches 0.
+         */
+        int numExecutors;
+    } LoadedProgram;
+
     /**
      * @brief engine objects that contains the swi-prolog interpreter
      */
     static PlEngine* engine;
+    /**
+     * @brief loadedPrograms programs of the compiled caches currently loaded, with the path of their source as key.
+     *
+     * swi-prolog identifies a loaded file by its path, so loading the same file into a second module reloads it and unloading it
+     * removes the clauses of every module. The executors created from the same key share the module instead.
+     */
+    static std::map<std::string, LoadedProgram> loadedPrograms;
+    static std::mutex loadedProgramsMutex;
 
     /**
-     * @brief fileName path to the temprary file containing the predicate that makes the calculus in swi-prolog.
+     * @brief fileName path to the temprary file containing the predicate that makes the calculus in swi-prolog, or the
+     * identifier of the source if the predicate was loaded from memory, empty if the predicate was asserted.
      */
     std::string fileName;
     /**
-     * @brief varPositionTable map with the name of a variable as key and the position in the prolog predicate as value
+     * @brief moduleName name of the prolog module where the program of this executor is loaded, unique for each executor unless the
+     * program comes from a CompiledProgramCache.
      */
-    std::unordered_map<std::string, int> varPositionTable;
+    std::string moduleName;
+    /**
+     * @brief sharedProgram true if the program is at loadedPrograms and can be used by other executors.
+     */
+    bool sharedProgram;
+    /**
+     * @brief variables symbol table of the variables, the id of a variable is its position in the prolog predicate.
+     */
+    VariableTable variables;
     /**
      * @brief file pointer to the temporary file, this is kept so the tempory file is not deleted until this
      * object is destroyed
      */
     std::unique_ptr<QTemporaryFile> file;
+    /**
+     * @brief programHash hexadecimal SHA-1 of the text of the predicate.
+     */
+    std::string programHash;
+    /**
+     * @brief programLabeling LabelingStrategy::toString() of the labeling of a predicate built from a tree, empty when the predicate
+     * is loaded from its text or from a compiled file, whose hash already covers the labeling.
+     */
+    std::string programLabeling;
+    /**
+     * @brief routeCache results of previous calls to calculateNewRoute, a unique pointer because the cache holds a mutex.
+     */
+    std::unique_ptr<RouteCache> routeCache;
+    /**
+     * @brief stats metrics of the queries, a unique pointer because the metrics hold a mutex.
+     */
+    std::unique_ptr<ExecutorStats> stats;
+    /**
+     * @brief specializations grounding signatures of the queries and their specialized predicates, a unique pointer because the
+     * table holds a mutex.
+     */
+    std::unique_ptr<SpecializationTable> specializations;
+    /**
+     * @brief warmStart true if the queries are seeded with the last solution.
+     */
+    bool warmStart;
+    /**
+     * @brief previousStates value of every variable at the last solution found, ordered by position, empty if there is none.
+     */
+    std::vector<long long> previousStates;
+    /**
+     * @brief warmStartMutex protects warmStart and previousStates, a unique pointer because a mutex can not be moved.
+     */
+    std::unique_ptr<std::mutex> warmStartMutex;
+
+    /**
+     * @brief initVariables chooses the name of the module, fills the table of variables, and creates an empty route cache
+     * and empty metrics.
+     * @param varTable name of the variables used in the predicate, in alphabetical order.
+     */
+    void initVariables(const VariableTable & varTable);
+    /**
+     * @brief readPreviousSolution copies the last solution found if the warm start is enabled.
+     * @return true if there is a solution to start from.
+     */
+    bool readPreviousSolution(std::vector<long long> & states) const;
+    /**
+     * @brief storePreviousSolution keeps a solution as the start of the next query, if the warm start is enabled.
+     */
+    void storePreviousSolution(const std::vector<long long> & states);
+    /**
+     * @brief specialize creates the specialized predicate of a grounding signature and reports the result to the specializations table.
+     * @param signature sorted positions of the grounded variables.
+     * @param name name of the new predicate.
+     */
+    void specialize(const std::vector<int> & signature, const std::string & name);
+    /**
+     * @brief defineHelperPredicates asserts in the constraint_engine module the predicates shared by all the machines.
+     */
+    static void defineHelperPredicates();
+    /**
+     * @brief readStatistic returns the value of a key of statistics/2 for the engine of the calling thread.
+     */
+    static long long readStatistic(const char* key);
+    /**
+     * @brief unloadFile removes the clauses loaded from fileName, if any, without throwing.
+     */
+    void unloadFile();
+    /**
+     * @brief makeLimits builds the limits(Time, Inferences) term of budget_call/3, the inference limit is stored as a 64 bits integer.
+     */
+    static PlTerm makeLimits(const QueryBudget & budget);
+    /**
+     * @brief elapsedMs returns the milliseconds passed since start.
+     */
+    static double elapsedMs(std::chrono::steady_clock::time_point start);
+
+    /**
+     * @brief resolveInputStates translates the names of the grounded variables to their positions in the predicate.
+     * @param inputStates map with the name as key and the value of the variables that are going to be ground.
+     * @param inputPositions filled with the positions of the variables.
+     * @param inputValues filled with the values of the variables, in the same order as inputPositions.
+     */
+    void resolveInputStates(const std::unordered_map<std::string, long long> & inputStates,
+                            std::vector<int> & inputPositions,
+                            std::vector<long long> & inputValues) const throw(std::runtime_error);
+    /**
+     * @brief setInputStates grounds the variables in the term vector.
+     * @param inputPositions positions of the variables that are going to be ground.
+     * @param inputValues values of the variables that are going to be ground.
+     * @param av term vector with the arguments of the predicate.
+     * @param offset position at av of the first argument of the predicate.
+     */
+    void setInputStates(const std::vector<int> & inputPositions,
+                        const std::vector<long long> & inputValues,
+                        const PlTermv & av,
+                        int offset) const;
+    /**
+     * @brief readOutStates copies the values of the arguments of the predicate to outStates.
+     * @param av term vector with the arguments of the predicate already solved.
+     * @param offset position at av of the first argument of the predicate.
+     * @param outStates resized to the number of variables, the value of the variable at position i is stored at outStates[i].
+     */
+    void readOutStates(const PlTermv & av, int offset, std::vector<long long> & outStates) const;
+    /**
+     * @brief makeList builds a prolog list with the terms of av at the given positions.
+     */
+    PlTerm makeList(const PlTermv & av, VariableTable::IdRange positions) const;
+    /**
+     * @brief makeValueList builds a prolog list with the values of a state at the given positions.
+     */
+    PlTerm makeValueList(const std::vector<long long> & states, VariableTable::IdRange positions) const;
+    /**
+     * @brief fillOutStates copies a state ordered by position to a map with the name of the variables as key.
+     * @param states value of every variable, ordered by position.
+     * @param outStates map with the name as key where the value of every variable is stored.
+     */
+    void fillOutStates(const std::vector<long long> & states, std::unordered_map<std::string, long long> & outStates) const;
 };
 
 #endif // PROLOGEXECUTOR_H
@@ -0,0 +1,305 @@
+#include "prologexecutorpool.h"
+
+PrologExecutorPool::PrologExecutorPool(PrologExecutor* executor, unsigned int numThreads) throw(std::runtime_error) :
+    RoutingEngine()
+{
+    this->executor = std::unique_ptr<PrologExecutor>(executor);
+    this->stopping = false;
+    this->maxPendingAsync = 64;
+
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    //the vectors are reserved so a started thread is never lost when a push_back reallocates
+    std::vector<std::future<void>> enginesReady;
+    enginesReady.reserve(numThreads);
+    workers.reserve(numThreads);
+    try {
+        for(unsigned int i = 0; i < numThreads; i++) {
+            std::shared_ptr<std::promise<void>> engineReady = std::make_shared<std::promise<void>>();
+            enginesReady.push_back(engineReady->get_future());
+            workers.emplace_back(&PrologExecutorPool::workerLoop, this, engineReady);
+        }
+
+        for(std::future<void> & ready: enginesReady) {
+            ready.get();
+        }
+    } catch (std::exception & e) {
+        //the workers already started must be joined, destroying a joinable std::thread terminates the program
+        stopWorkers();
+        throw(std::runtime_error("PrologExecutorPool::PrologExecutorPool(). " + std::string(e.what())));
+    }
+}
+
+PrologExecutorPool::~PrologExecutorPool() {
+    stopWorkers();
+}
+
+bool PrologExecutorPool::calculateNewRoute(const std::unordered_map<std::string, long long> & inputStates,
+                                           std::unordered_map<std::string, long long> & outStates)
+    throw(std::runtime_error)
+{
+    //the caller blocks until the task is finished so the references remain valid while the worker uses them
+    std::shared_ptr<std::packaged_task<bool()>> task = std::make_shared<std::packaged_task<bool()>>(
+                [this, &inputStates, &outStates]() {
+                    return executor->calculateNewRoute(inputStates, outStates);
+                });
+    std::future<bool> result = task->get_future();
+
+    submit([task]() {
+        (*task)();
+    });
+    return result.get();
+}
+
+bool PrologExecutorPool::calculateNewRouteIndexed(const std::vector<int> & inputPositions,
+                                                  const std::vector<long long> & inputValues,
+                                                  std::vector<long long> & outStates)
+    throw(std::runtime_error)
+{
+    std::shared_ptr<std::packaged_task<bool()>> task = std::make_shared<std::packaged_task<bool()>>(
+                [this, &inputPositions, &inputValues, &outStates]() {
+                    return executor->calculateNewRouteIndexed(inputPositions, inputValues, outStates);
+                });
+    std::future<bool> result = task->get_future();
+
+    submit([task]() {
+        (*task)();
+    });
+    return result.get();
+}
+
+std::future<PrologExecutorPool::AsyncRoute> PrologExecutorPool::calculateNewRouteAsync(const std::unordered_map<std::string, long long> & inputStates,
+                                                                                     const std::string & supersedeKey,
+                                                                                     AsyncCallback callback)
+{
+    std::shared_ptr<AsyncRequest> request = std::make_shared<AsyncRequest>();
+    request->inputStates = inputStates;
+    request->supersedeKey = supersedeKey;
+    request->hasBudget = false;
+    request->budget = PrologExecutor::QueryBudget();
+    request->callback = std::move(callback);
+    request->cancelled = false;
+    return submitAsync(request);
+}
+
+std::future<PrologExecutorPool::AsyncRoute> PrologExecutorPool::calculateNewRouteAsync(const std::unordered_map<std::string, long long> & inputStates,
+                                                                                     const PrologExecutor::QueryBudget & budget,
+                                                                                     const std::string & supersedeKey,
+                                                                                     AsyncCallback callback)
+{
+    std::shared_ptr<AsyncRequest> request = std::make_shared<AsyncRequest>();
+    request->inputStates = inputStates;
+    request->supersedeKey = supersedeKey;
+    request->hasBudget = true;
+    request->budget = budget;
+    request->callback = std::move(callback);
+    request->cancelled = false;
+    return submitAsync(request);
+}
+
+std::size_t PrologExecutorPool::cancelPending(const std::string & supersedeKey) {
+    std::vector<std::shared_ptr<AsyncRequest>> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        takePendingAsync(supersedeKey, cancelled);
+    }
+    completeCancelled(cancelled);
+    return cancelled.size();
+}
+
+void PrologExecutorPool::setMaxPendingAsync(std::size_t maxPending) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    maxPendingAsync = maxPending;
+}
+
+std::size_t PrologExecutorPool::getNumPendingAsync() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return pendingAsync.size();
+}
+
+std::future<PrologExecutorPool::AsyncRoute> PrologExecutorPool::submitAsync(std::shared_ptr<AsyncRequest> request) {
+    std::future<AsyncRoute> result = request->promise.get_future();
+
+    //the futures of the cancelled requests are fulfilled after releasing the lock, their callbacks may submit new queries
+    std::vector<std::shared_ptr<AsyncRequest>> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (!request->supersedeKey.empty()) {
+            takePendingAsync(request->supersedeKey, cancelled);
+        }
+        while (maxPendingAsync > 0 && pendingAsync.size() >= maxPendingAsync) {
+            pendingAsync.front()->cancelled = true;
+            removePendingTask(pendingAsync.front());
+            cancelled.push_back(pendingAsync.front());
+            pendingAsync.pop_front();
+        }
+
+        Task task;
+        task.run = [this, request]() {
+            solveAsync(request);
+        };
+        task.request = request;
+        pendingAsync.push_back(request);
+        pendingTasks.push_back(std::move(task));
+    }
+    queueCondition.notify_one();
+
+    completeCancelled(cancelled);
+    return result;
+}
+
+void PrologExecutorPool::solveAsync(std::shared_ptr<AsyncRequest> request) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (request->cancelled) {
+            return;
+        }
+        removePendingAsync(request);
+    }
+
+    AsyncRoute route = AsyncRoute();
+    try {
+        if (request->hasBudget) {
+            switch (executor->calculateNewRouteWithBudget(request->inputStates, route.outStates, request->budget)) {
+            case PrologExecutor::route_found:
+                route.status = async_found;
+                break;
+            case PrologExecutor::route_best_found:
+                route.status = async_best_found;
+                break;
+            case PrologExecutor::route_timed_out:
+                route.status = async_timed_out;
+                break;
+            default:
+                route.status = async_not_found;
+                break;
+            }
+        } else {
+            route.status = executor->calculateNewRoute(request->inputStates, route.outStates) ? async_found : async_not_found;
+        }
+    } catch (std::exception & e) {
+        failAsync(*request, e.what());
+        return;
+    } catch (...) {
+        failAsync(*request, "unknown exception");
+        return;
+    }
+    completeAsync(*request, route);
+}
+
+void PrologExecutorPool::failAsync(AsyncRequest & request, const std::string & error) {
+    AsyncRoute route = AsyncRoute();
+    route.status = async_error;
+    route.error = error;
+
+    request.promise.set_exception(std::current_exception());
+    if (request.callback) {
+        try {
+            request.callback(route);
+        } catch (...) {
+            //an exception must not stop the worker
+        }
+    }
+}
+
+void PrologExecutorPool::completeAsync(AsyncRequest & request, const AsyncRoute & route) {
+    request.promise.set_value(route);
+    if (request.callback) {
+        try {
+            request.callback(route);
+        } catch (...) {
+            //an exception must not stop the worker
+        }
+    }
+}
+
+void PrologExecutorPool::completeCancelled(const std::vector<std::shared_ptr<AsyncRequest>> & cancelled) {
+    AsyncRoute route = AsyncRoute();
+    route.status = async_cancelled;
+    for(const std::shared_ptr<AsyncRequest> & request: cancelled) {
+        completeAsync(*request, route);
+    }
+}
+
+void PrologExecutorPool::takePendingAsync(const std::string & supersedeKey, std::vector<std::shared_ptr<AsyncRequest>> & cancelled) {
+    for(auto it = pendingAsync.begin(); it != pendingAsync.end();) {
+        if ((*it)->supersedeKey == supersedeKey) {
+            (*it)->cancelled = true;
+            removePendingTask(*it);
+            cancelled.push_back(*it);
+            it = pendingAsync.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void PrologExecutorPool::removePendingAsync(const std::shared_ptr<AsyncRequest> & request) {
+    auto it = std::find(pendingAsync.begin(), pendingAsync.end(), request);
+    if (it != pendingAsync.end()) {
+        pendingAsync.erase(it);
+    }
+}
+
+void PrologExecutorPool::removePendingTask(const std::shared_ptr<AsyncRequest> & request) {
+    auto it = std::find_if(pendingTasks.begin(), pendingTasks.end(), [&request](const Task & task) {
+        return task.request == request;
+    });
+    if (it != pendingTasks.end()) {
+        pendingTasks.erase(it);
+    }
+}
+
+void PrologExecutorPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        Task queued;
+        queued.run = std::move(task);
+        pendingTasks.push_back(std::move(queued));
+    }
+    queueCondition.notify_one();
+}
+
+void PrologExecutorPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+
+    for(std::thread & worker: workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+void PrologExecutorPool::workerLoop(std::shared_ptr<std::promise<void>> engineReady) {
+    if (PL_thread_attach_engine(NULL) < 0) {
+        engineReady->set_exception(std::make_exception_ptr(
+                                       std::runtime_error("Impossible to attach a new swi-prolog engine to the worker thread.")));
+        return;
+    }
+    engineReady->set_value();
+
+    while(true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() {
+                return stopping || !pendingTasks.empty();
+            });
+
+            if (pendingTasks.empty()) {
+                break;
+            }
+            task = std::move(pendingTasks.front());
+            pendingTasks.pop_front();
+        }
+        task.run();
+    }
+    PL_thread_destroy_engine();
+}
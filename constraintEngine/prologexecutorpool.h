@@ -0,0 +1,305 @@
+#ifndef PROLOGEXECUTORPOOL_H
+#define PROLOGEXECUTORPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+
+#include "constraintengine/prologexecutor.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The PrologExecutorPool class distributes route calculations among several threads, each one with its own SWI-Prolog engine.
+ *
+ * The PrologExecutorPool class implements the RoutingEngine interface on top of a PrologExecutor. A fixed number of worker threads
+ * are started and each one attaches its own engine to the swi-prolog interpreter (PL_thread_attach_engine), so several calls to
+ * calculateNewRoute can be solved at the same time instead of being queued on the single engine created by PrologExecutor::createEngine().
+ *
+ * The predicate of the machine is loaded only once, by the PrologExecutor passed to the constructor: the clauses database of swi-prolog
+ * is shared by all the engines of the process, so every worker sees the same predicate without consulting it again.
+ *
+ * calculateNewRoute is thread safe, it can be invoked from any thread of the program and blocks until one of the workers has solved the query.
+ * calculateNewRouteAsync does not block, it returns a future and optionally invokes a callback when the query is solved, so the caller
+ * can keep working while the route is calculated. A pool with a single thread is a dedicated solver thread with its own engine.
+ * SWI-Prolog must be built with multi-thread support.
+ *
+ * @sa PrologExecutor, @sa RoutingEngine.
+ */
+class PROLOGEXECUTORPOOL_EXPORT PrologExecutorPool : public RoutingEngine
+{
+public:
+    /**
+     * @brief The AsyncStatus enum result of an asynchronous query.
+     */
+    typedef enum AsyncStatus_ {
+        async_found,
+        async_not_found,
+        /**
+         * @brief async_timed_out the budget of the query was exhausted before any state was found.
+         */
+        async_timed_out,
+        /**
+         * @brief async_best_found the budget of the query was exhausted, the state is the best found so far.
+         */
+        async_best_found,
+        /**
+         * @brief async_cancelled the query was removed from the queue before being solved.
+         */
+        async_cancelled,
+        /**
+         * @brief async_error an exception was thrown while solving the query, only reported to the callback, the future rethrows it.
+         */
+        async_error
+    } AsyncStatus;
+
+    /**
+     * @brief The AsyncRoute struct result of an asynchronous query.
+     */
+    typedef struct AsyncRoute {
+        AsyncStatus status;
+        /**
+         * @brief outStates value of every variable, empty if no state was found.
+         */
+        std::unordered_map<std::string, long long> outStates;
+        /**
+         * @brief error message of the exception if status is async_error.
+         */
+        std::string error;
+    } AsyncRoute;
+
+    /**
+     * @brief AsyncCallback function invoked when an asynchronous query finishes, from the worker thread that solved it or from the
+     * thread that cancelled it. It must not block. In particular it must not call calculateNewRoute() of the same pool nor wait for
+     * one of its futures: every worker running such a callback waits for a query that no free worker can solve, so the pool deadlocks.
+     * Queuing another asynchronous query is allowed.
+     */
+    typedef std::function<void(const AsyncRoute &)> AsyncCallback;
+
+    /**
+     * @brief PrologExecutorPool creates a new pool of workers that solves the queries using the given executor.
+     *
+     * PrologExecutor::createEngine() must have been invoked before creating a pool.
+     *
+     * @param executor executor with the predicate of the machine already loaded, the pool takes ownership of the pointer.
+     * @param numThreads number of worker threads, each one with its own swi-prolog engine. If 0 the number of cores of the machine is used.
+     */
+    PrologExecutorPool(PrologExecutor* executor, unsigned int numThreads = 0) throw(std::runtime_error);
+    /**
+     * @brief ~PrologExecutorPool waits for the pending queries, stops the workers, destroys their engines and deletes the executor.
+     */
+    virtual ~PrologExecutorPool();
+
+    /**
+     * @brief calculateNewRoute queues the query and blocks until one of the workers solves it.
+     *
+     * The query is solved by PrologExecutor::calculateNewRoute() in one of the worker threads, any exception thrown there is re-thrown
+     * in the calling thread.
+     *
+     * @param inputStates map with the name as key and the value of the variables that are going to be ground when calling the swi-prolog
+     * interpreter.
+     * @param outStates map with the name as key and the value of every variable at the predicate fill with the corresponding value calculated
+     * by the swi-prolog interpreter. If no solution is found for the gicen input, the map is returned intact.
+     * @return true if a state compatible with the input data is found, false otherwise.
+     *
+     * @sa PrologExecutor::calculateNewRoute
+     */
+    virtual bool calculateNewRoute(const std::unordered_map<std::string, long long> & inputStates,
+                                   std::unordered_map<std::string, long long> & outStates) throw(std::runtime_error);
+
+    /**
+     * @brief calculateNewRouteIndexed queues a query identified by variable positions and blocks until one of the workers solves it.
+     *
+     * @sa PrologExecutor::calculateNewRouteIndexed
+     */
+    bool calculateNewRouteIndexed(const std::vector<int> & inputPositions,
+                                  const std::vector<long long> & inputValues,
+                                  std::vector<long long> & outStates) throw(std::runtime_error);
+
+    /**
+     * @brief calculateNewRouteAsync queues the query and returns without waiting for it to be solved.
+     *
+     * The inputs are copied, so the map can be destroyed after the call. If supersedeKey is not empty every query with the same
+     * key that is still waiting in the queue is cancelled: only the newest flows for a key are worth solving, so the stale ones are
+     * coalesced. A query already being solved is not interrupted, use a budget to bound its duration.
+     *
+     * The number of asynchronous queries waiting in the queue is bounded by setMaxPendingAsync(), when the queue is full the oldest
+     * waiting query is cancelled to make room for the new one.
+     *
+     * @param inputStates map with the name as key and the value of the variables that are going to be ground.
+     * @param supersedeKey key that identifies the queries that replace each other, empty if the query is never superseded.
+     * @param callback function invoked with the result, can be empty.
+     * @return a future with the result, it rethrows any exception thrown while solving the query.
+     *
+     * @sa cancelPending
+     */
+    std::future<AsyncRoute> calculateNewRouteAsync(const std::unordered_map<std::string, long long> & inputStates,
+                                                   const std::string & supersedeKey = std::string(),
+                                                   AsyncCallback callback = AsyncCallback());
+    /**
+     * @brief calculateNewRouteAsync same as the previous one, but the query is solved with a budget.
+     *
+     * @sa PrologExecutor::calculateNewRouteWithBudget
+     */
+    std::future<AsyncRoute> calculateNewRouteAsync(const std::unordered_map<std::string, long long> & inputStates,
+                                                   const PrologExecutor::QueryBudget & budget,
+                                                   const std::string & supersedeKey = std::string(),
+                                                   AsyncCallback callback = AsyncCallback());
+    /**
+     * @brief cancelPending cancels all the asynchronous queries with a key that are waiting in the queue.
+     * @param supersedeKey key of the queries to cancel.
+     * @return the number of queries cancelled.
+     */
+    std::size_t cancelPending(const std::string & supersedeKey);
+    /**
+     * @brief setMaxPendingAsync sets the maximum number of asynchronous queries waiting in the queue, 0 for no limit. 64 by default.
+     */
+    void setMaxPendingAsync(std::size_t maxPending);
+    /**
+     * @brief getNumPendingAsync returns the number of asynchronous queries waiting in the queue.
+     */
+    std::size_t getNumPendingAsync();
+
+    /**
+     * @brief getNumThreads returns the number of worker threads of the pool.
+     * @return number of worker threads, each one with its own swi-prolog engine.
+     */
+    inline unsigned int getNumThreads() const {
+        return (unsigned int) workers.size();
+    }
+    /**
+     * @brief getExecutor returns the executor used by the workers.
+     * @return a reference to the executor owned by the pool.
+     */
+    inline PrologExecutor & getExecutor() {
+        return *executor;
+    }
+
+protected:
+    /**
+     * @brief The AsyncRequest struct asynchronous query waiting in the queue.
+     */
+    typedef struct AsyncRequest {
+        std::unordered_map<std::string, long long> inputStates;
+        std::string supersedeKey;
+        bool hasBudget;
+        PrologExecutor::QueryBudget budget;
+        AsyncCallback callback;
+        std::promise<AsyncRoute> promise;
+        /**
+         * @brief cancelled true if the request was cancelled before a worker took it, protected by queueMutex.
+         */
+        bool cancelled;
+    } AsyncRequest;
+
+    /**
+     * @brief The Task struct function waiting in the queue for a free worker.
+     */
+    typedef struct Task {
+        std::function<void()> run;
+        /**
+         * @brief request asynchronous request solved by run, null for the blocking queries. Used to remove the task when the request
+         * is cancelled.
+         */
+        std::shared_ptr<AsyncRequest> request;
+    } Task;
+
+    /**
+     * @brief executor object that holds the predicate of the machine, shared by all the workers.
+     */
+    std::unique_ptr<PrologExecutor> executor;
+    /**
+     * @brief workers threads that solve the queries, each one has its own swi-prolog engine attached.
+     */
+    std::vector<std::thread> workers;
+    /**
+     * @brief pendingTasks queries waiting for a free worker.
+     */
+    std::deque<Task> pendingTasks;
+    /**
+     * @brief pendingAsync asynchronous queries waiting for a free worker, in order of arrival. Their tasks are also at pendingTasks,
+     * a cancelled request is removed from both. A request cancelled after a worker took its task is only removed from here, and the
+     * task does nothing when executed.
+     */
+    std::deque<std::shared_ptr<AsyncRequest>> pendingAsync;
+    /**
+     * @brief maxPendingAsync maximum size of pendingAsync, 0 for no limit.
+     */
+    std::size_t maxPendingAsync;
+    /**
+     * @brief queueMutex protects pendingTasks, pendingAsync, maxPendingAsync and stopping.
+     */
+    std::mutex queueMutex;
+    /**
+     * @brief queueCondition notifies the workers that there is a new task or that the pool is stopping.
+     */
+    std::condition_variable queueCondition;
+    /**
+     * @brief stopping true when the pool is being destroyed, the workers finish after emptying pendingTasks.
+     */
+    bool stopping;
+
+    /**
+     * @brief submit adds a new task to the queue and wakes up one worker.
+     * @param task function to be executed by one of the workers.
+     */
+    void submit(std::function<void()> task);
+    /**
+     * @brief submitAsync queues an asynchronous request, cancelling the requests it supersedes.
+     */
+    std::future<AsyncRoute> submitAsync(std::shared_ptr<AsyncRequest> request);
+    /**
+     * @brief solveAsync solves an asynchronous request at a worker thread, if it has not been cancelled.
+     */
+    void solveAsync(std::shared_ptr<AsyncRequest> request);
+    /**
+     * @brief completeAsync fulfils the future of a request and invokes its callback, must be called without holding queueMutex.
+     */
+    static void completeAsync(AsyncRequest & request, const AsyncRoute & route);
+    /**
+     * @brief completeCancelled fulfils the futures of cancelled requests, must be called without holding queueMutex.
+     */
+    static void completeCancelled(const std::vector<std::shared_ptr<AsyncRequest>> & cancelled);
+    /**
+     * @brief failAsync fulfils the future of a request with the exception being handled and invokes its callback with async_error,
+     * must be called from a catch block without holding queueMutex.
+     */
+    static void failAsync(AsyncRequest & request, const std::string & error);
+    /**
+     * @brief takePendingAsync marks as cancelled and removes from pendingAsync and pendingTasks the requests with a key, queueMutex
+     * must be held.
+     * @param supersedeKey key of the requests to cancel.
+     * @param cancelled the removed requests are appended here.
+     */
+    void takePendingAsync(const std::string & supersedeKey, std::vector<std::shared_ptr<AsyncRequest>> & cancelled);
+    /**
+     * @brief removePendingTask removes the task of a request from pendingTasks, if no worker has taken it yet, queueMutex must be held.
+     */
+    void removePendingTask(const std::shared_ptr<AsyncRequest> & request);
+    /**
+     * @brief removePendingAsync removes a request from pendingAsync, queueMutex must be held.
+     */
+    void removePendingAsync(const std::shared_ptr<AsyncRequest> & request);
+    /**
+     * @brief stopWorkers stops the workers after they empty the queue and joins the ones that were started.
+     */
+    void stopWorkers();
+    /**
+     * @brief workerLoop main method of each worker thread, attaches a swi-prolog engine to the thread and executes
+     * tasks until the pool is stopped.
+     * @param engineReady promise fulfilled once the engine is attached, with an exception if it could not be attached.
+     */
+    void workerLoop(std::shared_ptr<std::promise<void>> engineReady);
+};
+
+#endif // PROLOGEXECUTORPOOL_H
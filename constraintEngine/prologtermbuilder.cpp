@@ -0,0 +1,156 @@
+#include "prologtermbuilder.h"
+
+PrologTermBuilder::PrologTermBuilder(const ConstraintAst & ast, const std::vector<std::string> & varNames) :
+    ast(ast), varNames(varNames)
+{
+    std::unordered_map<std::string, int> positionTable;
+    for(int i = 0; i < (int) varNames.size(); i++) {
+        positionTable.insert(std::make_pair(varNames[i], i));
+    }
+
+    const std::vector<std::string> & astNames = ast.getVariableNames();
+    varPositions.resize(astNames.size(), -1);
+    for(int varId = 0; varId < (int) astNames.size(); varId++) {
+        auto it = positionTable.find(astNames[varId]);
+        if (it != positionTable.end()) {
+            varPositions[varId] = it->second;
+        }
+    }
+}
+
+PrologTermBuilder::~PrologTermBuilder() {
+
+}
+
+PlTerm PrologTermBuilder::buildRestriction(ConstraintAst::NodeId root, const PlTermv & vars) throw(std::runtime_error) {
+    const ConstraintAst::Node & node = ast.getNode(root);
+
+    switch (node.kind) {
+    case ConstraintAst::variable_node: {
+        int pos = varPositions[node.value];
+        if (pos < 0) {
+            throw(std::runtime_error("PrologTermBuilder::buildRestriction(). Unknown variable " + ast.getVariableName((int) node.value)));
+        }
+        //a new reference, so the caller can never overwrite the slot of the variable
+        PlTerm variable;
+        PL_put_term(variable.ref, vars[pos].ref);
+        return variable;
+    }
+    case ConstraintAst::number_node:
+        return PlTerm((long) node.value);
+    case ConstraintAst::binary_node: {
+        PlTerm left = buildRestriction(ast.getChild(node, 0), vars);
+        PlTerm right = buildRestriction(ast.getChild(node, 1), vars);
+        return PlCompound(opToFunctor((BinaryOperation::BinaryOperators) node.op), PlTermv(left, right));
+    }
+    case ConstraintAst::unary_node: {
+        PlTerm operand = buildRestriction(ast.getChild(node, 0), vars);
+        if ((RuleUnaryOperation::UnaryOperators) node.op == RuleUnaryOperation::absolute_value) {
+            return PlCompound("abs", PlTermv(operand));
+        } else {
+            return operand;
+        }
+    }
+    case ConstraintAst::equality_node: {
+        PlTerm left = buildRestriction(ast.getChild(node, 0), vars);
+        PlTerm right = buildRestriction(ast.getChild(node, 1), vars);
+        return PlCompound(equalityOpToFunctor((Equality::ComparatorOp) node.op), PlTermv(left, right));
+    }
+    case ConstraintAst::conjunction_node: {
+        PlTerm left = buildRestriction(ast.getChild(node, 0), vars);
+        PlTerm right = buildRestriction(ast.getChild(node, 1), vars);
+        return PlCompound(boolOpToFunctor((Conjunction::BoolOperators) node.op), PlTermv(left, right));
+    }
+    case ConstraintAst::implication_node: {
+        PlTerm left = buildRestriction(ast.getChild(node, 0), vars);
+        PlTerm right = buildRestriction(ast.getChild(node, 1), vars);
+        return PlCompound(IMPLICATION_STR, PlTermv(left, right));
+    }
+    case ConstraintAst::domain_node: {
+        PlTerm variable = buildRestriction(ast.getChild(node, 0), vars);
+        PlTerm domain;
+        for(std::uint32_t i = 1; i + 1 < node.numChildren; i += 2) {
+            PlTerm min = buildRestriction(ast.getChild(node, i), vars);
+            PlTerm max = buildRestriction(ast.getChild(node, i + 1), vars);
+            PlTerm interval = PlCompound(DOMAIN_MIDDLE, PlTermv(min, max));
+            //PlTerm::operator= unifies, PL_put_term is used to make the reference point to the new term
+            if (i == 1) {
+                PL_put_term(domain.ref, interval.ref);
+            } else {
+                PL_put_term(domain.ref, PlCompound(DOMAIN_JOIN, PlTermv(domain, interval)).ref);
+            }
+        }
+        return PlCompound(DOMAIN_EQ, PlTermv(variable, domain));
+    }
+    default:
+        throw(std::runtime_error("PrologTermBuilder::buildRestriction(). VAR DOMAIN ERROR: NOT EVEN SIZE"));
+    }
+}
+
+PlTerm PrologTermBuilder::buildHead(const std::string & name, const PlTermv & vars) {
+    if (varNames.empty()) {
+        return PlAtom(name.c_str());
+    } else {
+        return PlCompound(name.c_str(), vars);
+    }
+}
+
+PlTerm PrologTermBuilder::buildLabeling(const PlTermv & vars, const LabelingStrategy & strategy) {
+    return strategy.buildLabeling(varNames, vars);
+}
+
+PlTerm PrologTermBuilder::buildClause(const std::string & name,
+                                      const std::vector<ConstraintAst::NodeId> & roots,
+                                      const PlTermv & vars)
+    throw(std::runtime_error)
+{
+    PlTerm body = buildLabeling(vars);
+    for(auto it = roots.rbegin(); it != roots.rend(); ++it) {
+        PL_put_term(body.ref, PlCompound(",", PlTermv(buildRestriction(*it, vars), body)).ref);
+    }
+    return PlCompound(":-", PlTermv(buildHead(name, vars), body));
+}
+
+const char* PrologTermBuilder::opToFunctor(BinaryOperation::BinaryOperators op) throw(std::runtime_error) {
+    switch (op) {
+    case BinaryOperation::add:
+        return ADD_STR;
+    case BinaryOperation::subtract:
+        return SUBS_STR;
+    case BinaryOperation::multiply:
+        return MULT_STR;
+    case BinaryOperation::divide:
+        return DIV_STR;
+    case BinaryOperation::module:
+        return MOD_STR;
+    default:
+        throw(std::runtime_error("PrologTermBuilder::opToFunctor(). Unknown arithmetic operation " + std::to_string((int) op)));
+    }
+}
+
+const char* PrologTermBuilder::boolOpToFunctor(Conjunction::BoolOperators op) {
+    if (op == Conjunction::predicate_and) {
+        return AND_STR;
+    } else {
+        return OR_STR;
+    }
+}
+
+const char* PrologTermBuilder::equalityOpToFunctor(Equality::ComparatorOp op) throw(std::runtime_error) {
+    switch (op) {
+    case Equality::not_equal:
+        return NOT_EQUALS_STR;
+    case Equality::equal:
+        return EQUALS_STR;
+    case Equality::bigger:
+        return BIGGER_STR;
+    case Equality::bigger_equal:
+        return BIGGER_EQ_STR;
+    case Equality::lesser:
+        return LESSER_STR;
+    case Equality::lesser_equal:
+        return LESSER_EQ_STR;
+    default:
+        throw(std::runtime_error("PrologTermBuilder::equalityOpToFunctor(). Unknown comparison " + std::to_string((int) op)));
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef PROLOGTERMBUILDER_H
+#define PROLOGTERMBUILDER_H
+
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define PL_SAFE_ARG_MACROS //define this flag so SWI-cpp macros dont colide with boost one
+#include <SWI-cpp.h>
+
+#include <fluidicmachinemodel/machine_graph_utils/variablenominator.h>
+#include <fluidicmachinemodel/rules/conjunction.h>
+#include <fluidicmachinemodel/rules/arithmetic/binaryoperation.h>
+#include <fluidicmachinemodel/rules/arithmetic/unaryoperation.h>
+#include <fluidicmachinemodel/rules/equality.h>
+
+#include "constraintengine/constraintast.h"
+#include "constraintengine/labelingstrategy.h"
+#include "constraintengine/prologtranslationstack.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The PrologTermBuilder class builds SWI-Prolog terms directly from a ConstraintAst.
+ *
+ * The PrologTermBuilder class creates the same clause that PrologTranslationStack writes as text, but as a term in the stacks of the
+ * swi-prolog interpreter, so it can be asserted without generating and parsing the text of the program. The variables of the machine
+ * are represented by a vector of fresh prolog variables ordered by position, the same order of the arguments of the predicate.
+ *
+ * The terms are created in the engine of the calling thread, so an engine must be attached and the terms are only valid inside the
+ * frame where they were built.
+ *
+ * @sa ConstraintAst, @sa PrologTranslationStack
+ */
+class PROLOGTERMBUILDER_EXPORT PrologTermBuilder
+{
+public:
+    /**
+     * @brief PrologTermBuilder creates a new builder for the restrictions of a tree.
+     * @param ast tree with the restrictions, must outlive the builder.
+     * @param varNames names of the variables of the predicate, ordered by position.
+     */
+    PrologTermBuilder(const ConstraintAst & ast, const std::vector<std::string> & varNames);
+    virtual ~PrologTermBuilder();
+
+    /**
+     * @brief buildRestriction builds the term of a restriction.
+     * @param root id of the root node of the restriction.
+     * @param vars prolog variables of the machine, ordered by position.
+     * @return the term of the restriction.
+     */
+    PlTerm buildRestriction(ConstraintAst::NodeId root, const PlTermv & vars) throw(std::runtime_error);
+    /**
+     * @brief buildHead builds the head of the predicate: name(Var1, Var2, ...).
+     * @param name name of the predicate.
+     * @param vars prolog variables of the machine, ordered by position.
+     * @return the head term.
+     */
+    PlTerm buildHead(const std::string & name, const PlTermv & vars);
+    /**
+     * @brief buildLabeling builds the labeling goal that minimizes the number of pumps and valves in use, the same goal
+     * written by PrologTranslationStack::generateLabelingFoot().
+     * @param vars prolog variables of the machine, ordered by position.
+     * @param strategy how the labeling searches, the default strategy if not given.
+     * @return the labeling goal.
+     */
+    PlTerm buildLabeling(const PlTermv & vars, const LabelingStrategy & strategy = LabelingStrategy());
+    /**
+     * @brief buildClause builds the whole clause: head :- restriction1, restriction2, ..., labeling.
+     * @param name name of the predicate.
+     * @param roots id of the root node of every restriction.
+     * @param vars prolog variables of the machine, ordered by position.
+     * @return the clause term.
+     */
+    PlTerm buildClause(const std::string & name, const std::vector<ConstraintAst::NodeId> & roots, const PlTermv & vars)
+        throw(std::runtime_error);
+
+protected:
+    /**
+     * @brief ast tree with the restrictions.
+     */
+    const ConstraintAst & ast;
+    /**
+     * @brief varNames names of the variables of the predicate, ordered by position.
+     */
+    std::vector<std::string> varNames;
+    /**
+     * @brief varPositions position in the predicate of every variable of the tree, indexed by the id of the variable in the tree.
+     */
+    std::vector<int> varPositions;
+
+    /**
+     * @brief opToFunctor returns the name of the functor of an arithmetic operation.
+     */
+    const char* opToFunctor(BinaryOperation::BinaryOperators op) throw(std::runtime_error);
+    /**
+     * @brief boolOpToFunctor returns the name of the functor of a boolean operation.
+     */
+    const char* boolOpToFunctor(Conjunction::BoolOperators op);
+    /**
+     * @brief equalityOpToFunctor returns the name of the functor of a comparison.
+     */
+    const char* equalityOpToFunctor(Equality::ComparatorOp op) throw(std::runtime_error);
+};
+
+#endif // PROLOGTERMBUILDER_H
@@ -0,0 +1,22 @@
+#include "prologtermtranslationstack.h"
+
+PrologTermTranslationStack::PrologTermTranslationStack() :
+    AstTranslationStack()
+{
+
+}
+
+PrologTermTranslationStack::~PrologTermTranslationStack() {
+
+}
+
+RoutingEngine* PrologTermTranslationStack::getRoutingEngine() {
+    prepareRestrictions();
+    PrologExecutor* routingEngine = new PrologExecutor(ast, restrictions, getVariableTable());
+    return routingEngine;
+}
+
+IncrementalPrologExecutor* PrologTermTranslationStack::getIncrementalRoutingEngine() {
+    prepareRestrictions();
+    return new IncrementalPrologExecutor(ast, restrictions, varTable);
+}
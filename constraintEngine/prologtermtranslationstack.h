@@ -0,0 +1,53 @@
+#ifndef PROLOGTERMTRANSLATIONSTACK_H
+#define PROLOGTERMTRANSLATIONSTACK_H
+
+#include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+
+#include "constraintengine/asttranslationstack.h"
+#include "constraintengine/incrementalprologexecutor.h"
+#include "constraintengine/prologexecutor.h"
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The PrologTermTranslationStack class translates a set of abstract rules to a prolog predicate without generating its text.
+ *
+ * The PrologTermTranslationStack class keeps the translated rules as a ConstraintAst, and getRoutingEngine() hands the tree directly
+ * to a new PrologExecutor, that builds the clause of the predicate as swi-prolog terms and asserts it. Neither the text of the program
+ * nor the prolog parser are involved, so the cost of the translation grows linearly with the size of the rules.
+ *
+ * The predicate created is the same as the one created by PrologTranslationStack.
+ *
+ * @sa AstTranslationStack, @sa PrologTranslationStack, @sa PrologTermBuilder
+ */
+class PROLOGTERMTRANSLATIONSTACK_EXPORT PrologTermTranslationStack : public AstTranslationStack
+{
+public:
+    /**
+     * @brief PrologTermTranslationStack creates a new stack
+     */
+    PrologTermTranslationStack();
+    /**
+     * @brief ~PrologTermTranslationStack destroys the stack
+     */
+    virtual ~PrologTermTranslationStack();
+
+    /**
+     * @brief getRoutingEngine creates a new PrologExecutor from the translated tree.
+     * @return a pointer to the newly created PrologExecutor
+     *
+     * @sa PrologExecutor
+     */
+    virtual RoutingEngine* getRoutingEngine();
+    /**
+     * @brief getIncrementalRoutingEngine creates a new IncrementalPrologExecutor from the translated tree, each translated restriction
+     * becomes a restriction of the executor that can be removed or replaced later, its id is returned by getRestrictionIds() of the
+     * executor in the same order as getRestrictionRoots().
+     * @return a pointer to the newly created IncrementalPrologExecutor
+     *
+     * @sa IncrementalPrologExecutor
+     */
+    IncrementalPrologExecutor* getIncrementalRoutingEngine();
+};
+
+#endif // PROLOGTERMTRANSLATIONSTACK_H
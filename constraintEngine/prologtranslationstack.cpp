@@ -1,207 +1,318 @@
 #include "prologtranslationstack.h"
 
-PrologTranslationStack::PrologTranslationStack() {
-
+PrologTranslationStack::PrologTranslationStack() :
+    AstTranslationStack()
+{
+    this->decompose = false;
+    this->componentThreads = 1;
+    this->streaming = false;
+    this->numStreamed = 0;
 }
 
 PrologTranslationStack::~PrologTranslationStack() {
 
 }
 
-void PrologTranslationStack::pop() {
-    stack.pop();
-}
+RoutingEngine* PrologTranslationStack::getRoutingEngine() {
+    if (streaming) {
+        return finishStreaming();
+    }
 
-void PrologTranslationStack::clear() {
-    while(!stack.empty()) {
-        stack.pop();
+    prepareRestrictions();
+    if (!compiledCacheDir.empty()) {
+        return createCachedExecutor();
     }
+
+    std::string program = generateProgram();
+
+    if (!programDumpFile.empty()) {
+        dumpProgram(program);
+    }
+
+    PrologExecutor* routingEngine = new PrologExecutor(program, getVariableTable());
+    return routingEngine;
 }
 
 void PrologTranslationStack::addHeadToRestrictions() {
-    actualRestriction.push_back(stack.top());
-    stack.pop();
+    AstTranslationStack::addHeadToRestrictions();
+    if (streaming) {
+        streamRestrictions();
+    }
 }
 
-void PrologTranslationStack::stackVariable(const std::string & name) {
-    stack.push(std::string(name));
-    varTable.insert(name);
+void PrologTranslationStack::clear() {
+    AstTranslationStack::clear();
+    if (streaming) {
+        //the streamed restrictions only live at the program, so its variables go with it
+        restrictions.clear();
+        ast.clear();
+        varTable.clear();
+        variablesBuilt = false;
+    }
+    callsSink.reset();
+    callsFile.reset();
+    streamSink.reset();
+    streamFile.reset();
+    streamedProgram.reset();
+    numStreamed = 0;
 }
 
-void PrologTranslationStack::stackNumber(int value) {
-    stack.push(std::to_string(value));
-}
+void PrologTranslationStack::streamRestrictions() throw(std::runtime_error) {
+    if (streamedProgram) {
+        throw(std::runtime_error("PrologTranslationStack::streamRestrictions(). The streamed program is finished, clear() must be called before translating other restrictions"));
+    }
+    if (!streamSink) {
+        streamFile = std::unique_ptr<QTemporaryFile>(new QTemporaryFile());
+        callsFile = std::unique_ptr<QTemporaryFile>(new QTemporaryFile());
+        if (!streamFile->open() || !callsFile->open()) {
+            throw(std::runtime_error("PrologTranslationStack::streamRestrictions(). Impossible to create the temporary files of the program"));
+        }
+        streamSink = std::unique_ptr<ProgramSink>(new ProgramSink(streamFile.get()));
+        callsSink = std::unique_ptr<ProgramSink>(new ProgramSink(callsFile.get()));
+        streamSink->write(":- use_module(library(clpfd)).\n\n");
+        numStreamed = 0;
+    }
 
-void PrologTranslationStack::stackArithmeticBinaryOperation(int arithmeticOp) {
-    std::string right = stack.top();
-    stack.pop();
-    std::string left = stack.top();
-    stack.pop();
+    //the nodes at the stack live in the same arena, it can only be released once they are finished
+    if (!stack.empty()) {
+        return;
+    }
 
-    std::string newRestriction = "(" + left + " " + opToStr((BinaryOperation::BinaryOperators)arithmeticOp) + " " + right + ")";
-    stack.push(newRestriction);
+    std::string text;
+    for(ConstraintAst::NodeId root: restrictions) {
+        std::set<std::string> vars;
+        collectVariableNames(root, vars);
+
+        text.clear();
+        if (vars.empty()) {
+            //without variables there are no arguments, the restriction is called in place
+            appendRestriction(root, 0, text);
+            text += ",\n";
+            callsSink->write(text);
+        } else {
+            std::string head = generateMethodHeather(RESTRICTION_PREDICATE_NAME + std::to_string(numStreamed++), vars);
+            text += head;
+            text += "\n";
+            appendRestriction(root, 0, text);
+            text += ".\n\n";
+            streamSink->write(text);
+
+            //the head without the trailing ":-"
+            callsSink->write(head.substr(0, head.size() - 2) + ",\n");
+        }
+    }
+    restrictions.clear();
+    ast.clearNodes();
 }
 
-void PrologTranslationStack::stackArithmeticUnaryOperation(int unaryOp) {
-    std::string operand = stack.top();
-    stack.pop();
+PrologExecutor* PrologTranslationStack::finishStreaming() throw(std::runtime_error) {
+    if (!streamedProgram) {
+        streamRestrictions();
 
-    std::tuple<std::string, std::string> tuple = unaryOpToStr((RuleUnaryOperation::UnaryOperators) unaryOp);
-    std::string newRestriction = "(" + std::get<0>(tuple) + operand + std::get<1>(tuple) + ")";
-    stack.push(newRestriction);
-}
+        streamSink->write(generateMethodHeather());
+        streamSink->write("\n");
 
-void PrologTranslationStack::stackEquality(int op) {
-    std::string right = stack.top();
-    stack.pop();
-    std::string left = stack.top();
-    stack.pop();
-    std::string opStr = equalityOPtoStr((Equality::ComparatorOp) op);
+        callsSink->flush();
+        callsFile->seek(0);
+        while (!callsFile->atEnd()) {
+            QByteArray chunk = callsFile->read(PROGRAM_SINK_BUFFER_SIZE);
+            streamSink->write(chunk.constData(), (std::size_t) chunk.size());
+        }
+        streamSink->write(generateLabelingFoot());
+        streamSink->write("\n");
+        streamSink->flush();
+
+        callsSink.reset();
+        callsFile.reset();
+        streamSink.reset();
+        streamFile->close();
+        streamedProgram = std::move(streamFile);
+    }
 
-    std::string newRestriction = "(" + left + " " + opStr + " " + right + ")";
-    stack.push(newRestriction);
+    //every executor deletes its file when it is destroyed
+    return new PrologExecutor(copyStreamedProgram(), getVariableTable());
 }
 
-void PrologTranslationStack::stackBooleanConjuction(int booleanOp) {
-    std::string right = stack.top();
-    stack.pop();
-    std::string left = stack.top();
-    stack.pop();
-
-    if ((Conjunction::BoolOperators) booleanOp == Conjunction::predicate_and) {
-        std::string newRestriction = "(" + left + " " + boolOpToStr((Conjunction::BoolOperators)booleanOp) + "\n" + right + ")";
-        stack.push(newRestriction);
-    } else {
-        std::string newRestriction = "(\n" + tabulateString(left) + " \n" + boolOpToStr((Conjunction::BoolOperators)booleanOp) + "\n"
-                + tabulateString(right) + "\n)";
-        stack.push(newRestriction);
+std::unique_ptr<QTemporaryFile> PrologTranslationStack::copyStreamedProgram() const throw(std::runtime_error) {
+    std::unique_ptr<QTemporaryFile> copy(new QTemporaryFile());
+    if (!streamedProgram->open() || !copy->open()) {
+        throw(std::runtime_error("PrologTranslationStack::copyStreamedProgram(). Impossible to create the temporary file of the program"));
+    }
+    while (!streamedProgram->atEnd()) {
+        QByteArray chunk = streamedProgram->read(PROGRAM_SINK_BUFFER_SIZE);
+        if (copy->write(chunk) != chunk.size()) {
+            streamedProgram->close();
+            throw(std::runtime_error("PrologTranslationStack::copyStreamedProgram(). Impossible to write the temporary file of the program"));
+        }
     }
+    streamedProgram->close();
+    copy->close();
+    return copy;
+}
 
+void PrologTranslationStack::collectVariableNames(ConstraintAst::NodeId root, std::set<std::string> & vars) const {
+    std::vector<ConstraintAst::NodeId> pending;
+    pending.push_back(root);
+    while (!pending.empty()) {
+        ConstraintAst::NodeId id = pending.back();
+        pending.pop_back();
+
+        const ConstraintAst::Node & node = ast.getNode(id);
+        if (node.kind == ConstraintAst::variable_node) {
+            vars.insert(ast.getVariableName((int) node.value));
+        } else {
+            for(std::uint32_t i = 0; i < node.numChildren; i++) {
+                pending.push_back(ast.getChild(node, i));
+            }
+        }
+    }
 }
 
-void PrologTranslationStack::stackImplication() {
-    std::string right = stack.top();
-    stack.pop();
-    std::string left = stack.top();
-    stack.pop();
+PrologExecutor* PrologTranslationStack::createCachedExecutor() throw(std::runtime_error) {
+    CompiledProgramCache cache(compiledCacheDir);
+    //the layout of the program is part of the key, the same rules give a different program when they are decomposed or labeled
+    //with another strategy
+    std::string layout = decompose ? "_components_" + std::to_string(componentThreads) : "";
+    if (labelingStrategy.toString() != LabelingStrategy().toString()) {
+        layout += "_labeling_" + labelingStrategy.toString();
+    }
+    std::string key = cache.makeKey(ast.hash(restrictions) + layout, varTable);
+
+    if (cache.contains(key)) {
+        try {
+            return new PrologExecutor(cache, key, std::string(), getVariableTable());
+        } catch (std::runtime_error & e) {
+            //compiled by another version or corrupted, it is compiled again
+            cache.remove(key);
+        }
+    }
 
-    std::string newRestriction = "(" + left + "==>" + right + ")";
-    stack.push(newRestriction);
+    std::string program = generateProgram();
+    if (!programDumpFile.empty()) {
+        dumpProgram(program);
+    }
+    return new PrologExecutor(cache, key, program, getVariableTable());
 }
 
-RoutingEngine* PrologTranslationStack::getRoutingEngine() {
-    std::unique_ptr<QTemporaryFile> file = std::make_unique<QTemporaryFile>(new QTemporaryFile());
+std::string PrologTranslationStack::generateProgram() {
+    prepareRestrictions();
+    if (decompose) {
+        return generateDecomposedProgram();
+    }
 
-    if (!file->open()) {
-        throw(std::runtime_error("impossible to create temporary file."));
+    std::string program = ":- use_module(library(clpfd)).\n\n";
+
+    program += generateMethodHeather();
+    program += "\n";
+    for(ConstraintAst::NodeId root: restrictions) {
+        appendRestriction(root, 0, program);
+        program += ",\n";
     }
-    QTextStream fout(file.get());
+    program += generateLabelingFoot();
+
+    return program;
+}
+
+std::string PrologTranslationStack::generateDecomposedProgram() {
+    std::string program = ":- use_module(library(clpfd)).\n\n";
+
+    ConstraintDecomposition decomposition(ast, restrictions, varTable);
+    const std::vector<ConstraintDecomposition::Component> & components = decomposition.getComponents();
 
-    fout << ":- use_module(library(clpfd))." << "\n";
-    fout << "\n";
+    std::vector<std::string> componentHeads;
+    for(std::size_t k = 0; k < components.size(); k++) {
+        const ConstraintDecomposition::Component & component = components[k];
 
-    std::string heather = generateMethodHeather();
-    fout << QString::fromStdString(heather) << "\n";
+        VariableTable componentVariables(component.varTable);
+        std::string componentHead = generateMethodHeather(COMPONENT_PREDICATE_NAME + std::to_string(k), componentVariables);
+        program += componentHead;
+        program += "\n";
+        for(ConstraintAst::NodeId root: component.restrictions) {
+            appendRestriction(root, 0, program);
+            program += ",\n";
+        }
+        //the labeling is always the last goal, a component without pumps nor valves has nothing to minimize
+        if (hasLabelingVariables(componentVariables)) {
+            program += generateLabelingFoot(componentVariables);
+        } else {
+            program += "true.";
+        }
+        program += "\n\n";
 
-    for(auto it = actualRestriction.begin(); it != actualRestriction.end(); ++it) {
-        fout << QString::fromStdString(*it) << "," << "\n";
+        //the head without the trailing ":-"
+        componentHeads.push_back(componentHead.substr(0, componentHead.size() - 2));
     }
-    fout << QString::fromStdString(generateLabelingFoot());
 
-    file->close();
+    program += generateMethodHeather();
+    program += "\nconstraint_engine:solve_components(" + std::to_string(componentThreads) + ", [";
+    for(std::size_t k = 0; k < componentHeads.size(); k++) {
+        if (k > 0) {
+            program += ",\n\t";
+        }
+        program += componentHeads[k];
+    }
+    program += "]).\n";
 
-    PrologExecutor* routingEngine = new PrologExecutor(std::move(file), varTable);
-    return routingEngine;
+    return program;
 }
 
-void PrologTranslationStack::stackVarDomain() {
-    std::stringstream stream;
-    std::string variable = stack.top();
-    stack.pop();
-
-    if((stack.size() % 2) == 0) {
-        stream << variable << " " << DOMAIN_EQ << " ";
-        while(stack.size() > 2) {
-            std::string max = stack.top();
-            stack.pop();
-            std::string min = stack.top();
-            stack.pop();
-            stream << DOMAIN_LEFT << min << " " << DOMAIN_MIDDLE << " " << max << DOMAIN_RIGHT << " " << DOMAIN_JOIN << " ";
-        }
-        std::string max = stack.top();
-        stack.pop();
-        std::string min = stack.top();
-        stack.pop();
-        stream << DOMAIN_LEFT << min << " " << DOMAIN_MIDDLE << " " << max << DOMAIN_RIGHT;
-
-        stack.push(stream.str());
-    } else {
-        clear();
-        stack.push("VAR DOMAIN ERROR: NOT EVEN SIZE");
+const std::vector<std::string> & PrologTranslationStack::getTranslatedRestriction() const {
+    actualRestriction.clear();
+    actualRestriction.reserve(restrictions.size());
+    for(ConstraintAst::NodeId root: restrictions) {
+        std::string text;
+        appendRestriction(root, 0, text);
+        actualRestriction.push_back(std::move(text));
+    }
+    return actualRestriction;
+}
+
+void PrologTranslationStack::dumpProgram(const std::string & program) {
+    QFile file(QString::fromStdString(programDumpFile));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw(std::runtime_error("impossible to create program dump file " + programDumpFile));
     }
+    file.write(program.data(), program.size());
+    file.close();
+}
+
+RoutingEngine* PrologTranslationStack::getRoutingEnginePool(unsigned int numThreads) {
+    PrologExecutor* executor = static_cast<PrologExecutor*>(getRoutingEngine());
+    return new PrologExecutorPool(executor, numThreads);
 }
 
 std::string PrologTranslationStack::generateMethodHeather() {
-    std::stringstream stream;
-    stream << "stackAutoPredicate(";
+    return generateMethodHeather(PREDICATE_NAME, getVariableTable());
+}
 
-    if (!varTable.empty()) {
-        auto it = varTable.begin();
-        stream << *it;
-        ++it;
+std::string PrologTranslationStack::generateMethodHeather(const std::string & name, const VariableTable & vars) {
+    std::stringstream stream;
+    stream << name << "(";
 
-        for(; it != varTable.end(); ++it) {
-            stream << "," << *it;
+    for(int id = 0; id < vars.size(); id++) {
+        if (id > 0) {
+            stream << ",";
         }
+        stream << vars.getName(id);
     }
     stream << "):-";
 
     return stream.str();
 }
 
-std::string PrologTranslationStack::generateLabelingFoot() {
-    std::stringstream streamMin;
-    std::stringstream streamName;
-    streamMin << "once(labeling([ff,min(";
-    streamName << "[";
-
-    bool lastWasPump = false;
-    bool lastWasValve = false;
-    for(const std::string & var: varTable) {
-        VariableNominator::VariableType type = VariableNominator::getVariableType(var);
-        if (type == VariableNominator::pump) {
-            if (lastWasPump) {
-                streamMin << " + ";
-                streamName << ",";
-            } else {
-                lastWasPump = true;
-            }
-            streamMin << "abs(" << var << ")";
-            streamName << var;
-        } else if (type == VariableNominator::valve) {
-            if (lastWasPump) {
-                streamMin << "), min(";
-                streamName << ",";
-                lastWasPump = false;
-            }
+bool PrologTranslationStack::hasLabelingVariables(const VariableTable & vars) {
+    return !vars.getLabelingIds().empty();
+}
 
-            if (lastWasValve) {
-                streamMin << " + ";
-                streamName << ",";
-            } else {
-                lastWasValve = true;
-            }
-            streamMin  << "min(" << var << ", 1)";
-            streamName << var;
-        }
-    }
-    streamMin << ")]";
-    streamName << "])).";
+std::string PrologTranslationStack::generateLabelingFoot() {
+    return generateLabelingFoot(getVariableTable());
+}
 
-    return streamMin.str() + "," + streamName.str();
+std::string PrologTranslationStack::generateLabelingFoot(const VariableTable & vars) {
+    return labelingStrategy.generateLabeling(vars) + ".";
 }
 
-std::string PrologTranslationStack::opToStr(BinaryOperation::BinaryOperators op) {
+std::string PrologTranslationStack::opToStr(BinaryOperation::BinaryOperators op) const {
     std::string str;
     switch (op) {
     case BinaryOperation::add:
@@ -226,7 +337,7 @@ std::string PrologTranslationStack::opToStr(BinaryOperation::BinaryOperators op)
     return str;
 }
 
-std::string PrologTranslationStack::boolOpToStr(Conjunction::BoolOperators op) {
+std::string PrologTranslationStack::boolOpToStr(Conjunction::BoolOperators op) const {
     std::string str;
     switch (op) {
     case BinaryOperation::add:
@@ -242,7 +353,7 @@ std::string PrologTranslationStack::boolOpToStr(Conjunction::BoolOperators op) {
     return str;
 }
 
-std::tuple<std::string,std::string> PrologTranslationStack::unaryOpToStr(RuleUnaryOperation::UnaryOperators op) {
+std::tuple<std::string,std::string> PrologTranslationStack::unaryOpToStr(RuleUnaryOperation::UnaryOperators op) const {
     std::string left = "";
     std::string right = "";
 
@@ -257,7 +368,7 @@ std::tuple<std::string,std::string> PrologTranslationStack::unaryOpToStr(RuleUna
     return std::make_tuple(left, right);
 }
 
-std::string PrologTranslationStack::equalityOPtoStr(Equality::ComparatorOp op) {
+std::string PrologTranslationStack::equalityOPtoStr(Equality::ComparatorOp op) const {
     std::string str = "";
     switch (op) {
     case Equality::not_equal:
@@ -284,16 +395,88 @@ std::string PrologTranslationStack::equalityOPtoStr(Equality::ComparatorOp op) {
     return str;
 }
 
-std::string PrologTranslationStack::tabulateString(const std::string & str) {
-    std::string formattedStr = "";
+void PrologTranslationStack::appendRestriction(ConstraintAst::NodeId id, int depth, std::string & out) const {
+    const ConstraintAst::Node & node = ast.getNode(id);
 
-    std::size_t pos = str.find('\n');
-    if (pos == std::string::npos) {
-        formattedStr = "\t" + str;
-    } else {
-        std::string chunkBefore = str.substr(0, pos + 1);
-        std::string chunkAfter = str.substr(pos +1);
-        formattedStr = "\t" + chunkBefore + tabulateString(chunkAfter);
+    switch (node.kind) {
+    case ConstraintAst::variable_node:
+        out += ast.getVariableName((int) node.value);
+        break;
+    case ConstraintAst::number_node:
+        out += std::to_string(node.value);
+        break;
+    case ConstraintAst::binary_node:
+        out += "(";
+        appendRestriction(ast.getChild(node, 0), depth, out);
+        out += " " + opToStr((BinaryOperation::BinaryOperators) node.op) + " ";
+        appendRestriction(ast.getChild(node, 1), depth, out);
+        out += ")";
+        break;
+    case ConstraintAst::unary_node: {
+        std::tuple<std::string, std::string> tuple = unaryOpToStr((RuleUnaryOperation::UnaryOperators) node.op);
+        out += "(" + std::get<0>(tuple);
+        appendRestriction(ast.getChild(node, 0), depth, out);
+        out += std::get<1>(tuple) + ")";
+        break;
+    }
+    case ConstraintAst::equality_node:
+        out += "(";
+        appendRestriction(ast.getChild(node, 0), depth, out);
+        out += " " + equalityOPtoStr((Equality::ComparatorOp) node.op) + " ";
+        appendRestriction(ast.getChild(node, 1), depth, out);
+        out += ")";
+        break;
+    case ConstraintAst::conjunction_node:
+        if ((Conjunction::BoolOperators) node.op == Conjunction::predicate_and) {
+            out += "(";
+            appendRestriction(ast.getChild(node, 0), depth, out);
+            out += " " + boolOpToStr((Conjunction::BoolOperators) node.op);
+            appendNewLine(depth, out);
+            appendRestriction(ast.getChild(node, 1), depth, out);
+            out += ")";
+        } else {
+            out += "(";
+            appendNewLine(depth, out);
+            out += "\t";
+            appendRestriction(ast.getChild(node, 0), depth + 1, out);
+            out += " ";
+            appendNewLine(depth, out);
+            out += boolOpToStr((Conjunction::BoolOperators) node.op);
+            appendNewLine(depth, out);
+            out += "\t";
+            appendRestriction(ast.getChild(node, 1), depth + 1, out);
+            appendNewLine(depth, out);
+            out += ")";
+        }
+        break;
+    case ConstraintAst::implication_node:
+        out += "(";
+        appendRestriction(ast.getChild(node, 0), depth, out);
+        out += " " IMPLICATION_STR " ";
+        appendRestriction(ast.getChild(node, 1), depth, out);
+        out += ")";
+        break;
+    case ConstraintAst::domain_node:
+        appendRestriction(ast.getChild(node, 0), depth, out);
+        out += " " DOMAIN_EQ " ";
+        for(std::uint32_t i = 1; i + 1 < node.numChildren; i += 2) {
+            if (i > 1) {
+                out += " " DOMAIN_JOIN " ";
+            }
+            out += DOMAIN_LEFT;
+            appendRestriction(ast.getChild(node, i), depth, out);
+            out += " " DOMAIN_MIDDLE " ";
+            appendRestriction(ast.getChild(node, i + 1), depth, out);
+            out += DOMAIN_RIGHT;
+        }
+        break;
+    default:
+        out += "VAR DOMAIN ERROR: NOT EVEN SIZE";
+        break;
     }
-    return formattedStr;
+}
+
+void PrologTranslationStack::appendNewLine(int depth, std::string & out) const {
+    out += "\n";
+    out.append(depth, '\t');
 }
@@ -7,6 +7,7 @@
 #define DIV_STR "//"
 #define AND_STR "#/\\"
 #define OR_STR "#\\/"
+#define IMPLICATION_STR "#==>"
 #define MOD_STR "rem"
 #define ABS_LEFT_STR "abs("
 #define ABS_RIGHT_STR ")"
@@ -22,9 +23,10 @@
 #define BIGGER_EQ_STR "#>="
 #define LESSER_EQ_STR "#=<"
 
-#include <stack>
+#include <algorithm>
 #include <string>
 #include <sstream>
+#include <memory>
 #include <set>
 
 #include <QString>
@@ -39,7 +41,13 @@
 #include <fluidicmachinemodel/rules/arithmetic/unaryoperation.h>
 #include <fluidicmachinemodel/rules/equality.h>
 
+#include "constraintengine/asttranslationstack.h"
+#include "constraintengine/compiledprogramcache.h"
+#include "constraintengine/constraintdecomposition.h"
+#include "constraintengine/labelingstrategy.h"
+#include "constraintengine/programsink.h"
 #include "constraintengine/prologexecutor.h"
+#include "constraintengine/prologexecutorpool.h"
 
 #include "constraintengine/constraintsenginelibrary_global.h"
 
@@ -50,11 +58,13 @@
  * set of rules to a prolog file containing a predicate that the swi-prolog interpreter can use to solve the constraint problem specified
  * by the rules.
  *
- * Internally a Pushdown automaton is used to translate the rules, each trasnlated rules is represented as a string.
+ * Internally a Pushdown automaton is used to translate the rules, the translation is done by AstTranslationStack so each translated
+ * rule is represented as a tree in a ConstraintAst arena. The text of the rules is only generated once, in a single linear pass over
+ * the trees, when getRoutingEngine() or getTranslatedRestriction() are called.
  *
- * @sa TranslationStack
+ * @sa TranslationStack, @sa AstTranslationStack
  */
-class PROLOGTRANSLATIONSTACK_EXPORT PrologTranslationStack : public TranslationStack
+class PROLOGTRANSLATIONSTACK_EXPORT PrologTranslationStack : public AstTranslationStack
 {
 public:
     /**
@@ -67,143 +77,239 @@ public:
     virtual ~PrologTranslationStack();
 
     /**
-     * @brief pop removes the top of the stack
-     */
-    virtual void pop();
-    /**
-     * @brief clears the stack
+     * @brief getRoutingEngine creates a new PrologExecutor.
+     *
+     * The program is generated in memory and loaded directly by the PrologExecutor, nothing is written to the filesystem unless
+     * a dump file has been set with setProgramDumpFile() or a compiled program cache with setCompiledCacheDir(). With a cache, the
+     * compiled program of the same restrictions is loaded without generating the text again.
+     *
+     * @return a pointer to the newly created PrologExecutor
+     *
+     * @sa PrologExecutor
      */
-    virtual void clear();
+    virtual RoutingEngine* getRoutingEngine();
     /**
-     * @brief addHeadToRestrictions adds a new string to the actualrestriction vector
+     * @brief addHeadToRestrictions adds the node at the top of the stack to the restrictions, in streaming mode the finished
+     * restrictions are written to the program and released.
      *
-     * addHeadToRestrictions gets the string at the top of the stack, adds it to the actualrestriction vector,
-     * and remove it from the stack.
+     * @sa setStreaming
      */
     virtual void addHeadToRestrictions();
     /**
-     * @brief stackVariable adds to the top of the stack a new string with the name of a variable, also adds this
-     * variable to the variable table.
+     * @brief clear clears the stack, in streaming mode the streamed program, with its restrictions and variables, is also discarded so
+     * another machine can be translated.
+     */
+    virtual void clear();
+    /**
+     * @brief getRoutingEnginePool creates a new PrologExecutor and wraps it in a PrologExecutorPool, so the route calculations
+     * can be solved in parallel by several swi-prolog engines.
      *
-     * @param name name of the variable to be stack
+     * @param numThreads number of worker threads of the pool, if 0 the number of cores of the machine is used.
+     * @return a pointer to the newly created PrologExecutorPool
+     *
+     * @sa PrologExecutorPool
      */
-    virtual void stackVariable(const std::string & name);
+    RoutingEngine* getRoutingEnginePool(unsigned int numThreads = 0);
+
     /**
-     * @brief stackNumber adds to the top of the stack a new string with an integer value
-     * @param value integer value to be stacked.
+     * @brief generateProgram generates the whole prolog program: the clpfd import, the head of the rule, the translated restrictions
+     * and the labeling instruction. If the decomposition is enabled the program of generateDecomposedProgram() is returned.
+     * @return a string with the text of the program.
      */
-    virtual void stackNumber(int value);
+    std::string generateProgram();
     /**
-     * @brief stackArithmeticBinaryOperation removes the top of the stack and the string below it,
-     * creates a new string that contains both strings join with the corresponding numerical
-     * operator(+,-,*,...etc). Adds this new created string to the top of the stack.
+     * @brief generateDecomposedProgram generates a program with a predicate for every independent group of restrictions.
      *
-     * @param arithmeticOp integer value that represents the numerical operation used, this operations
-     * are available in BinaryOperation::BinaryOperator from the class BinaryOperation of the
-     * FluidicMachineModel library.
+     * The restrictions are split by ConstraintDecomposition, every component gets its own predicate, stackAutoComponent0,
+     * stackAutoComponent1..., with its variables, its restrictions and the labeling of its pumps and valves. The predicate of the
+     * machine keeps the same head and solves all the components with constraint_engine:solve_components/2, so the executor
+     * is used as with the single predicate program.
+     *
+     * @return a string with the text of the program.
      *
-     * @sa BinaryOperation
+     * @sa ConstraintDecomposition, @sa setDecomposition
      */
-    virtual void stackArithmeticBinaryOperation(int arithmeticOp);
+    std::string generateDecomposedProgram();
     /**
-     * @brief stackArithmeticUnaryOperation removes the string at the top of the stack, creates a new
-     * string that contains: the just removed string and the corresponding unary operation(absolute value...etc).
-     * Adds the newly created string to the top of the stack.
-     *
-     * @param unaryOp integer value that represents the unary operation to be applied, these operations are avialable
-     * in UnaryOperation::UnaryOperators from the UnaryOperation class of the FluidicMachineModel library.
+     * @brief generateMethodHeather generates the Head of the prolog rule with the variables in the varTable.
+     * @return a string containing the head of the rule.
      *
-     * @sa UnaryOperation
+     * @sa varTable
      */
-    virtual void stackArithmeticUnaryOperation(int unaryOp);
+    std::string generateMethodHeather();
     /**
-     * @brief stackEquality removes two string from the top of the stack, creates a new string that contains: the top
-     * string the corresponding comparation operation(=,<,>,!=...) and the string below the top. Adds this new string to
-     * the top of the stack.
-     *
-     * @param op integer value that represents the comparation operation to be applied. The avialable comparation operations are
-     * available in Equality::ComparatorOp from the Equality class of the FluidicMachineModel library.
-     *
-     * @sa Equality
+     * @brief generateMethodHeather generates the head of a rule with a name and a set of variables.
+     * @param name name of the predicate.
+     * @param vars variables of the rule, a std::set of names can also be given.
+     * @return a string containing the head of the rule.
      */
-    virtual void stackEquality(int op);
+    std::string generateMethodHeather(const std::string & name, const VariableTable & vars);
     /**
-     * @brief stackBooleanConjuction removes two string from the top of the stack, creates a new string that contains: the top
-     * string, the corresponding boolean operation(and,or,...) and the string below the top. Adds this new string to
-     * the top of the stack.
+     * @brief generateLabelingFoot generates a labeling instruction at the end of the prolog rule body. This instruction is necesary by the clpfd library
+     * to minimize the number of pumps and valves used to mantain a set of flows.
      *
-     * @param booleanOp op integer value that represents the boolean operation to be applied. The avialable boolean operations are
-     * available in BinaryOperation::BinaryOperators from the BinaryOperation class of the FluidicMachineModel library.
+     * @return a string containing the minimization intsruction.
+     *
+     * @sa http://www.swi-prolog.org/pldoc/man?predicate=labeling/2
      */
-    virtual void stackBooleanConjuction(int booleanOp);
+    std::string generateLabelingFoot();
     /**
-     * @brief stackImplication deprecated, to be removed
+     * @brief generateLabelingFoot generates the labeling instruction for the pumps and valves of a set of variables, following the
+     * labeling strategy of the stack.
+     * @param vars variables of the rule, a std::set of names can also be given, at least one must be a pump or a valve.
+     * @return a string containing the minimization intsruction.
+     *
+     * @sa setLabelingStrategy
      */
-    virtual void stackImplication();
+    std::string generateLabelingFoot(const VariableTable & vars);
+
     /**
-     * @brief stackVarDomain creates a new variable domain for the given stack.
+     * @brief getTranslatedRestriction returns the text of every translated restriction.
      *
-     * stackVarDomain removes the top of the stack makes a new string that has the top of the stack and "in" token. The size of the stack must be
-     * even if not an error string is added to the top of the stack. A new string is made that contains all the variables of the stack in pairs of two
-     * joined by the token ".." between each member of a pair and with the token "\/" between each pair.
+     * The text is generated from the trees each time this method is called, it is not kept while the rules are being translated.
+     * The restrictions are not presolved by this method, they are shown presolved only once a RoutingEngine has been created with
+     * the presolve enabled.
      *
-     * For example for this stack [P_1,-2,-1,1,2] the method creates a stack like this: [P_1 in -2..-1 \/ 1..2].
+     * @return a constant reference to a vector with the text of each restriction, in order of translation, valid until the next call.
      */
-    virtual void stackVarDomain();
-
+    const std::vector<std::string> & getTranslatedRestriction() const;
     /**
-     * @brief getRoutingEngine creates a new PrologExecutor.
-     * @return a pointer to the newly created PrologExecutor
+     * @brief setProgramDumpFile sets a file where a copy of the generated program is written each time getRoutingEngine() is called,
+     * this is only useful for debugging.
+     * @param path path of the file to be written, an empty string disables the dump.
+     */
+    inline void setProgramDumpFile(const std::string & path) {
+        programDumpFile = path;
+    }
+    /**
+     * @brief setCompiledCacheDir sets a directory where the programs are kept compiled to the quick load format of swi-prolog,
+     * so a machine already loaded by a previous execution starts without consulting its program again.
+     * @param path path of the directory, created if it does not exist, an empty string disables the cache.
      *
-     * @sa PrologExecutor
+     * @sa CompiledProgramCache
      */
-    virtual RoutingEngine* getRoutingEngine();
-
+    inline void setCompiledCacheDir(const std::string & path) {
+        compiledCacheDir = path;
+    }
     /**
-     * @brief generateMethodHeather generates the Head of the prolog rule with the variables in the varTable.
-     * @return a string containing the head of the rule.
+     * @brief setDecomposition enables the generation of a predicate for every independent group of restrictions, disabled by default.
+     * @param enabled true to decompose the program.
+     * @param numThreads number of threads used to solve the components of a query at the same time, 1 solves them one after the
+     * other at the calling thread. Starting threads has a cost, so it is only worth for machines with big components.
      *
-     * @sa varTable
+     * @sa generateDecomposedProgram
      */
-    std::string generateMethodHeather();
+    inline void setDecomposition(bool enabled, unsigned int numThreads = 1) {
+        decompose = enabled;
+        componentThreads = std::max(1u, numThreads);
+    }
     /**
-     * @brief generateLabelingFoot generates a labeling instruction at the end of the prolog rule body. This instruction is necesary by the clpfd library
-     * to minimize the number of pumps and valves used to mantain a set of flows.
+     * @brief setLabelingStrategy sets how the labeling of the generated programs searches for a route, by default the pumps and then
+     * the valves are minimized with the first fail heuristic.
      *
-     * @return a string containing the minimization intsruction.
+     * The warm start of PrologExecutor bounds the objectives of the labeling generated by the strategy, so it can be used with any of
+     * them.
      *
-     * @sa http://www.swi-prolog.org/pldoc/man?predicate=labeling/2
+     * @sa LabelingStrategy
      */
-    std::string generateLabelingFoot();
-
-    inline const std::vector<std::string> & getTranslatedRestriction() const {
-        return actualRestriction;
+    inline void setLabelingStrategy(const LabelingStrategy & strategy) {
+        labelingStrategy = strategy;
+    }
+    inline const LabelingStrategy & getLabelingStrategy() const {
+        return labelingStrategy;
     }
     /**
-     * @brief getVarTable returns the varTable
-     * @return a constant reference to the varTable attribute.
+     * @brief setStreaming enables the streaming mode, disabled by default, it must be set before translating the rules.
      *
-     * @sa varTable
+     * In streaming mode every restriction is written to a temporary file as soon as it is translated and its nodes are released,
+     * so the memory needed to translate a machine is bounded by its biggest restriction instead of the whole program. Each
+     * restriction becomes a predicate, stackAutoRestriction0, stackAutoRestriction1..., with its own variables, and the calls to
+     * them are written to a second temporary file that becomes the body of the predicate of the machine when getRoutingEngine()
+     * is called for the first time. The finished program is kept, every call to getRoutingEngine() loads its own copy of it, and a
+     * runtime_error is thrown if more restrictions are added until clear() is called.
+     *
+     * The restrictions are not kept, so the presolve, the decomposition, the compiled program cache, the program dump and
+     * getTranslatedRestriction() are not available in streaming mode.
      */
-    inline const std::set<std::string> & getVarTable() const {
-        return varTable;
+    inline void setStreaming(bool enabled) {
+        streaming = enabled;
     }
 
  protected:
     /**
-     * @brief stack string stack that is used to translate the abstract rules
+     * @brief actualRestriction text of all the rules translated, only filled when getTranslatedRestriction() is invoked.
+     *
+     * @sa getTranslatedRestriction()
      */
-    std::stack<std::string> stack;
+    mutable std::vector<std::string> actualRestriction;
     /**
-     * @brief actualRestriction vector of strings with all the rules translated, this vector is fill when the method addHeadToRestrictions() is invoked.
-     *
-     * @sa addHeadToRestrictions()
+     * @brief programDumpFile path of the file where the generated program is written for debugging, empty if disabled.
      */
-    std::vector<std::string> actualRestriction;
+    std::string programDumpFile;
     /**
-     * @brief varTable set of strings that contains all the variables used in the rules.
+     * @brief compiledCacheDir path of the directory with the compiled programs, empty if disabled.
      */
-    std::set<std::string> varTable;
+    std::string compiledCacheDir;
+    /**
+     * @brief labelingStrategy how the labeling of the generated programs searches for a route.
+     */
+    LabelingStrategy labelingStrategy;
+    /**
+     * @brief decompose true if a predicate is generated for every independent group of restrictions.
+     */
+    bool decompose;
+    /**
+     * @brief componentThreads number of threads used to solve the components of a query.
+     */
+    unsigned int componentThreads;
+
+    /**
+     * @brief streaming true if the restrictions are written to the program as they are translated.
+     */
+    bool streaming;
+    /**
+     * @brief streamFile temporary file with the streamed program.
+     */
+    std::unique_ptr<QTemporaryFile> streamFile;
+    /**
+     * @brief callsFile temporary file with the calls to the predicates of the streamed restrictions.
+     */
+    std::unique_ptr<QTemporaryFile> callsFile;
+    std::unique_ptr<ProgramSink> streamSink;
+    std::unique_ptr<ProgramSink> callsSink;
+    /**
+     * @brief streamedProgram finished streamed program, NULL until the first executor is created.
+     */
+    std::unique_ptr<QTemporaryFile> streamedProgram;
+    /**
+     * @brief numStreamed number of predicates of restrictions written to the streamed program.
+     */
+    std::size_t numStreamed;
+
+    /**
+     * @brief streamRestrictions writes the translated restrictions to the streamed program and releases their nodes, nothing is
+     * done while the stack is not empty.
+     */
+    void streamRestrictions() throw(std::runtime_error);
+    /**
+     * @brief finishStreaming writes the predicate of the machine at the end of the streamed program the first time it is invoked,
+     * and loads a copy of the finished program.
+     */
+    PrologExecutor* finishStreaming() throw(std::runtime_error);
+    /**
+     * @brief copyStreamedProgram returns a new temporary file with the finished streamed program.
+     */
+    std::unique_ptr<QTemporaryFile> copyStreamedProgram() const throw(std::runtime_error);
+    /**
+     * @brief collectVariableNames inserts at vars the names of the variables used by a restriction.
+     */
+    void collectVariableNames(ConstraintAst::NodeId root, std::set<std::string> & vars) const;
+
+    /**
+     * @brief createCachedExecutor creates a PrologExecutor from the compiled program cache, the program is only generated and
+     * compiled if it is not at the cache or the compiled file can not be loaded.
+     */
+    PrologExecutor* createCachedExecutor() throw(std::runtime_error);
 
     /**
      * @brief opToStr returns the string that match the corresponding arithmetic operation.
@@ -213,7 +319,7 @@ public:
      * FluidicMachineModel library.
      * @return string that represents the corresponding operation.
      */
-    std::string opToStr(BinaryOperation::BinaryOperators op);
+    std::string opToStr(BinaryOperation::BinaryOperators op) const;
     /**
      * @brief boolOpToStr returns the string that match the corresponding boolean operation.
      *
@@ -222,7 +328,7 @@ public:
      * FluidicMachineModel library.
      * @return string that represents the corresponding operation.
      */
-    std::string boolOpToStr(Conjunction::BoolOperators op);
+    std::string boolOpToStr(Conjunction::BoolOperators op) const;
     /**
      * @brief unaryOpToStr returns a pair of string that represenst the corresponding unary operation.
      *
@@ -236,7 +342,7 @@ public:
      *
      * @return pair of strings that wraps the operand and represents the corresponding unary operation.
      */
-    std::tuple<std::string,std::string> unaryOpToStr(RuleUnaryOperation::UnaryOperators op);
+    std::tuple<std::string,std::string> unaryOpToStr(RuleUnaryOperation::UnaryOperators op) const;
     /**
      * @brief equalityOPtoStr returns the string that match the corresponding comparation operation.
      *
@@ -244,13 +350,32 @@ public:
      * are available in Equality::ComparatorOp from the class Equality of the FluidicMachineModel library.
      * @return string that represents the corresponding operation.
      */
-    std::string equalityOPtoStr(Equality::ComparatorOp op);
+    std::string equalityOPtoStr(Equality::ComparatorOp op) const;
+    /**
+     * @brief appendRestriction appends the text of a tree to a string.
+     *
+     * The text is the same the old string based stack generated: operations wrapped in parenthesis and the operands of the OR
+     * operations in their own tabulated lines, this is just for better visualition of a file. Instead of copying the text of the
+     * subtrees at every level, the tabulation is passed down as a depth and the text is appended to the same string.
+     *
+     * @param id id of the root node of the tree.
+     * @param depth number of tabulators to put after every new line.
+     * @param out string where the text is appended.
+     */
+    void appendRestriction(ConstraintAst::NodeId id, int depth, std::string & out) const;
+    /**
+     * @brief hasLabelingVariables returns true if any of the variables is a pump or a valve.
+     */
+    bool hasLabelingVariables(const VariableTable & vars);
+    /**
+     * @brief appendNewLine appends a new line followed by depth tabulators.
+     */
+    void appendNewLine(int depth, std::string & out) const;
     /**
-     * @brief tabulateString puts the correct tabulation in a string, this is just for better visualition of a file.
-     * @param str string to be tabulated.
-     * @return the string with the correspònding tabulators.
+     * @brief dumpProgram writes the program to programDumpFile.
+     * @param program text of the program.
      */
-    std::string tabulateString(const std::string & str);
+    void dumpProgram(const std::string & program);
 };
 
 #endif // PROLOGTRANSLATIONSTACK_H
@@ -0,0 +1,217 @@
+#include "routecache.h"
+
+#define ROUTE_CACHE_MAGIC 0x52434348
+#define ROUTE_CACHE_VERSION 1
+
+RouteCache::RouteCache(std::size_t capacity) {
+    this->capacity = capacity;
+    this->stats.hits = 0;
+    this->stats.misses = 0;
+    this->stats.evictions = 0;
+    this->stats.size = 0;
+    this->stats.capacity = capacity;
+}
+
+RouteCache::~RouteCache() {
+
+}
+
+bool RouteCache::lookup(const std::vector<int> & inputPositions,
+                        const std::vector<long long> & inputValues,
+                        bool & found,
+                        std::vector<long long> & outStates)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (capacity == 0) {
+        return false;
+    }
+
+    Key key = makeKey(inputPositions, inputValues);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        //move the entry to the front, it is the most recently used now
+        entries.splice(entries.begin(), entries, it->second);
+
+        const Entry & entry = *it->second;
+        found = entry.found;
+        if (found) {
+            outStates = entry.outStates;
+        }
+        stats.hits++;
+        return true;
+    } else {
+        stats.misses++;
+        return false;
+    }
+}
+
+void RouteCache::insert(const std::vector<int> & inputPositions,
+                        const std::vector<long long> & inputValues,
+                        bool found,
+                        const std::vector<long long> & outStates)
+{
+    Entry entry;
+    entry.key = makeKey(inputPositions, inputValues);
+    entry.found = found;
+    if (found) {
+        entry.outStates = outStates;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    insertEntry(std::move(entry));
+}
+
+void RouteCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    stats.size = 0;
+}
+
+void RouteCache::setCapacity(std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->capacity = capacity;
+    this->stats.capacity = capacity;
+    evict();
+}
+
+RouteCache::Stats RouteCache::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool RouteCache::saveToFile(const std::string & path, const std::string & machineHash) {
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    out << (std::uint32_t) ROUTE_CACHE_MAGIC;
+    out << (std::uint32_t) ROUTE_CACHE_VERSION;
+    out << QString::fromStdString(machineHash);
+    out << (std::uint64_t) entries.size();
+
+    //from the least to the most recently used, so loading the file in order keeps the same recency
+    for(auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        out << (std::uint32_t) it->key.size();
+        for(long long value: it->key) {
+            out << (std::int64_t) value;
+        }
+        out << it->found;
+        out << (std::uint32_t) it->outStates.size();
+        for(long long value: it->outStates) {
+            out << (std::int64_t) value;
+        }
+    }
+    file.close();
+    return out.status() == QDataStream::Ok;
+}
+
+bool RouteCache::loadFromFile(const std::string & path, const std::string & machineHash) {
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    std::uint32_t magic;
+    std::uint32_t version;
+    QString fileHash;
+    std::uint64_t numEntries;
+    in >> magic >> version >> fileHash >> numEntries;
+    if (in.status() != QDataStream::Ok ||
+        magic != ROUTE_CACHE_MAGIC ||
+        version != ROUTE_CACHE_VERSION ||
+        fileHash.toStdString() != machineHash)
+    {
+        return false;
+    }
+
+    std::vector<Entry> loaded;
+    for(std::uint64_t i = 0; i < numEntries && in.status() == QDataStream::Ok; i++) {
+        Entry entry;
+        std::uint32_t size;
+        std::int64_t value;
+
+        in >> size;
+        for(std::uint32_t j = 0; j < size && in.status() == QDataStream::Ok; j++) {
+            in >> value;
+            entry.key.push_back(value);
+        }
+        in >> entry.found;
+        in >> size;
+        for(std::uint32_t j = 0; j < size && in.status() == QDataStream::Ok; j++) {
+            in >> value;
+            entry.outStates.push_back(value);
+        }
+        loaded.push_back(std::move(entry));
+    }
+    file.close();
+
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for(Entry & entry: loaded) {
+        insertEntry(std::move(entry));
+    }
+    return true;
+}
+
+std::size_t RouteCache::KeyHash::operator()(const Key & key) const {
+    //FNV-1a over the values of the key
+    std::uint64_t hash = 14695981039346656037ULL;
+    for(long long value: key) {
+        hash ^= (std::uint64_t) value;
+        hash *= 1099511628211ULL;
+    }
+    return (std::size_t) hash;
+}
+
+RouteCache::Key RouteCache::makeKey(const std::vector<int> & inputPositions, const std::vector<long long> & inputValues) {
+    std::vector<std::pair<int, long long>> pairs;
+    pairs.reserve(inputPositions.size());
+    for(std::size_t i = 0; i < inputPositions.size(); i++) {
+        pairs.push_back(std::make_pair(inputPositions[i], inputValues[i]));
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    Key key;
+    key.reserve(2 * pairs.size());
+    for(const std::pair<int, long long> & pair: pairs) {
+        key.push_back(pair.first);
+        key.push_back(pair.second);
+    }
+    return key;
+}
+
+void RouteCache::insertEntry(Entry && entry) {
+    if (capacity == 0) {
+        return;
+    }
+
+    auto it = index.find(entry.key);
+    if (it != index.end()) {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    entries.push_front(std::move(entry));
+    index.insert(std::make_pair(entries.front().key, entries.begin()));
+    evict();
+    stats.size = entries.size();
+}
+
+void RouteCache::evict() {
+    while(entries.size() > capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+        stats.evictions++;
+    }
+    stats.size = entries.size();
+}
@@ -0,0 +1,181 @@
+#ifndef ROUTECACHE_H
+#define ROUTECACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QDataStream>
+#include <QFile>
+#include <QString>
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The RouteCache class is a bounded LRU cache with the results of previous route calculations.
+ *
+ * The result of a route calculation only depends on the grounded variables, because the labeling of the predicate is wrapped
+ * in once(...). The RouteCache class stores, for each set of grounded variables, the state calculated by the solver or the fact
+ * that no state was found, so repeated queries do not need to run the clpfd search again.
+ *
+ * The grounded variables are identified by their position in the predicate, the key is the list of (position, value) pairs sorted
+ * by position so the same input always produces the same key regardless of the order of the variables. When the cache is full
+ * the least recently used entry is removed.
+ *
+ * All the methods are thread safe. The cache can be saved to disk and loaded back, the file is tagged with a machine hash so a
+ * cache is never loaded into a different machine.
+ */
+class ROUTECACHE_EXPORT RouteCache
+{
+public:
+    /**
+     * @brief The Stats struct counters of the usage of the cache.
+     */
+    typedef struct Stats {
+        /**
+         * @brief hits number of lookups that found the key, including the ones whose result is "no solution".
+         */
+        unsigned long long hits;
+        /**
+         * @brief misses number of lookups that did not find the key.
+         */
+        unsigned long long misses;
+        /**
+         * @brief evictions number of entries removed because the cache was full.
+         */
+        unsigned long long evictions;
+        /**
+         * @brief size number of entries actually stored.
+         */
+        std::size_t size;
+        /**
+         * @brief capacity maximum number of entries.
+         */
+        std::size_t capacity;
+    } Stats;
+
+    /**
+     * @brief RouteCache creates an empty cache.
+     * @param capacity maximum number of entries, if 0 the cache stores nothing.
+     */
+    RouteCache(std::size_t capacity);
+    virtual ~RouteCache();
+
+    /**
+     * @brief lookup searches the result of a previous calculation with the same grounded variables.
+     *
+     * @param inputPositions positions of the grounded variables.
+     * @param inputValues values of the grounded variables, inputValues[i] is the value of the variable at inputPositions[i].
+     * @param found set to true if the stored result is a state of the machine, false if the stored result is "no solution".
+     * @param outStates filled with the stored state if found is true, intact otherwise.
+     * @return true if the key is in the cache, false otherwise.
+     */
+    bool lookup(const std::vector<int> & inputPositions,
+                const std::vector<long long> & inputValues,
+                bool & found,
+                std::vector<long long> & outStates);
+    /**
+     * @brief insert stores the result of a calculation, evicting the least recently used entry if the cache is full.
+     *
+     * @param inputPositions positions of the grounded variables.
+     * @param inputValues values of the grounded variables.
+     * @param found true if the solver found a state, false if there is no solution for the input.
+     * @param outStates state calculated by the solver, ignored if found is false.
+     */
+    void insert(const std::vector<int> & inputPositions,
+                const std::vector<long long> & inputValues,
+                bool found,
+                const std::vector<long long> & outStates);
+
+    /**
+     * @brief clear removes all the entries, the counters are not reset.
+     */
+    void clear();
+    /**
+     * @brief setCapacity changes the maximum number of entries, removing the least recently used ones if necessary.
+     * @param capacity maximum number of entries, if 0 the cache is emptied and stores nothing.
+     */
+    void setCapacity(std::size_t capacity);
+    /**
+     * @brief getStats returns the counters of the cache.
+     * @return a copy of the counters at this moment.
+     */
+    Stats getStats();
+
+    /**
+     * @brief saveToFile writes all the entries to a file, from the least to the most recently used.
+     * @param path path of the file to be written.
+     * @param machineHash identifier of the machine the results belongs to.
+     * @return true if the file was written, false otherwise.
+     */
+    bool saveToFile(const std::string & path, const std::string & machineHash);
+    /**
+     * @brief loadFromFile adds to the cache the entries of a file written by saveToFile.
+     * @param path path of the file to be read.
+     * @param machineHash identifier of the machine, the file is ignored if it was saved for another machine.
+     * @return true if the entries where loaded, false if the file does not exist, is corrupted or belongs to another machine.
+     */
+    bool loadFromFile(const std::string & path, const std::string & machineHash);
+
+protected:
+    /**
+     * @brief Key sorted (position, value) pairs of the grounded variables stored contiguously: pos0, value0, pos1, value1...
+     */
+    typedef std::vector<long long> Key;
+
+    /**
+     * @brief The KeyHash struct hash function for the Key type.
+     */
+    typedef struct KeyHash {
+        std::size_t operator()(const Key & key) const;
+    } KeyHash;
+
+    /**
+     * @brief The Entry struct a result stored in the cache.
+     */
+    typedef struct Entry {
+        Key key;
+        bool found;
+        std::vector<long long> outStates;
+    } Entry;
+
+    /**
+     * @brief capacity maximum number of entries.
+     */
+    std::size_t capacity;
+    /**
+     * @brief entries stored results, the most recently used at the front.
+     */
+    std::list<Entry> entries;
+    /**
+     * @brief index map from a key to its position at entries.
+     */
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    /**
+     * @brief stats counters of the usage of the cache.
+     */
+    Stats stats;
+    /**
+     * @brief mutex protects all the attributes.
+     */
+    std::mutex mutex;
+
+    /**
+     * @brief makeKey returns the canonical key of a set of grounded variables.
+     */
+    static Key makeKey(const std::vector<int> & inputPositions, const std::vector<long long> & inputValues);
+    /**
+     * @brief insertEntry adds an entry at the front of the list, the mutex must be locked.
+     */
+    void insertEntry(Entry && entry);
+    /**
+     * @brief evict removes the least recently used entries until the size is below the capacity, the mutex must be locked.
+     */
+    void evict();
+};
+
+#endif // ROUTECACHE_H
@@ -0,0 +1,112 @@
+#include "specializationtable.h"
+
+SpecializationTable::SpecializationTable(unsigned int threshold, std::size_t maxSpecializations, const std::string & prefix) {
+    this->threshold = threshold;
+    this->maxSpecializations = maxSpecializations;
+    this->prefix = prefix;
+    this->numNames = 0;
+}
+
+SpecializationTable::~SpecializationTable() {
+
+}
+
+void SpecializationTable::setThreshold(unsigned int threshold, std::size_t maxSpecializations) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->threshold = threshold;
+    this->maxSpecializations = maxSpecializations;
+}
+
+SpecializationTable::LookupResult SpecializationTable::lookup(const std::vector<int> & inputPositions,
+                                                              std::vector<int> & signature,
+                                                              std::string & name,
+                                                              std::vector<int> & argIndex)
+{
+    signature = inputPositions;
+    std::sort(signature.begin(), signature.end());
+    signature.erase(std::unique(signature.begin(), signature.end()), signature.end());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (threshold == 0) {
+        return not_specialized;
+    }
+
+    auto it = entries.find(signature);
+    if (it == entries.end()) {
+        if (entries.size() >= MAX_TRACKED_SIGNATURES) {
+            return not_specialized;
+        }
+        Entry entry;
+        entry.state = counting;
+        entry.queries = 0;
+        it = entries.insert(std::make_pair(signature, entry)).first;
+    }
+
+    Entry & entry = it->second;
+    if (entry.state == created) {
+        name = entry.name;
+        argIndex = entry.argIndex;
+        return specialized;
+    } else if (entry.state == counting) {
+        entry.queries++;
+        if (entry.queries >= threshold && numNames < maxSpecializations) {
+            entry.state = creating;
+            entry.name = prefix + std::to_string(numNames++);
+            name = entry.name;
+            return must_specialize;
+        }
+    }
+    return not_specialized;
+}
+
+void SpecializationTable::setCreated(const std::vector<int> & signature, int numVars) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(signature);
+    if (it == entries.end()) {
+        return;
+    }
+
+    //the grounded variables go first, in order of position, then the free ones
+    Entry & entry = it->second;
+    entry.argIndex.assign(numVars, -1);
+    int arg = 0;
+    for(int pos: signature) {
+        entry.argIndex[pos] = arg++;
+    }
+    for(int pos = 0; pos < numVars; pos++) {
+        if (entry.argIndex[pos] == -1) {
+            entry.argIndex[pos] = arg++;
+        }
+    }
+    entry.state = created;
+}
+
+void SpecializationTable::setFailed(const std::vector<int> & signature) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(signature);
+    if (it != entries.end()) {
+        it->second.state = failed;
+    }
+}
+
+std::vector<std::string> SpecializationTable::getNames() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> names;
+    for(const auto & pair: entries) {
+        if (pair.second.state == created) {
+            names.push_back(pair.second.name);
+        }
+    }
+    return names;
+}
+
+std::size_t SpecializationTable::getNumSpecializations() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t count = 0;
+    for(const auto & pair: entries) {
+        if (pair.second.state == created) {
+            count++;
+        }
+    }
+    return count;
+}
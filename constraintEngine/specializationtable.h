@@ -0,0 +1,133 @@
+#ifndef SPECIALIZATIONTABLE_H
+#define SPECIALIZATIONTABLE_H
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief MAX_TRACKED_SIGNATURES maximum number of grounding signatures counted by a SpecializationTable, the new ones are ignored.
+ */
+#define MAX_TRACKED_SIGNATURES 1024
+
+/**
+ * @brief The SpecializationTable class keeps track of the grounding signatures of the queries made to a machine.
+ *
+ * The grounding signature of a query is the sorted set of the positions of its grounded variables. The SpecializationTable class
+ * counts how many queries have been made with every signature and, when a signature reaches the threshold, asks the caller to create
+ * a predicate specialized for it. From then on the name of the specialized predicate and the order of its arguments are returned for
+ * that signature.
+ *
+ * The arguments of a specialized predicate are the grounded variables, in order of position, followed by the free ones: argIndex[i]
+ * is the argument that holds the variable at position i of the original predicate.
+ *
+ * All the methods are thread safe, only one caller is asked to create the predicate of a signature.
+ *
+ * @sa PrologExecutor::setSpecialization
+ */
+class SPECIALIZATIONTABLE_EXPORT SpecializationTable
+{
+public:
+    /**
+     * @brief The LookupResult enum what the caller must do with a query.
+     */
+    typedef enum LookupResult_ {
+        /**
+         * @brief not_specialized the query must call the original predicate.
+         */
+        not_specialized,
+        /**
+         * @brief specialized the query can call the returned specialized predicate.
+         */
+        specialized,
+        /**
+         * @brief must_specialize the signature has reached the threshold, the caller must create the predicate with the returned name
+         * and report it with setCreated() or setFailed().
+         */
+        must_specialize
+    } LookupResult;
+
+    /**
+     * @brief SpecializationTable creates an empty table.
+     * @param threshold number of queries of a signature before it is specialized, 0 disables the specialization.
+     * @param maxSpecializations maximum number of specialized predicates.
+     * @param prefix prefix of the name of the specialized predicates, followed by a number.
+     */
+    SpecializationTable(unsigned int threshold, std::size_t maxSpecializations, const std::string & prefix);
+    virtual ~SpecializationTable();
+
+    /**
+     * @brief setThreshold changes the threshold and the maximum number of specialized predicates, the existing ones are kept.
+     */
+    void setThreshold(unsigned int threshold, std::size_t maxSpecializations);
+
+    /**
+     * @brief lookup counts a query and returns how it must be solved.
+     * @param inputPositions positions of the grounded variables of the query, in any order.
+     * @param signature filled with the sorted positions without repetitions.
+     * @param name filled with the name of the specialized predicate if the result is specialized or must_specialize.
+     * @param argIndex filled with the argument of every variable if the result is specialized.
+     */
+    LookupResult lookup(const std::vector<int> & inputPositions,
+                        std::vector<int> & signature,
+                        std::string & name,
+                        std::vector<int> & argIndex);
+    /**
+     * @brief setCreated marks the predicate of a signature as created.
+     * @param numVars number of variables of the original predicate.
+     */
+    void setCreated(const std::vector<int> & signature, int numVars);
+    /**
+     * @brief setFailed marks a signature so it is never specialized again, its queries call the original predicate.
+     */
+    void setFailed(const std::vector<int> & signature);
+
+    /**
+     * @brief getNames returns the name of all the created predicates.
+     */
+    std::vector<std::string> getNames() const;
+    /**
+     * @brief getNumSpecializations returns the number of created predicates.
+     */
+    std::size_t getNumSpecializations() const;
+
+protected:
+    /**
+     * @brief The State enum state of the predicate of a signature.
+     */
+    typedef enum State_ {
+        counting,
+        creating,
+        created,
+        failed
+    } State;
+
+    /**
+     * @brief The Entry struct a signature seen by the table.
+     */
+    typedef struct Entry {
+        State state;
+        unsigned int queries;
+        std::string name;
+        std::vector<int> argIndex;
+    } Entry;
+
+    unsigned int threshold;
+    std::size_t maxSpecializations;
+    std::string prefix;
+    /**
+     * @brief numNames number of names given, the created predicates and the ones being created.
+     */
+    std::size_t numNames;
+    std::map<std::vector<int>, Entry> entries;
+    /**
+     * @brief mutex protects all the attributes.
+     */
+    mutable std::mutex mutex;
+};
+
+#endif // SPECIALIZATIONTABLE_H
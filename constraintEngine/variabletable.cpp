@@ -0,0 +1,71 @@
+#include "variabletable.h"
+
+VariableTable::VariableTable() {
+    for(int i = 0; i <= num_partitions; i++) {
+        partitionStart[i] = 0;
+    }
+}
+
+VariableTable::VariableTable(const std::set<std::string> & varTable) :
+    names(varTable.begin(), varTable.end())
+{
+    types.reserve(names.size());
+    int counts[num_partitions] = {};
+    for(const std::string & name: names) {
+        VariableNominator::VariableType type = VariableNominator::getVariableType(name);
+        types.push_back((std::uint8_t) type);
+        counts[partitionOf(type)]++;
+    }
+
+    partitionStart[0] = 0;
+    for(int i = 0; i < num_partitions; i++) {
+        partitionStart[i + 1] = partitionStart[i] + counts[i];
+    }
+
+    //counting sort by partition, the ids of each partition keep their order
+    partition.resize(names.size());
+    int next[num_partitions];
+    for(int i = 0; i < num_partitions; i++) {
+        next[i] = partitionStart[i];
+    }
+    for(int id = 0; id < (int) names.size(); id++) {
+        partition[next[partitionOf(getType(id))]++] = id;
+    }
+}
+
+VariableTable::~VariableTable() {
+
+}
+
+int VariableTable::find(const std::string & name) const {
+    auto it = std::lower_bound(names.begin(), names.end(), name);
+    if (it != names.end() && *it == name) {
+        return (int) (it - names.begin());
+    } else {
+        return -1;
+    }
+}
+
+VariableTable::IdRange VariableTable::getIds(VariableNominator::VariableType type) const {
+    Partition p = partitionOf(type);
+    return IdRange(partition.data() + partitionStart[p], partition.data() + partitionStart[p + 1]);
+}
+
+std::set<std::string> VariableTable::toSet() const {
+    return std::set<std::string>(names.begin(), names.end());
+}
+
+VariableTable::Partition VariableTable::partitionOf(VariableNominator::VariableType type) {
+    switch (type) {
+    case VariableNominator::pump:
+        return pump_partition;
+    case VariableNominator::valve:
+        return valve_partition;
+    case VariableNominator::container:
+        return container_partition;
+    case VariableNominator::tube:
+        return tube_partition;
+    default:
+        return other_partition;
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef VARIABLETABLE_H
+#define VARIABLETABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <fluidicmachinemodel/machine_graph_utils/variablenominator.h>
+
+#include "constraintengine/constraintsenginelibrary_global.h"
+
+/**
+ * @brief The VariableTable class is the symbol table of the variables of a machine.
+ *
+ * Every variable gets a dense integer id, its position in the predicates, and the names are stored sorted in a contiguous vector so
+ * the ids are the alphabetical order that the programs have always used and a name is found with a binary search. The type of every
+ * variable is computed once, and the ids are also kept partitioned by type: the pumps, then the valves, then the containers, the tubes
+ * and the unknown ones, each partition ordered by id. The pumps and the valves are contiguous so the variables to label are a single
+ * range.
+ *
+ * A VariableTable can be created implicitly from the std::set of names built by the translation stacks, so the methods that receive
+ * one also accept the set.
+ *
+ * @sa VariableNominator
+ */
+class VARIABLETABLE_EXPORT VariableTable
+{
+public:
+    /**
+     * @brief The IdRange struct a contiguous range of ids, valid while the table or vector it points to is alive and unchanged.
+     */
+    typedef struct IdRange {
+        const int* first;
+        const int* last;
+
+        IdRange(const int* first, const int* last) : first(first), last(last) {}
+        IdRange(const std::vector<int> & ids) : first(ids.data()), last(ids.data() + ids.size()) {}
+
+        inline const int* begin() const {
+            return first;
+        }
+        inline const int* end() const {
+            return last;
+        }
+        inline std::size_t size() const {
+            return (std::size_t) (last - first);
+        }
+        inline bool empty() const {
+            return first == last;
+        }
+        inline int operator[](std::size_t i) const {
+            return first[i];
+        }
+    } IdRange;
+
+    /**
+     * @brief VariableTable creates an empty table.
+     */
+    VariableTable();
+    /**
+     * @brief VariableTable creates a table with a set of names.
+     * @param varTable names of the variables, the ids are the position of each name in the set.
+     */
+    VariableTable(const std::set<std::string> & varTable);
+    virtual ~VariableTable();
+
+    /**
+     * @brief find returns the id of a variable.
+     * @param name name of the variable.
+     * @return id of the variable, or -1 if the table has no variable with that name.
+     */
+    int find(const std::string & name) const;
+
+    inline int size() const {
+        return (int) names.size();
+    }
+    inline bool empty() const {
+        return names.empty();
+    }
+    inline const std::string & getName(int id) const {
+        return names[id];
+    }
+    /**
+     * @brief getNames returns the names of all the variables, ordered by id.
+     */
+    inline const std::vector<std::string> & getNames() const {
+        return names;
+    }
+    inline VariableNominator::VariableType getType(int id) const {
+        return (VariableNominator::VariableType) types[id];
+    }
+
+    /**
+     * @brief getIds returns the ids of the variables of a type, in order of id.
+     */
+    IdRange getIds(VariableNominator::VariableType type) const;
+    /**
+     * @brief getLabelingIds returns the ids of the pumps followed by the ids of the valves.
+     */
+    inline IdRange getLabelingIds() const {
+        return IdRange(partition.data() + partitionStart[pump_partition], partition.data() + partitionStart[container_partition]);
+    }
+
+    /**
+     * @brief toSet returns the names of the variables as a std::set.
+     */
+    std::set<std::string> toSet() const;
+
+protected:
+    /**
+     * @brief The Partition enum order of the partitions of the ids by type.
+     */
+    typedef enum Partition_ {
+        pump_partition = 0,
+        valve_partition,
+        container_partition,
+        tube_partition,
+        other_partition,
+        num_partitions
+    } Partition;
+
+    /**
+     * @brief names name of every variable, sorted, the position is the id.
+     */
+    std::vector<std::string> names;
+    /**
+     * @brief types VariableNominator::VariableType of every variable, ordered by id.
+     */
+    std::vector<std::uint8_t> types;
+    /**
+     * @brief partition the ids grouped by type in the order of the Partition enum.
+     */
+    std::vector<int> partition;
+    /**
+     * @brief partitionStart position in partition of the first id of every partition, partitionStart[num_partitions] is its size.
+     */
+    int partitionStart[num_partitions + 1];
+
+    /**
+     * @brief partitionOf returns the partition of a type.
+     */
+    static Partition partitionOf(VariableNominator::VariableType type);
+};
+
+#endif // VARIABLETABLE_H
@@ -52,10 +52,48 @@ LIBS += -L$$quote(X:\swipl\lib) -llibswipl
 
 HEADERS += \
     constraintengine/constraintsenginelibrary_global.h \
+    constraintengine/asttranslationstack.h \
+    constraintengine/compiledprogramcache.h \
+    constraintengine/conflictexplainer.h \
+    constraintengine/constraintast.h \
+    constraintengine/constraintdecomposition.h \
+    constraintengine/constraintpresolver.h \
+    constraintengine/constraintprogramfile.h \
+    constraintengine/executorstats.h \
+    constraintengine/incrementalprologexecutor.h \
+    constraintengine/labelingstrategy.h \
+    constraintengine/nativeconstraintsolver.h \
+    constraintengine/nativetranslationstack.h \
+    constraintengine/programsink.h \
     constraintengine/prologexecutor.h \
-    constraintengine/prologtranslationstack.h
+    constraintengine/prologexecutorpool.h \
+    constraintengine/prologtermbuilder.h \
+    constraintengine/prologtermtranslationstack.h \
+    constraintengine/prologtranslationstack.h \
+    constraintengine/routecache.h \
+    constraintengine/specializationtable.h \
+    constraintengine/variabletable.h
 
 SOURCES += \
+    constraintengine/asttranslationstack.cpp \
+    constraintengine/compiledprogramcache.cpp \
+    constraintengine/conflictexplainer.cpp \
+    constraintengine/constraintast.cpp \
+    constraintengine/constraintdecomposition.cpp \
+    constraintengine/constraintpresolver.cpp \
+    constraintengine/constraintprogramfile.cpp \
+    constraintengine/executorstats.cpp \
+    constraintengine/incrementalprologexecutor.cpp \
+    constraintengine/labelingstrategy.cpp \
+    constraintengine/nativeconstraintsolver.cpp \
+    constraintengine/nativetranslationstack.cpp \
+    constraintengine/programsink.cpp \
     constraintengine/prologexecutor.cpp \
-    constraintengine/prologtranslationstack.cpp
+    constraintengine/prologexecutorpool.cpp \
+    constraintengine/prologtermbuilder.cpp \
+    constraintengine/prologtermtranslationstack.cpp \
+    constraintengine/prologtranslationstack.cpp \
+    constraintengine/routecache.cpp \
+    constraintengine/specializationtable.cpp \
+    constraintengine/variabletable.cpp
 
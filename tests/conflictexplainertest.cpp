@@ -0,0 +1,133 @@
+#include "conflictexplainertest.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QtTest>
+
+#include "constraintengine/conflictexplainer.h"
+#include "constraintengine/nativeconstraintsolver.h"
+#include "constraintengine/nativetranslationstack.h"
+
+#include "testmachines.h"
+
+/**
+ * @brief isFeasibleWithout checks the conflict with the background restrictions, without one of its inputs or groups.
+ * @param skipInput position at conflict.inputs of the input left out, -1 for none.
+ * @param skipGroup position at conflict.groups of the group left out, -1 for none.
+ */
+static bool isFeasibleWithout(const NativeConstraintSolver & solver,
+                              const std::vector<int> & groups,
+                              const std::unordered_map<std::string, long long> & inputStates,
+                              const ConflictExplainer::Conflict & conflict,
+                              int skipInput,
+                              int skipGroup)
+{
+    std::vector<int> inputPositions;
+    std::vector<long long> inputValues;
+    for(int i = 0; i < (int) conflict.inputs.size(); i++) {
+        if (i != skipInput) {
+            inputPositions.push_back(solver.getVarPosition(conflict.inputs[i]));
+            inputValues.push_back(inputStates.at(conflict.inputs[i]));
+        }
+    }
+
+    std::vector<char> enabled(groups.size(), 0);
+    for(std::size_t r = 0; r < groups.size(); r++) {
+        if (groups[r] == -1) {
+            enabled[r] = 1;
+        }
+        for(int g = 0; g < (int) conflict.groups.size(); g++) {
+            if (g != skipGroup && groups[r] == conflict.groups[g]) {
+                enabled[r] = 1;
+            }
+        }
+    }
+    return solver.isFeasible(inputPositions, inputValues, enabled);
+}
+
+/**
+ * @brief checkMinimal checks that a conflict has no solution and that leaving out any of its elements gives one.
+ */
+static bool checkMinimal(const NativeConstraintSolver & solver,
+                         const std::vector<int> & groups,
+                         const std::unordered_map<std::string, long long> & inputStates,
+                         const ConflictExplainer::Conflict & conflict)
+{
+    if (isFeasibleWithout(solver, groups, inputStates, conflict, -1, -1)) {
+        return false;
+    }
+    for(int i = 0; i < (int) conflict.inputs.size(); i++) {
+        if (!isFeasibleWithout(solver, groups, inputStates, conflict, i, -1)) {
+            return false;
+        }
+    }
+    for(int g = 0; g < (int) conflict.groups.size(); g++) {
+        if (!isFeasibleWithout(solver, groups, inputStates, conflict, -1, g)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ConflictExplainerTest::valvePositionsConflict() {
+    NativeTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<ConflictExplainer> explainer(stack.getConflictExplainer());
+    std::unique_ptr<NativeConstraintSolver> solver(static_cast<NativeConstraintSolver*>(stack.getRoutingEngine()));
+
+    //the domains are background, the rules are numbered by position: F_0_1 #= P_0 is 8, the valve rules 9 and 10, the containers
+    //11 and 12
+    std::unordered_map<std::string, long long> inputStates = {{"C_2", 1}, {"C_3", 1}};
+    ConflictExplainer::Conflict conflict;
+    QVERIFY(explainer->explain(inputStates, conflict));
+    QCOMPARE(conflict.inputs, std::vector<std::string>({"C_2", "C_3"}));
+    QCOMPARE(conflict.groups, std::vector<int>({9, 10, 11, 12}));
+    QVERIFY(checkMinimal(*solver, explainer->getGroups(), inputStates, conflict));
+}
+
+void ConflictExplainerTest::backwardPumpConflicts() {
+    NativeTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<ConflictExplainer> explainer(stack.getConflictExplainer());
+    std::unique_ptr<NativeConstraintSolver> solver(static_cast<NativeConstraintSolver*>(stack.getRoutingEngine()));
+
+    //the inputs are reported in the order of the variables, C_3 is not part of the conflict
+    std::unordered_map<std::string, long long> inputStates = {{"V_0", 1}, {"C_3", 0}, {"F_0_1", -1}};
+    ConflictExplainer::Conflict conflict;
+    QVERIFY(explainer->explain(inputStates, conflict));
+    QCOMPARE(conflict.inputs, std::vector<std::string>({"F_0_1", "V_0"}));
+    QCOMPARE(conflict.groups, std::vector<int>({8, 9}));
+    QVERIFY(checkMinimal(*solver, explainer->getGroups(), inputStates, conflict));
+}
+
+void ConflictExplainerTest::feasibleInputHasNoConflict() {
+    NativeTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<ConflictExplainer> explainer(stack.getConflictExplainer());
+
+    ConflictExplainer::Conflict conflict;
+    for(const TestMachines::Route & route: TestMachines::VALVE_MACHINE_ROUTES) {
+        if (!route.route.empty()) {
+            QVERIFY(!explainer->explain(route.input, conflict));
+        }
+    }
+}
+
+void ConflictExplainerTest::unboundedTubeOutsideConflict() {
+    //F_9 has no domain, only its rule 13 bounds it
+    NativeTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    TestMachines::stackEqualVariables(&stack, "F_9", "P_0");
+    std::unique_ptr<ConflictExplainer> explainer(stack.getConflictExplainer());
+    std::unique_ptr<NativeConstraintSolver> solver(static_cast<NativeConstraintSolver*>(stack.getRoutingEngine()));
+
+    std::unordered_map<std::string, long long> inputStates = {{"C_2", 1}, {"C_3", 1}};
+    ConflictExplainer::Conflict conflict;
+    QVERIFY(explainer->explain(inputStates, conflict));
+    QCOMPARE(conflict.inputs, std::vector<std::string>({"C_2", "C_3"}));
+    QCOMPARE(conflict.groups, std::vector<int>({9, 10, 11, 12}));
+    QVERIFY(checkMinimal(*solver, explainer->getGroups(), inputStates, conflict));
+}
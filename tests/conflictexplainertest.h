@@ -0,0 +1,36 @@
+#ifndef CONFLICTEXPLAINERTEST_H
+#define CONFLICTEXPLAINERTEST_H
+
+#include <QObject>
+
+/**
+ * @brief The ConflictExplainerTest class checks the conflicts found by ConflictExplainer on the inputs of the valve machine without
+ * routes.
+ */
+class ConflictExplainerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief valvePositionsConflict filling both containers needs the valve at two positions, the conflict has both inputs, their
+     * containers and their valve rules, it has no solution and removing any of them gives one.
+     */
+    void valvePositionsConflict();
+    /**
+     * @brief backwardPumpConflicts the valve at the position of C_2 makes F_1_2 follow P_0, that can not be backwards, the conflict has
+     * both inputs, the tube of the pump and the valve rule.
+     */
+    void backwardPumpConflicts();
+    /**
+     * @brief feasibleInputHasNoConflict explain returns false when the input states have a route.
+     */
+    void feasibleInputHasNoConflict();
+    /**
+     * @brief unboundedTubeOutsideConflict a tube without domain that is only bounded by a rule outside the conflict does not stop the
+     * explanation when that rule is left out.
+     */
+    void unboundedTubeOutsideConflict();
+};
+
+#endif // CONFLICTEXPLAINERTEST_H
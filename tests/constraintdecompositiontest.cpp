@@ -0,0 +1,69 @@
+#include "constraintdecompositiontest.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QtTest>
+
+#include "constraintengine/constraintdecomposition.h"
+#include "constraintengine/prologtranslationstack.h"
+
+#include "testmachines.h"
+
+//the valve machine and a pump P_2 that fills the container C_4, sharing no variable with it
+static void stackTwoMachines(TranslationStack* stack) {
+    TestMachines::stackValveMachine(stack);
+
+    TestMachines::stackDomain(stack, "P_2", -1, 1);
+    TestMachines::stackDomain(stack, "F_2_4", 0, 1);
+    TestMachines::stackDomain(stack, "C_4", 0, 1);
+    TestMachines::stackEqualVariables(stack, "F_2_4", "P_2");
+    TestMachines::stackContainer(stack, "C_4", "F_2_4");
+}
+
+static const std::vector<TestMachines::Route> TWO_MACHINES_ROUTES = {
+    {{{"F_0_1", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 0}, {"F_0_1", 1}, {"F_1_2", 0}, {"F_1_3", 0}, {"C_2", 0}, {"C_3", 0},
+                      {"P_2", 0}, {"F_2_4", 0}, {"C_4", 0}}},
+    {{{"C_4", 1}}, {{"P_0", 0}, {"P_1", 0}, {"V_0", 0}, {"F_0_1", 0}, {"F_1_2", 0}, {"F_1_3", 0}, {"C_2", 0}, {"C_3", 0},
+                    {"P_2", 1}, {"F_2_4", 1}, {"C_4", 1}}},
+    {{{"C_3", 1}, {"C_4", 1}}, {{"P_0", 0}, {"P_1", 1}, {"V_0", 2}, {"F_0_1", 0}, {"F_1_2", 0}, {"F_1_3", 1}, {"C_2", 0}, {"C_3", 1},
+                                {"P_2", 1}, {"F_2_4", 1}, {"C_4", 1}}},
+    {{{"C_2", 1}, {"C_3", 1}, {"C_4", 1}}, {}},
+};
+
+void ConstraintDecompositionTest::independentMachinesAreSplit() {
+    PrologTranslationStack stack;
+    stackTwoMachines(&stack);
+
+    ConstraintDecomposition decomposition(stack.getAst(), stack.getRestrictionRoots(), stack.getVarTable());
+    QCOMPARE(decomposition.getNumComponents(), (std::size_t) 2);
+
+    const ConstraintDecomposition::Component & valves = decomposition.getComponents()[0];
+    QCOMPARE(valves.restrictions.size(), (std::size_t) 13);
+    QVERIFY(valves.varTable == std::set<std::string>({"C_2", "C_3", "F_0_1", "F_1_2", "F_1_3", "P_0", "P_1", "V_0"}));
+
+    const ConstraintDecomposition::Component & pump = decomposition.getComponents()[1];
+    QCOMPARE(pump.restrictions.size(), (std::size_t) 5);
+    QVERIFY(pump.varTable == std::set<std::string>({"C_4", "F_2_4", "P_2"}));
+}
+
+void ConstraintDecompositionTest::decomposedProgramMatchesMonolithic() {
+    PrologTranslationStack monolithicStack;
+    stackTwoMachines(&monolithicStack);
+    std::unique_ptr<RoutingEngine> monolithic(monolithicStack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(monolithic.get(), TWO_MACHINES_ROUTES));
+
+    PrologTranslationStack sequentialStack;
+    stackTwoMachines(&sequentialStack);
+    sequentialStack.setDecomposition(true);
+    std::unique_ptr<RoutingEngine> sequential(sequentialStack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(sequential.get(), TWO_MACHINES_ROUTES));
+
+    PrologTranslationStack concurrentStack;
+    stackTwoMachines(&concurrentStack);
+    concurrentStack.setDecomposition(true, 2);
+    std::unique_ptr<RoutingEngine> concurrent(concurrentStack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(concurrent.get(), TWO_MACHINES_ROUTES));
+}
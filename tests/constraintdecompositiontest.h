@@ -0,0 +1,26 @@
+#ifndef CONSTRAINTDECOMPOSITIONTEST_H
+#define CONSTRAINTDECOMPOSITIONTEST_H
+
+#include <QObject>
+
+/**
+ * @brief The ConstraintDecompositionTest class checks the components of a machine and that a decomposed program returns the same routes
+ * as the single predicate.
+ */
+class ConstraintDecompositionTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief independentMachinesAreSplit the valve machine and an independent pump are two components.
+     */
+    void independentMachinesAreSplit();
+    /**
+     * @brief decomposedProgramMatchesMonolithic the decomposed program, solved at one and at two threads, returns the known routes of the
+     * single predicate.
+     */
+    void decomposedProgramMatchesMonolithic();
+};
+
+#endif // CONSTRAINTDECOMPOSITIONTEST_H
@@ -0,0 +1,127 @@
+#include "constraintpresolvertest.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QtTest>
+
+#include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+
+#include "constraintengine/asttranslationstack.h"
+#include "constraintengine/nativetranslationstack.h"
+#include "constraintengine/prologtranslationstack.h"
+
+#include "testmachines.h"
+
+/**
+ * @brief createStack returns a new PrologTranslationStack if native is false, a NativeTranslationStack otherwise.
+ */
+static AstTranslationStack* createStack(bool native) {
+    if (native) {
+        return new NativeTranslationStack();
+    } else {
+        return new PrologTranslationStack();
+    }
+}
+
+/**
+ * @brief stackRedundantRules adds to the valve machine rules that do not change its routes but that the presolve simplifies.
+ */
+static void stackRedundantRules(TranslationStack* stack) {
+    //(3 + 4) #= 7, folded to true and dropped
+    stack->stackNumber(3);
+    stack->stackNumber(4);
+    stack->stackArithmeticBinaryOperation(BinaryOperation::add);
+    stack->stackNumber(7);
+    stack->stackEquality(Equality::equal);
+    stack->addHeadToRestrictions();
+
+    //(P_0 + 0) #= (P_0 * 1), both sides folded to P_0 and the comparison to true
+    stack->stackVariable("P_0");
+    stack->stackNumber(0);
+    stack->stackArithmeticBinaryOperation(BinaryOperation::add);
+    stack->stackVariable("P_0");
+    stack->stackNumber(1);
+    stack->stackArithmeticBinaryOperation(BinaryOperation::multiply);
+    stack->stackEquality(Equality::equal);
+    stack->addHeadToRestrictions();
+
+    //(V_0 #= V_0) #/\ (C_2 #=< 1), the conjunction reduced to its right side
+    TestMachines::stackVariables(stack, "V_0", Equality::equal, "V_0");
+    TestMachines::stackComparison(stack, "C_2", Equality::lesser_equal, 1);
+    stack->stackBooleanConjuction(Conjunction::predicate_and);
+    stack->addHeadToRestrictions();
+
+    //(P_0 #>= -1) #/\ (C_3 #>= 0), split in two restrictions, and then repeated
+    for(int i = 0; i < 2; i++) {
+        TestMachines::stackComparison(stack, "P_0", Equality::bigger_equal, -1);
+        TestMachines::stackComparison(stack, "C_3", Equality::bigger_equal, 0);
+        stack->stackBooleanConjuction(Conjunction::predicate_and);
+        stack->addHeadToRestrictions();
+    }
+
+    //(1 #= 0) #\/ (V_0 #=< 2), the disjunction reduced to its right side
+    stack->stackNumber(1);
+    stack->stackNumber(0);
+    stack->stackEquality(Equality::equal);
+    TestMachines::stackComparison(stack, "V_0", Equality::lesser_equal, 2);
+    stack->stackBooleanConjuction(Conjunction::predicate_or);
+    stack->addHeadToRestrictions();
+
+    //a second domain of the pump, merged with the first one
+    TestMachines::stackDomain(stack, "P_0", -5, 5);
+}
+
+void ConstraintPresolverTest::sameRoutesWithAndWithoutPresolve() {
+    for(bool native: {false, true}) {
+        std::unique_ptr<AstTranslationStack> plainStack(createStack(native));
+        TestMachines::stackValveMachine(plainStack.get());
+        stackRedundantRules(plainStack.get());
+        std::unique_ptr<RoutingEngine> plain(plainStack->getRoutingEngine());
+
+        std::unique_ptr<AstTranslationStack> presolvedStack(createStack(native));
+        presolvedStack->setPresolve(true);
+        TestMachines::stackValveMachine(presolvedStack.get());
+        stackRedundantRules(presolvedStack.get());
+        std::unique_ptr<RoutingEngine> presolved(presolvedStack->getRoutingEngine());
+
+        const ConstraintPresolver::Stats & stats = presolvedStack->getPresolveStats();
+        QVERIFY(!stats.contradiction);
+        QVERIFY(stats.foldedNodes > 0);
+        QCOMPARE(stats.tautologies, (std::size_t) 2);
+        QCOMPARE(stats.duplicates, (std::size_t) 2);
+        QCOMPARE(stats.mergedDomains, (std::size_t) 1);
+        QVERIFY(stats.restrictionsOut < stats.restrictionsIn);
+
+        QVERIFY(TestMachines::hasRoutes(plain.get(), TestMachines::VALVE_MACHINE_ROUTES));
+        QVERIFY(TestMachines::hasRoutes(presolved.get(), TestMachines::VALVE_MACHINE_ROUTES));
+    }
+}
+
+void ConstraintPresolverTest::restrictionFoldedToFalseHasNoRoutes() {
+    for(bool native: {false, true}) {
+        for(bool presolve: {false, true}) {
+            std::unique_ptr<AstTranslationStack> stack(createStack(native));
+            stack->setPresolve(presolve);
+            TestMachines::stackValveMachine(stack.get());
+
+            //(2 * 3) #= 5
+            stack->stackNumber(2);
+            stack->stackNumber(3);
+            stack->stackArithmeticBinaryOperation(BinaryOperation::multiply);
+            stack->stackNumber(5);
+            stack->stackEquality(Equality::equal);
+            stack->addHeadToRestrictions();
+
+            std::unique_ptr<RoutingEngine> engine(stack->getRoutingEngine());
+            QCOMPARE(stack->getPresolveStats().contradiction, presolve);
+            for(const TestMachines::Route & route: TestMachines::VALVE_MACHINE_ROUTES) {
+                std::unordered_map<std::string, long long> outStates;
+                QVERIFY(!engine->calculateNewRoute(route.input, outStates));
+                QVERIFY(outStates.empty());
+            }
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef CONSTRAINTPRESOLVERTEST_H
+#define CONSTRAINTPRESOLVERTEST_H
+
+#include <QObject>
+
+/**
+ * @brief The ConstraintPresolverTest class checks that the presolve does not change the routes of a machine.
+ */
+class ConstraintPresolverTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief sameRoutesWithAndWithoutPresolve the valve machine returns its known routes with the presolve enabled and disabled,
+     * with extra restrictions that fold to true, repeated restrictions, conjunctions to split and a domain to merge.
+     */
+    void sameRoutesWithAndWithoutPresolve();
+    /**
+     * @brief restrictionFoldedToFalseHasNoRoutes a restriction that folds to false leaves the machine without routes, with and without
+     * the presolve.
+     */
+    void restrictionFoldedToFalseHasNoRoutes();
+};
+
+#endif // CONSTRAINTPRESOLVERTEST_H
@@ -0,0 +1,138 @@
+#include "constraintprogramfiletest.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include <QByteArray>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "constraintengine/constraintprogramfile.h"
+#include "constraintengine/prologtranslationstack.h"
+
+#include "testmachines.h"
+
+/**
+ * @brief saveValveMachine writes the valve machine to a file of a directory and returns its bytes.
+ */
+static QByteArray saveValveMachine(const QTemporaryDir & dir, const std::string & name) {
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::string path = dir.filePath(QString::fromStdString(name)).toStdString();
+    stack.saveProgram(path);
+
+    QFile file(QString::fromStdString(path));
+    file.open(QIODevice::ReadOnly);
+    return file.readAll();
+}
+
+/**
+ * @brief writeBytes writes a modified file to a directory and returns its path.
+ */
+static std::string writeBytes(const QTemporaryDir & dir, const std::string & name, const QByteArray & bytes) {
+    std::string path = dir.filePath(QString::fromStdString(name)).toStdString();
+    QFile file(QString::fromStdString(path));
+    file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    file.write(bytes);
+    file.close();
+    return path;
+}
+
+void ConstraintProgramFileTest::savedProgramReturnsKnownRoutes() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    saveValveMachine(dir, "valve.cpr");
+
+    ConstraintProgramFile program(dir.filePath("valve.cpr").toStdString());
+    QCOMPARE(program.getRestrictions().size(), (std::size_t) 13);
+    QVERIFY(program.getVarTable() == std::set<std::string>({"C_2", "C_3", "F_0_1", "F_1_2", "F_1_3", "P_0", "P_1", "V_0"}));
+
+    std::unique_ptr<RoutingEngine> native(program.createNativeConstraintSolver());
+    QVERIFY(TestMachines::hasRoutes(native.get(), TestMachines::VALVE_MACHINE_ROUTES));
+    std::unique_ptr<RoutingEngine> executor(program.createPrologExecutor());
+    QVERIFY(TestMachines::hasRoutes(executor.get(), TestMachines::VALVE_MACHINE_ROUTES));
+}
+
+void ConstraintProgramFileTest::truncatedFileIsRejected() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QByteArray bytes = saveValveMachine(dir, "valve.cpr");
+
+    std::string header = writeBytes(dir, "header.cpr", bytes.left(sizeof(ConstraintProgramFile::Header) - 1));
+    QVERIFY_EXCEPTION_THROWN(ConstraintProgramFile program(header), std::runtime_error);
+    std::string names = writeBytes(dir, "names.cpr", bytes.left(bytes.size() - 1));
+    QVERIFY_EXCEPTION_THROWN(ConstraintProgramFile program(names), std::runtime_error);
+}
+
+void ConstraintProgramFileTest::otherFormatIsRejected() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QByteArray bytes = saveValveMachine(dir, "valve.cpr");
+
+    ConstraintProgramFile::Header header;
+    std::memcpy(&header, bytes.constData(), sizeof(header));
+    ConstraintProgramFile::Header changed = header;
+    changed.magic++;
+    std::memcpy(bytes.data(), &changed, sizeof(changed));
+    QVERIFY_EXCEPTION_THROWN(ConstraintProgramFile program(writeBytes(dir, "magic.cpr", bytes)), std::runtime_error);
+
+    changed = header;
+    changed.version++;
+    std::memcpy(bytes.data(), &changed, sizeof(changed));
+    QVERIFY_EXCEPTION_THROWN(ConstraintProgramFile program(writeBytes(dir, "version.cpr", bytes)), std::runtime_error);
+}
+
+void ConstraintProgramFileTest::childCreatedLaterIsRejected() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QByteArray bytes = saveValveMachine(dir, "valve.cpr");
+
+    //the first child of the root of the last restriction points to the root itself
+    ConstraintProgramFile::Header header;
+    std::memcpy(&header, bytes.constData(), sizeof(header));
+    std::size_t rootsOffset = sizeof(header) + header.numNodes * sizeof(ConstraintAst::Node) +
+            header.numChildren * sizeof(ConstraintAst::NodeId);
+    ConstraintAst::NodeId root;
+    std::memcpy(&root, bytes.constData() + rootsOffset + (header.numRestrictions - 1) * sizeof(root), sizeof(root));
+    ConstraintAst::Node node;
+    std::memcpy(&node, bytes.constData() + sizeof(header) + root * sizeof(node), sizeof(node));
+    std::size_t childOffset = sizeof(header) + header.numNodes * sizeof(ConstraintAst::Node) + node.firstChild * sizeof(root);
+    std::memcpy(bytes.data() + childOffset, &root, sizeof(root));
+
+    QVERIFY_EXCEPTION_THROWN(ConstraintProgramFile program(writeBytes(dir, "child.cpr", bytes)), std::runtime_error);
+}
+
+void ConstraintProgramFileTest::wrongShapeNodeIsRejected() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QByteArray bytes = saveValveMachine(dir, "valve.cpr");
+
+    //the root of the last restriction is the equality of C_3
+    ConstraintProgramFile::Header header;
+    std::memcpy(&header, bytes.constData(), sizeof(header));
+    std::size_t rootsOffset = sizeof(header) + header.numNodes * sizeof(ConstraintAst::Node) +
+            header.numChildren * sizeof(ConstraintAst::NodeId);
+    ConstraintAst::NodeId root;
+    std::memcpy(&root, bytes.constData() + rootsOffset + (header.numRestrictions - 1) * sizeof(root), sizeof(root));
+    std::size_t nodeOffset = sizeof(header) + root * sizeof(ConstraintAst::Node);
+    ConstraintAst::Node node;
+    std::memcpy(&node, bytes.constData() + nodeOffset, sizeof(node));
+    QCOMPARE((int) node.kind, (int) ConstraintAst::equality_node);
+
+    QByteArray oneChild = bytes;
+    ConstraintAst::Node changed = node;
+    changed.numChildren = 1;
+    std::memcpy(oneChild.data() + nodeOffset, &changed, sizeof(changed));
+    QVERIFY_EXCEPTION_THROWN(ConstraintProgramFile program(writeBytes(dir, "children.cpr", oneChild)), std::runtime_error);
+
+    QByteArray unknownOp = bytes;
+    changed = node;
+    changed.op = 0xff;
+    std::memcpy(unknownOp.data() + nodeOffset, &changed, sizeof(changed));
+    QVERIFY_EXCEPTION_THROWN(ConstraintProgramFile program(writeBytes(dir, "op.cpr", unknownOp)), std::runtime_error);
+}
@@ -0,0 +1,38 @@
+#ifndef CONSTRAINTPROGRAMFILETEST_H
+#define CONSTRAINTPROGRAMFILETEST_H
+
+#include <QObject>
+
+/**
+ * @brief The ConstraintProgramFileTest class checks that a saved machine is loaded with the same routes and that the files that are not
+ * valid programs are rejected.
+ */
+class ConstraintProgramFileTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief savedProgramReturnsKnownRoutes the valve machine saved and loaded again returns its known routes with both backends.
+     */
+    void savedProgramReturnsKnownRoutes();
+    /**
+     * @brief truncatedFileIsRejected a file cut at the header or at the names of the variables throws a runtime_error.
+     */
+    void truncatedFileIsRejected();
+    /**
+     * @brief otherFormatIsRejected a file with another magic number or version throws a runtime_error.
+     */
+    void otherFormatIsRejected();
+    /**
+     * @brief childCreatedLaterIsRejected a node whose child is not created before it throws a runtime_error.
+     */
+    void childCreatedLaterIsRejected();
+    /**
+     * @brief wrongShapeNodeIsRejected a node with a number of children or an operator that its kind does not have throws a
+     * runtime_error.
+     */
+    void wrongShapeNodeIsRejected();
+};
+
+#endif // CONSTRAINTPROGRAMFILETEST_H
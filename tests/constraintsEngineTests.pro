@@ -0,0 +1,83 @@
+#-------------------------------------------------
+#
+# Unit tests of the constraints engine library
+#
+#-------------------------------------------------
+
+# ensure one "debug_and_release" in CONFIG, for clarity...
+debug_and_release {
+    CONFIG -= debug_and_release
+    CONFIG += debug_and_release
+}
+    # ensure one "debug" or "release" in CONFIG so they can be used as
+    #   conditionals instead of writing "CONFIG(debug, debug|release)"...
+CONFIG(debug, debug|release) {
+    CONFIG -= debug release
+    CONFIG += debug
+}
+CONFIG(release, debug|release) {
+    CONFIG -= debug release
+    CONFIG += release
+}
+
+QT       -= gui
+QT       += testlib
+
+TARGET = constraintsEngineTests
+TEMPLATE = app
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/..
+
+debug {
+    INCLUDEPATH += X:\fluidicMachineModel\dll_debug\include
+
+    LIBS += -L$$quote(X:\fluidicMachineModel\dll_debug\bin) -lFluidicMachineModel
+    LIBS += -L$$quote(X:\constraintsEngine\dll_debug\bin) -lconstraintsEngineLibrary
+}
+
+!debug {
+    INCLUDEPATH += X:\fluidicMachineModel\dll_release\include
+
+    LIBS += -L$$quote(X:\fluidicMachineModel\dll_release\bin) -lFluidicMachineModel
+    LIBS += -L$$quote(X:\constraintsEngine\dll_release\bin) -lconstraintsEngineLibrary
+}
+
+INCLUDEPATH += X:\swipl\include
+LIBS += -L$$quote(X:\swipl\bin) -llibswipl
+LIBS += -L$$quote(X:\swipl\lib) -llibswipl
+
+HEADERS += \
+    conflictexplainertest.h \
+    constraintdecompositiontest.h \
+    constraintpresolvertest.h \
+    constraintprogramfiletest.h \
+    incrementalprologexecutortest.h \
+    labelingstrategytest.h \
+    nativeconstraintsolvertest.h \
+    prologexecutorpooltest.h \
+    prologexecutortest.h \
+    prologtranslationstacktest.h \
+    routecachetest.h \
+    specializationtabletest.h \
+    testmachines.h \
+    variabletabletest.h
+
+SOURCES += \
+    conflictexplainertest.cpp \
+    constraintdecompositiontest.cpp \
+    constraintpresolvertest.cpp \
+    constraintprogramfiletest.cpp \
+    incrementalprologexecutortest.cpp \
+    labelingstrategytest.cpp \
+    main.cpp \
+    nativeconstraintsolvertest.cpp \
+    prologexecutorpooltest.cpp \
+    prologexecutortest.cpp \
+    prologtranslationstacktest.cpp \
+    routecachetest.cpp \
+    specializationtabletest.cpp \
+    testmachines.cpp \
+    variabletabletest.cpp
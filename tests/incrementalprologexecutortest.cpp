@@ -0,0 +1,129 @@
+#include "incrementalprologexecutortest.h"
+
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QtTest>
+
+#include "constraintengine/incrementalprologexecutor.h"
+#include "constraintengine/prologtermtranslationstack.h"
+
+#include "testmachines.h"
+
+//the valve machine with the valve of F_1_3 connected to another pump, or without that rule if the pump is empty
+static void stackChangedMachine(TranslationStack* stack, const std::string & f13Pump) {
+    TestMachines::stackDomain(stack, "P_0", -1, 1);
+    TestMachines::stackDomain(stack, "P_1", -1, 1);
+    TestMachines::stackDomain(stack, "V_0", 0, 2);
+    TestMachines::stackDomain(stack, "F_0_1", -1, 1);
+    TestMachines::stackDomain(stack, "F_1_2", 0, 1);
+    TestMachines::stackDomain(stack, "F_1_3", 0, 1);
+    TestMachines::stackDomain(stack, "C_2", 0, 1);
+    TestMachines::stackDomain(stack, "C_3", 0, 1);
+
+    TestMachines::stackEqualVariables(stack, "F_0_1", "P_0");
+    TestMachines::stackValveTube(stack, "V_0", 1, "F_1_2", "P_0");
+    if (!f13Pump.empty()) {
+        TestMachines::stackValveTube(stack, "V_0", 2, "F_1_3", f13Pump);
+    }
+    TestMachines::stackContainer(stack, "C_2", "F_1_2");
+    TestMachines::stackContainer(stack, "C_3", "F_1_3");
+}
+
+void IncrementalPrologExecutorTest::initialRoutesMatchPrologExecutor() {
+    PrologTermTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+
+    std::unique_ptr<IncrementalPrologExecutor> incremental(stack.getIncrementalRoutingEngine());
+    std::unique_ptr<RoutingEngine> executor(stack.getRoutingEngine());
+    QCOMPARE(incremental->getRestrictionIds().size(), (std::size_t) 13);
+    QVERIFY(TestMachines::hasRoutes(incremental.get(), TestMachines::VALVE_MACHINE_ROUTES));
+    QVERIFY(TestMachines::hasRoutes(executor.get(), TestMachines::VALVE_MACHINE_ROUTES));
+}
+
+void IncrementalPrologExecutorTest::replacedRestrictionMatchesRebuiltProgram() {
+    PrologTermTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<IncrementalPrologExecutor> incremental(stack.getIncrementalRoutingEngine());
+    IncrementalPrologExecutor::RestrictionId ruleId = incremental->getRestrictionIds()[TestMachines::VALVE_MACHINE_F_1_3_RULE];
+
+    PrologTermTranslationStack patch;
+    TestMachines::stackValveTube(&patch, "V_0", 2, "F_1_3", "P_0");
+    incremental->replaceRestriction(ruleId, patch.getAst(), patch.getRestrictionRoots()[0]);
+
+    PrologTermTranslationStack rebuiltStack;
+    stackChangedMachine(&rebuiltStack, "P_0");
+    std::unique_ptr<RoutingEngine> rebuilt(rebuiltStack.getRoutingEngine());
+
+    std::vector<TestMachines::Route> routes = {
+        {{{"F_0_1", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 0}, {"F_0_1", 1}, {"F_1_2", 0}, {"F_1_3", 0}, {"C_2", 0}, {"C_3", 0}}},
+        {{{"C_2", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 1}, {"F_0_1", 1}, {"F_1_2", 1}, {"F_1_3", 0}, {"C_2", 1}, {"C_3", 0}}},
+        {{{"C_3", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 2}, {"F_0_1", 1}, {"F_1_2", 0}, {"F_1_3", 1}, {"C_2", 0}, {"C_3", 1}}},
+        {{{"C_2", 1}, {"C_3", 1}}, {}},
+    };
+    QVERIFY(TestMachines::hasRoutes(rebuilt.get(), routes));
+    QVERIFY(TestMachines::hasRoutes(incremental.get(), routes));
+    QCOMPARE(incremental->getRestrictionIds().size(), (std::size_t) 13);
+}
+
+void IncrementalPrologExecutorTest::removedRestrictionMatchesRebuiltProgram() {
+    PrologTermTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<IncrementalPrologExecutor> incremental(stack.getIncrementalRoutingEngine());
+    IncrementalPrologExecutor::RestrictionId ruleId = incremental->getRestrictionIds()[TestMachines::VALVE_MACHINE_F_1_3_RULE];
+    incremental->removeRestriction(ruleId);
+
+    PrologTermTranslationStack rebuiltStack;
+    stackChangedMachine(&rebuiltStack, "");
+    std::unique_ptr<RoutingEngine> rebuilt(rebuiltStack.getRoutingEngine());
+
+    //without the rule C_3 only fixes F_1_3, the inputs leave every variable ground
+    std::vector<TestMachines::Route> routes = {
+        {{{"C_3", 0}}, {{"P_0", 0}, {"P_1", 0}, {"V_0", 0}, {"F_0_1", 0}, {"F_1_2", 0}, {"F_1_3", 0}, {"C_2", 0}, {"C_3", 0}}},
+        {{{"C_3", 1}}, {{"P_0", 0}, {"P_1", 0}, {"V_0", 0}, {"F_0_1", 0}, {"F_1_2", 0}, {"F_1_3", 1}, {"C_2", 0}, {"C_3", 1}}},
+        {{{"C_2", 1}, {"C_3", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 1}, {"F_0_1", 1}, {"F_1_2", 1}, {"F_1_3", 1}, {"C_2", 1}, {"C_3", 1}}},
+    };
+    QVERIFY(TestMachines::hasRoutes(rebuilt.get(), routes));
+    QVERIFY(TestMachines::hasRoutes(incremental.get(), routes));
+
+    //adding the rule back gives the routes of the original machine
+    PrologTermTranslationStack rule;
+    TestMachines::stackValveTube(&rule, "V_0", 2, "F_1_3", "P_1");
+    incremental->addRestriction(rule.getAst(), rule.getRestrictionRoots()[0]);
+    QVERIFY(TestMachines::hasRoutes(incremental.get(), TestMachines::VALVE_MACHINE_ROUTES));
+    QCOMPARE(incremental->getRestrictionIds().size(), (std::size_t) 13);
+}
+
+void IncrementalPrologExecutorTest::lastDomainOfUsedVariableIsKept() {
+    PrologTermTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<IncrementalPrologExecutor> incremental(stack.getIncrementalRoutingEngine());
+    std::vector<IncrementalPrologExecutor::RestrictionId> ids = incremental->getRestrictionIds();
+
+    //the domains are stacked first, P_1 is the second one and C_3 the last one
+    QVERIFY_EXCEPTION_THROWN(incremental->removeRestriction(ids[1]), std::runtime_error);
+    PrologTermTranslationStack rule;
+    TestMachines::stackComparison(&rule, "P_1", Equality::bigger_equal, 0);
+    rule.addHeadToRestrictions();
+    QVERIFY_EXCEPTION_THROWN(incremental->replaceRestriction(ids[1], rule.getAst(), rule.getRestrictionRoots()[0]), std::runtime_error);
+
+    //the known routes never run P_1 backwards
+    PrologTermTranslationStack domain;
+    TestMachines::stackDomain(&domain, "P_1", 0, 1);
+    incremental->replaceRestriction(ids[1], domain.getAst(), domain.getRestrictionRoots()[0]);
+    QVERIFY(TestMachines::hasRoutes(incremental.get(), TestMachines::VALVE_MACHINE_ROUTES));
+
+    //without the container rule, the last restriction, nothing else uses C_3
+    incremental->removeRestriction(ids[12]);
+    incremental->removeRestriction(ids[7]);
+    QVERIFY(incremental->getVarTable() == std::set<std::string>({"C_2", "F_0_1", "F_1_2", "F_1_3", "P_0", "P_1", "V_0"}));
+    std::vector<TestMachines::Route> routes = {
+        {{{"F_0_1", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 0}, {"F_0_1", 1}, {"F_1_2", 0}, {"F_1_3", 0}, {"C_2", 0}}},
+        {{{"C_2", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 1}, {"F_0_1", 1}, {"F_1_2", 1}, {"F_1_3", 0}, {"C_2", 1}}},
+    };
+    QVERIFY(TestMachines::hasRoutes(incremental.get(), routes));
+}
@@ -0,0 +1,35 @@
+#ifndef INCREMENTALPROLOGEXECUTORTEST_H
+#define INCREMENTALPROLOGEXECUTORTEST_H
+
+#include <QObject>
+
+/**
+ * @brief The IncrementalPrologExecutorTest class checks that patching the restrictions of an IncrementalPrologExecutor gives the same
+ * routes as translating the changed machine again.
+ */
+class IncrementalPrologExecutorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief initialRoutesMatchPrologExecutor an executor created from a translated machine returns its known routes, the same as
+     * PrologExecutor.
+     */
+    void initialRoutesMatchPrologExecutor();
+    /**
+     * @brief replacedRestrictionMatchesRebuiltProgram the valve of F_1_3 is connected to P_0 instead of P_1.
+     */
+    void replacedRestrictionMatchesRebuiltProgram();
+    /**
+     * @brief removedRestrictionMatchesRebuiltProgram the rule of the valve of F_1_3 is removed and then added back.
+     */
+    void removedRestrictionMatchesRebuiltProgram();
+    /**
+     * @brief lastDomainOfUsedVariableIsKept the last domain of a variable used by other restrictions can not be removed nor replaced by
+     * a rule, only by another domain, and once the variable is unused it is removed with its domain.
+     */
+    void lastDomainOfUsedVariableIsKept();
+};
+
+#endif // INCREMENTALPROLOGEXECUTORTEST_H
@@ -0,0 +1,50 @@
+#include "labelingstrategytest.h"
+
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <QtTest>
+
+#include "constraintengine/labelingstrategy.h"
+
+static const std::set<std::string> VALVE_MACHINE_VARS = {"C_2", "C_3", "F_0_1", "F_1_2", "F_1_3", "P_0", "P_1", "V_0"};
+
+void LabelingStrategyTest::defaultStrategyMinimizesPumpsThenValves() {
+    LabelingStrategy strategy;
+    QCOMPARE(strategy.generateLabeling(VALVE_MACHINE_VARS),
+             std::string("once(labeling([ff,min(abs(P_0) + abs(P_1)),min(min(V_0, 1))],[P_0,P_1,V_0]))"));
+}
+
+void LabelingStrategyTest::searchOptionsAndOrderAreGenerated() {
+    LabelingStrategy strategy;
+    strategy.setVariableSelection(LabelingStrategy::select_leftmost);
+    strategy.setValueOrder(LabelingStrategy::value_down);
+    strategy.setBranching(LabelingStrategy::branch_bisect);
+    strategy.setObjective(LabelingStrategy::weighted_objective);
+    strategy.setWeights(1, 10);
+    strategy.setVariableOrder({"V_0", "P_1"});
+
+    QCOMPARE(strategy.generateLabeling(VALVE_MACHINE_VARS),
+             std::string("once(labeling([leftmost,down,bisect,min(1*(abs(P_0) + abs(P_1)) + 10*(min(V_0, 1)))],[V_0,P_1,P_0]))"));
+    QVERIFY(strategy.toString() != LabelingStrategy().toString());
+}
+
+void LabelingStrategyTest::firstFeasibleHasNoObjective() {
+    LabelingStrategy strategy;
+    strategy.setMode(LabelingStrategy::first_feasible_mode);
+
+    QCOMPARE(strategy.generateLabeling(VALVE_MACHINE_VARS), std::string("once(labeling([ff],[P_0,P_1,V_0]))"));
+    QVERIFY(strategy.toString() != LabelingStrategy().toString());
+}
+
+void LabelingStrategyTest::variableOrderOnlyAcceptsPumpsAndValves() {
+    LabelingStrategy strategy;
+    strategy.setVariableOrder({"V_0", "P_0"});
+    QCOMPARE(strategy.getVariableOrder().size(), (std::size_t) 2);
+
+    QVERIFY_EXCEPTION_THROWN(strategy.setVariableOrder({"P_0", "C_3"}), std::runtime_error);
+    QVERIFY_EXCEPTION_THROWN(strategy.setVariableOrder({"F_0_1"}), std::runtime_error);
+    QVERIFY(strategy.getVariableOrder() == std::vector<std::string>({"V_0", "P_0"}));
+}
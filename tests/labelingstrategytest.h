@@ -0,0 +1,35 @@
+#ifndef LABELINGSTRATEGYTEST_H
+#define LABELINGSTRATEGYTEST_H
+
+#include <QObject>
+
+/**
+ * @brief The LabelingStrategyTest class checks the labeling goals generated by LabelingStrategy.
+ */
+class LabelingStrategyTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief defaultStrategyMinimizesPumpsThenValves the default strategy generates the labeling that PrologTranslationStack has
+     * always generated.
+     */
+    void defaultStrategyMinimizesPumpsThenValves();
+    /**
+     * @brief searchOptionsAndOrderAreGenerated the variable selection, value order, branching, weighted objective and custom order
+     * appear in the goal.
+     */
+    void searchOptionsAndOrderAreGenerated();
+    /**
+     * @brief firstFeasibleHasNoObjective the first feasible mode generates no min/1 option and a different identifying text.
+     */
+    void firstFeasibleHasNoObjective();
+    /**
+     * @brief variableOrderOnlyAcceptsPumpsAndValves setVariableOrder rejects the variables that are not labeled and keeps the previous
+     * order.
+     */
+    void variableOrderOnlyAcceptsPumpsAndValves();
+};
+
+#endif // LABELINGSTRATEGYTEST_H
@@ -0,0 +1,80 @@
+#include <string>
+
+#include <QtTest>
+
+#include "constraintengine/prologexecutor.h"
+
+#include "conflictexplainertest.h"
+#include "constraintdecompositiontest.h"
+#include "constraintpresolvertest.h"
+#include "constraintprogramfiletest.h"
+#include "incrementalprologexecutortest.h"
+#include "labelingstrategytest.h"
+#include "nativeconstraintsolvertest.h"
+#include "prologexecutorpooltest.h"
+#include "prologexecutortest.h"
+#include "prologtranslationstacktest.h"
+#include "routecachetest.h"
+#include "specializationtabletest.h"
+#include "variabletabletest.h"
+
+int main(int argc, char* argv[]) {
+    PrologExecutor::createEngine(std::string(argv[0]));
+
+    int failed = 0;
+    {
+        ConflictExplainerTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        ConstraintDecompositionTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        ConstraintPresolverTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        ConstraintProgramFileTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        IncrementalPrologExecutorTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        LabelingStrategyTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        NativeConstraintSolverTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        PrologExecutorPoolTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        PrologExecutorTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        PrologTranslationStackTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        RouteCacheTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        SpecializationTableTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+    {
+        VariableTableTest test;
+        failed += QTest::qExec(&test, argc, argv);
+    }
+
+    PrologExecutor::destoryEngine();
+    return failed;
+}
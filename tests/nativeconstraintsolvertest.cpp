@@ -0,0 +1,94 @@
+#include "nativeconstraintsolvertest.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QtTest>
+
+#include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+
+#include "constraintengine/nativetranslationstack.h"
+#include "constraintengine/prologtermtranslationstack.h"
+#include "constraintengine/prologtranslationstack.h"
+
+#include "testmachines.h"
+
+void NativeConstraintSolverTest::sameRoutesAsPrologExecutor() {
+    NativeTranslationStack nativeStack;
+    TestMachines::stackValveMachine(&nativeStack);
+    std::unique_ptr<RoutingEngine> native(nativeStack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(native.get(), TestMachines::VALVE_MACHINE_ROUTES));
+
+    PrologTranslationStack prologStack;
+    TestMachines::stackValveMachine(&prologStack);
+    std::unique_ptr<RoutingEngine> prolog(prologStack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(prolog.get(), TestMachines::VALVE_MACHINE_ROUTES));
+}
+
+void NativeConstraintSolverTest::unlabeledVariablesAreGround() {
+    //C_0 has a domain but no restriction, the labeling of P_0 does not fix it
+    NativeTranslationStack nativeStack;
+    PrologTranslationStack prologStack;
+    for(TranslationStack* stack: std::vector<TranslationStack*>{&nativeStack, &prologStack}) {
+        TestMachines::stackDomain(stack, "P_0", -1, 1);
+        TestMachines::stackDomain(stack, "F_0_1", -1, 1);
+        TestMachines::stackDomain(stack, "C_0", 0, 1);
+        TestMachines::stackEqualVariables(stack, "F_0_1", "P_0");
+    }
+
+    TestMachines::State query = {{"F_0_1", 1}};
+
+    std::unique_ptr<RoutingEngine> native(nativeStack.getRoutingEngine());
+    TestMachines::State nativeStates;
+    QVERIFY(native->calculateNewRoute(query, nativeStates));
+    QVERIFY(nativeStates == TestMachines::State({{"P_0", 1}, {"F_0_1", 1}, {"C_0", 0}}));
+
+    std::unique_ptr<RoutingEngine> prolog(prologStack.getRoutingEngine());
+    TestMachines::State prologStates;
+    QVERIFY_EXCEPTION_THROWN(prolog->calculateNewRoute(query, prologStates), std::runtime_error);
+}
+
+void NativeConstraintSolverTest::implicationsGiveSameRoutes() {
+    //C_0 needs P_0 forward, C_1 needs the valve open, and the open valve needs P_0 backwards
+    NativeTranslationStack nativeStack;
+    PrologTranslationStack prologStack;
+    PrologTermTranslationStack termStack;
+    for(TranslationStack* stack: std::vector<TranslationStack*>{&nativeStack, &prologStack, &termStack}) {
+        TestMachines::stackDomain(stack, "P_0", -1, 1);
+        TestMachines::stackDomain(stack, "V_0", 0, 1);
+        TestMachines::stackDomain(stack, "C_0", 0, 1);
+        TestMachines::stackDomain(stack, "C_1", 0, 1);
+
+        TestMachines::stackComparison(stack, "C_0", Equality::equal, 1);
+        TestMachines::stackComparison(stack, "P_0", Equality::equal, 1);
+        stack->stackImplication();
+        stack->addHeadToRestrictions();
+
+        TestMachines::stackComparison(stack, "C_1", Equality::equal, 1);
+        TestMachines::stackComparison(stack, "V_0", Equality::equal, 1);
+        stack->stackImplication();
+        stack->addHeadToRestrictions();
+
+        TestMachines::stackComparison(stack, "V_0", Equality::equal, 1);
+        TestMachines::stackComparison(stack, "P_0", Equality::equal, -1);
+        stack->stackImplication();
+        stack->addHeadToRestrictions();
+    }
+
+    std::vector<TestMachines::Route> routes = {
+        {{{"C_0", 0}, {"C_1", 0}}, {{"C_0", 0}, {"C_1", 0}, {"P_0", 0}, {"V_0", 0}}},
+        {{{"C_0", 1}, {"C_1", 0}}, {{"C_0", 1}, {"C_1", 0}, {"P_0", 1}, {"V_0", 0}}},
+        {{{"C_0", 0}, {"C_1", 1}}, {{"C_0", 0}, {"C_1", 1}, {"P_0", -1}, {"V_0", 1}}},
+        {{{"C_0", 1}, {"C_1", 1}}, {}},
+    };
+
+    std::unique_ptr<RoutingEngine> native(nativeStack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(native.get(), routes));
+    std::unique_ptr<RoutingEngine> prolog(prologStack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(prolog.get(), routes));
+    std::unique_ptr<RoutingEngine> term(termStack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(term.get(), routes));
+}
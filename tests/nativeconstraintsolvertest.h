@@ -0,0 +1,30 @@
+#ifndef NATIVECONSTRAINTSOLVERTEST_H
+#define NATIVECONSTRAINTSOLVERTEST_H
+
+#include <QObject>
+
+/**
+ * @brief The NativeConstraintSolverTest class checks that NativeConstraintSolver returns the same routes as PrologExecutor.
+ */
+class NativeConstraintSolverTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief sameRoutesAsPrologExecutor both engines return the known routes of the valve machine.
+     */
+    void sameRoutesAsPrologExecutor();
+    /**
+     * @brief unlabeledVariablesAreGround a variable that is not a pump nor a valve and that the labeling does not fix gets its smallest
+     * value from the native solver, while PrologExecutor can not read it and throws.
+     */
+    void unlabeledVariablesAreGround();
+    /**
+     * @brief implicationsGiveSameRoutes a machine whose rules are implications returns its known routes with the native solver and
+     * with the programs of PrologTranslationStack and PrologTermTranslationStack.
+     */
+    void implicationsGiveSameRoutes();
+};
+
+#endif // NATIVECONSTRAINTSOLVERTEST_H
@@ -0,0 +1,248 @@
+#include "prologexecutorpooltest.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <QtTest>
+
+#include "constraintengine/prologexecutor.h"
+#include "constraintengine/prologexecutorpool.h"
+#include "constraintengine/prologtermtranslationstack.h"
+#include "constraintengine/prologtranslationstack.h"
+
+#include "testmachines.h"
+
+/**
+ * @brief The BlockedPool class is a pool with one worker that can be kept busy until a gate opens.
+ */
+class BlockedPool : public PrologExecutorPool
+{
+public:
+    BlockedPool(PrologExecutor* executor) :
+        PrologExecutorPool(executor, 1)
+    {
+
+    }
+
+    /**
+     * @brief block queues a task that keeps the worker busy until the gate opens, the queries queued after it wait.
+     * @return a future that is ready once the worker has taken the task.
+     */
+    std::future<void> block(std::shared_future<void> gate) {
+        std::shared_ptr<std::promise<void>> started = std::make_shared<std::promise<void>>();
+        std::future<void> result = started->get_future();
+        submit([gate, started]() {
+            started->set_value();
+            gate.wait();
+        });
+        return result;
+    }
+
+    /**
+     * @brief getNumPendingTasks returns the number of tasks waiting for the worker.
+     */
+    std::size_t getNumPendingTasks() {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return pendingTasks.size();
+    }
+};
+
+/**
+ * @brief The QueryFailure class is the exception thrown by FailingExecutor.
+ */
+class QueryFailure : public std::runtime_error
+{
+public:
+    QueryFailure() :
+        std::runtime_error("query failed")
+    {
+
+    }
+};
+
+/**
+ * @brief The FailingExecutor class loads a machine but throws a QueryFailure for every query.
+ */
+class FailingExecutor : public PrologExecutor
+{
+public:
+    FailingExecutor(PrologTermTranslationStack & stack) :
+        PrologExecutor(stack.getAst(), stack.getRestrictionRoots(), stack.getVariableTable())
+    {
+
+    }
+
+    virtual bool calculateNewRoute(const std::unordered_map<std::string, long long> &,
+                                   std::unordered_map<std::string, long long> &) throw(std::runtime_error)
+    {
+        throw(QueryFailure());
+    }
+};
+
+/**
+ * @brief The Gate class releases the worker of a BlockedPool, at the latest when it is destroyed so a failed test does not hang.
+ */
+class Gate
+{
+public:
+    Gate() :
+        future(promise.get_future().share()), opened(false)
+    {
+
+    }
+
+    ~Gate() {
+        open();
+    }
+
+    void open() {
+        if (!opened) {
+            opened = true;
+            promise.set_value();
+        }
+    }
+
+    std::promise<void> promise;
+    std::shared_future<void> future;
+    bool opened;
+};
+
+static PrologExecutor* makeValveMachineExecutor() {
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    return static_cast<PrologExecutor*>(stack.getRoutingEngine());
+}
+
+static bool isReady(std::future<PrologExecutorPool::AsyncRoute> & future) {
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void PrologExecutorPoolTest::asyncQueriesReturnKnownRoutes() {
+    PrologExecutorPool pool(makeValveMachineExecutor(), 2);
+
+    std::vector<std::future<PrologExecutorPool::AsyncRoute>> futures;
+    for(const TestMachines::Route & route: TestMachines::VALVE_MACHINE_ROUTES) {
+        futures.push_back(pool.calculateNewRouteAsync(route.input));
+    }
+    for(std::size_t i = 0; i < futures.size(); i++) {
+        PrologExecutorPool::AsyncRoute result = futures[i].get();
+        const TestMachines::State & route = TestMachines::VALVE_MACHINE_ROUTES[i].route;
+        QCOMPARE(result.status, route.empty() ? PrologExecutorPool::async_not_found : PrologExecutorPool::async_found);
+        QVERIFY(result.outStates == route);
+    }
+}
+
+void PrologExecutorPoolTest::supersededQueryIsCancelled() {
+    BlockedPool pool(makeValveMachineExecutor());
+    Gate gate;
+    pool.block(gate.future).wait();
+
+    std::future<PrologExecutorPool::AsyncRoute> first = pool.calculateNewRouteAsync({{"C_2", 1}}, "flow");
+    std::future<PrologExecutorPool::AsyncRoute> other = pool.calculateNewRouteAsync({{"F_0_1", 1}}, "other flow");
+    std::future<PrologExecutorPool::AsyncRoute> second = pool.calculateNewRouteAsync({{"C_3", 1}}, "flow");
+
+    QVERIFY(isReady(first));
+    QCOMPARE(first.get().status, PrologExecutorPool::async_cancelled);
+    QCOMPARE(pool.getNumPendingAsync(), (std::size_t) 2);
+    QCOMPARE(pool.getNumPendingTasks(), (std::size_t) 2);
+
+    gate.open();
+    PrologExecutorPool::AsyncRoute result = second.get();
+    QCOMPARE(result.status, PrologExecutorPool::async_found);
+    QVERIFY(result.outStates == TestMachines::VALVE_MACHINE_ROUTES[3].route);
+    QCOMPARE(other.get().status, PrologExecutorPool::async_found);
+    QCOMPARE(pool.getNumPendingAsync(), (std::size_t) 0);
+}
+
+void PrologExecutorPoolTest::cancelPendingCallsBack() {
+    //the callbacks run at the worker, the statuses must outlive the pool
+    std::mutex mutex;
+    std::vector<PrologExecutorPool::AsyncStatus> statuses;
+    PrologExecutorPool::AsyncCallback callback = [&mutex, &statuses](const PrologExecutorPool::AsyncRoute & route) {
+        std::lock_guard<std::mutex> lock(mutex);
+        statuses.push_back(route.status);
+    };
+
+    std::unique_ptr<BlockedPool> pool(new BlockedPool(makeValveMachineExecutor()));
+    Gate gate;
+    pool->block(gate.future).wait();
+
+    std::future<PrologExecutorPool::AsyncRoute> first = pool->calculateNewRouteAsync({{"C_2", 1}}, "flow", callback);
+    std::future<PrologExecutorPool::AsyncRoute> second = pool->calculateNewRouteAsync({{"F_0_1", 1}}, "flow", callback);
+    std::future<PrologExecutorPool::AsyncRoute> kept = pool->calculateNewRouteAsync({{"C_3", 1}}, "other flow", callback);
+
+    //the first one was superseded by the second one
+    QCOMPARE(pool->cancelPending("flow"), (std::size_t) 1);
+    QCOMPARE(pool->cancelPending("flow"), (std::size_t) 0);
+    QCOMPARE(pool->getNumPendingTasks(), (std::size_t) 1);
+    QCOMPARE(first.get().status, PrologExecutorPool::async_cancelled);
+    QCOMPARE(second.get().status, PrologExecutorPool::async_cancelled);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        QVERIFY(statuses == std::vector<PrologExecutorPool::AsyncStatus>(2, PrologExecutorPool::async_cancelled));
+    }
+
+    //the future is fulfilled before the callback is invoked, destroying the pool waits for both
+    gate.open();
+    QCOMPARE(kept.get().status, PrologExecutorPool::async_found);
+    pool.reset();
+    QCOMPARE(statuses.size(), (std::size_t) 3);
+    QCOMPARE(statuses.back(), PrologExecutorPool::async_found);
+}
+
+void PrologExecutorPoolTest::fullQueueCancelsOldest() {
+    BlockedPool pool(makeValveMachineExecutor());
+    pool.setMaxPendingAsync(2);
+    Gate gate;
+    pool.block(gate.future).wait();
+
+    std::future<PrologExecutorPool::AsyncRoute> oldest = pool.calculateNewRouteAsync({{"C_2", 1}});
+    std::future<PrologExecutorPool::AsyncRoute> second = pool.calculateNewRouteAsync({{"C_3", 1}});
+    QVERIFY(!isReady(oldest));
+    std::future<PrologExecutorPool::AsyncRoute> third = pool.calculateNewRouteAsync({{"F_0_1", 1}});
+
+    QVERIFY(isReady(oldest));
+    QCOMPARE(oldest.get().status, PrologExecutorPool::async_cancelled);
+    QCOMPARE(pool.getNumPendingAsync(), (std::size_t) 2);
+    QCOMPARE(pool.getNumPendingTasks(), (std::size_t) 2);
+
+    gate.open();
+    PrologExecutorPool::AsyncRoute result = second.get();
+    QCOMPARE(result.status, PrologExecutorPool::async_found);
+    QVERIFY(result.outStates == TestMachines::VALVE_MACHINE_ROUTES[3].route);
+    result = third.get();
+    QCOMPARE(result.status, PrologExecutorPool::async_found);
+    QVERIFY(result.outStates == TestMachines::VALVE_MACHINE_ROUTES[0].route);
+}
+
+void PrologExecutorPoolTest::failedQueryRethrowsException() {
+    std::mutex mutex;
+    std::vector<PrologExecutorPool::AsyncRoute> routes;
+    PrologExecutorPool::AsyncCallback callback = [&mutex, &routes](const PrologExecutorPool::AsyncRoute & route) {
+        std::lock_guard<std::mutex> lock(mutex);
+        routes.push_back(route);
+    };
+
+    PrologTermTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<PrologExecutorPool> pool(new PrologExecutorPool(new FailingExecutor(stack), 1));
+
+    //the worker keeps solving queries after one fails
+    std::future<PrologExecutorPool::AsyncRoute> first = pool->calculateNewRouteAsync({{"C_2", 1}}, std::string(), callback);
+    std::future<PrologExecutorPool::AsyncRoute> second = pool->calculateNewRouteAsync({{"C_3", 1}}, std::string(), callback);
+    QVERIFY_EXCEPTION_THROWN(first.get(), QueryFailure);
+    QVERIFY_EXCEPTION_THROWN(second.get(), QueryFailure);
+
+    pool.reset();
+    QCOMPARE(routes.size(), (std::size_t) 2);
+    for(const PrologExecutorPool::AsyncRoute & route: routes) {
+        QCOMPARE(route.status, PrologExecutorPool::async_error);
+        QCOMPARE(route.error, std::string("query failed"));
+        QVERIFY(route.outStates.empty());
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef PROLOGEXECUTORPOOLTEST_H
+#define PROLOGEXECUTORPOOLTEST_H
+
+#include <QObject>
+
+/**
+ * @brief The PrologExecutorPoolTest class checks the queue of the asynchronous queries of PrologExecutorPool.
+ *
+ * The only worker of the pool is kept busy until the queries are queued, so which of them are cancelled does not depend on timing.
+ */
+class PrologExecutorPoolTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief asyncQueriesReturnKnownRoutes the asynchronous queries return the known routes of the valve machine.
+     */
+    void asyncQueriesReturnKnownRoutes();
+    /**
+     * @brief supersededQueryIsCancelled a query with the same supersede key cancels the waiting one, and only that one, its task leaves
+     * the queue.
+     */
+    void supersededQueryIsCancelled();
+    /**
+     * @brief cancelPendingCallsBack cancelPending cancels the waiting queries of a key and invokes their callbacks.
+     */
+    void cancelPendingCallsBack();
+    /**
+     * @brief fullQueueCancelsOldest a new query cancels the oldest waiting one when the queue is full, its task leaves the queue.
+     */
+    void fullQueueCancelsOldest();
+    /**
+     * @brief failedQueryRethrowsException the future of a query whose executor throws rethrows the same exception, the callback gets
+     * async_error and the worker keeps solving queries.
+     */
+    void failedQueryRethrowsException();
+};
+
+#endif // PROLOGEXECUTORPOOLTEST_H
@@ -0,0 +1,361 @@
+#include "prologexecutortest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "constraintengine/compiledprogramcache.h"
+#include "constraintengine/labelingstrategy.h"
+#include "constraintengine/prologexecutor.h"
+#include "constraintengine/prologtermtranslationstack.h"
+#include "constraintengine/prologtranslationstack.h"
+#include "constraintengine/variabletable.h"
+
+#include "testmachines.h"
+
+/**
+ * @brief pumpsCost returns the sum of the absolute value of the pumps of a route.
+ */
+static long long pumpsCost(const TestMachines::State & states) {
+    long long cost = 0;
+    for(const auto & state: states) {
+        if (VariableNominator::getVariableType(state.first) == VariableNominator::pump) {
+            cost += std::abs(state.second);
+        }
+    }
+    return cost;
+}
+
+/**
+ * @brief valvesCost returns the number of open valves of a route.
+ */
+static long long valvesCost(const TestMachines::State & states) {
+    long long cost = 0;
+    for(const auto & state: states) {
+        if (VariableNominator::getVariableType(state.first) == VariableNominator::valve) {
+            cost += std::min(state.second, 1LL);
+        }
+    }
+    return cost;
+}
+
+void PrologExecutorTest::savedRouteCacheNeedsSameMachine() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::string path = dir.filePath("routes.cache").toStdString();
+
+    PrologTermTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    PrologExecutor executor(stack.getAst(), stack.getRestrictionRoots(), stack.getVariableTable());
+    executor.setRouteCacheCapacity(16);
+    QVERIFY(TestMachines::hasRoutes(&executor, TestMachines::VALVE_MACHINE_ROUTES));
+    QVERIFY(executor.saveRouteCache(path));
+
+    PrologExecutor same(stack.getAst(), stack.getRestrictionRoots(), stack.getVariableTable());
+    same.setRouteCacheCapacity(16);
+    QVERIFY(same.loadRouteCache(path));
+    QVERIFY(TestMachines::hasRoutes(&same, TestMachines::VALVE_MACHINE_ROUTES));
+    QCOMPARE(same.getRouteCacheStats().hits, (unsigned long long) TestMachines::VALVE_MACHINE_ROUTES.size());
+
+    //C_4 is an argument more of the predicate, the positions of the variables after it change
+    std::set<std::string> names = stack.getVarTable();
+    names.insert("C_4");
+    PrologExecutor moreVariables(stack.getAst(), stack.getRestrictionRoots(), VariableTable(names));
+    moreVariables.setRouteCacheCapacity(16);
+    QVERIFY(moreVariables.getProgramHash() == executor.getProgramHash());
+    QVERIFY(!moreVariables.loadRouteCache(path));
+    QCOMPARE(moreVariables.getRouteCacheStats().size, (std::size_t) 0);
+
+    PrologTranslationStack defaultStack;
+    TestMachines::stackValveMachine(&defaultStack);
+    std::unique_ptr<PrologExecutor> defaultExecutor(static_cast<PrologExecutor*>(defaultStack.getRoutingEngine()));
+    defaultExecutor->setRouteCacheCapacity(16);
+    QVERIFY(TestMachines::hasRoutes(defaultExecutor.get(), TestMachines::VALVE_MACHINE_ROUTES));
+    QVERIFY(defaultExecutor->saveRouteCache(path));
+
+    LabelingStrategy strategy;
+    strategy.setObjective(LabelingStrategy::weighted_objective);
+    strategy.setWeights(1, 10);
+    PrologTranslationStack weightedStack;
+    weightedStack.setLabelingStrategy(strategy);
+    TestMachines::stackValveMachine(&weightedStack);
+    std::unique_ptr<PrologExecutor> weightedExecutor(static_cast<PrologExecutor*>(weightedStack.getRoutingEngine()));
+    weightedExecutor->setRouteCacheCapacity(16);
+    QVERIFY(!weightedExecutor->loadRouteCache(path));
+    QCOMPARE(weightedExecutor->getRouteCacheStats().size, (std::size_t) 0);
+}
+
+void PrologExecutorTest::budgetedQueriesRunToCompletion() {
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<PrologExecutor> executor(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+
+    //an inference limit of 2^31 or more must not be truncated to a negative limit
+    for(bool returnBest: {false, true}) {
+        for(long long inferenceLimit: {0LL, 3000000000LL}) {
+            PrologExecutor::QueryBudget budget;
+            budget.timeLimit = 60.0;
+            budget.inferenceLimit = inferenceLimit;
+            budget.returnBest = returnBest;
+
+            for(const TestMachines::Route & route: TestMachines::VALVE_MACHINE_ROUTES) {
+                TestMachines::State outStates;
+                PrologExecutor::RouteStatus status = executor->calculateNewRouteWithBudget(route.input, outStates, budget);
+                if (route.route.empty()) {
+                    QCOMPARE(status, PrologExecutor::route_not_found);
+                } else {
+                    QCOMPARE(status, PrologExecutor::route_found);
+                    QVERIFY(outStates == route.route);
+                }
+            }
+        }
+    }
+}
+
+void PrologExecutorTest::exhaustedBudgetTimesOut() {
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<PrologExecutor> executor(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+
+    PrologExecutor::QueryBudget budget;
+    budget.timeLimit = 0;
+    budget.inferenceLimit = 1;
+    budget.returnBest = false;
+
+    TestMachines::State outStates;
+    QCOMPARE(executor->calculateNewRouteWithBudget({{"C_3", 1}}, outStates, budget), PrologExecutor::route_timed_out);
+    QVERIFY(outStates.empty());
+}
+
+void PrologExecutorTest::compiledProgramIsReused() {
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    stack.setCompiledCacheDir(cacheDir.path().toStdString());
+
+    CompiledProgramCache cache(cacheDir.path().toStdString());
+    std::string key = cache.makeKey(stack.getAst().hash(stack.getRestrictionRoots()), stack.getVarTable());
+    QVERIFY(!cache.contains(key));
+
+    {
+        std::unique_ptr<RoutingEngine> compiled(stack.getRoutingEngine());
+        QVERIFY(cache.contains(key));
+        QVERIFY(TestMachines::hasRoutes(compiled.get(), TestMachines::VALVE_MACHINE_ROUTES));
+    }
+
+    std::unique_ptr<RoutingEngine> loaded(stack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(loaded.get(), TestMachines::VALVE_MACHINE_ROUTES));
+}
+
+void PrologExecutorTest::executorsShareCompiledProgram() {
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    stack.setCompiledCacheDir(cacheDir.path().toStdString());
+
+    std::unique_ptr<RoutingEngine> first(stack.getRoutingEngine());
+    std::unique_ptr<RoutingEngine> second(stack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(first.get(), TestMachines::VALVE_MACHINE_ROUTES));
+
+    //destroying an executor must not unload the program of the others
+    first.reset();
+    std::unique_ptr<RoutingEngine> third(stack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(second.get(), TestMachines::VALVE_MACHINE_ROUTES));
+    second.reset();
+    QVERIFY(TestMachines::hasRoutes(third.get(), TestMachines::VALVE_MACHINE_ROUTES));
+}
+
+void PrologExecutorTest::specializedQueriesReturnKnownRoutes() {
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<PrologExecutor> executor(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+    executor->setSpecialization(2);
+
+    //the known routes have five signatures, all of them reach the threshold in the second pass
+    for(int pass = 0; pass < 3; pass++) {
+        QVERIFY(TestMachines::hasRoutes(executor.get(), TestMachines::VALVE_MACHINE_ROUTES));
+    }
+    QCOMPARE(executor->getNumSpecializations(), (std::size_t) 5);
+}
+
+void PrologExecutorTest::bigSignatureIsNotSpecialized() {
+    //a pump of its own with more values than MAX_SPECIALIZED_CLAUSES
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    TestMachines::stackDomain(&stack, "P_9", -MAX_SPECIALIZED_CLAUSES, MAX_SPECIALIZED_CLAUSES);
+    std::unique_ptr<PrologExecutor> executor(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+    executor->setSpecialization(1);
+
+    std::vector<TestMachines::Route> routes = {
+        {{{"P_9", 700}}, {{"P_0", 0}, {"P_1", 0}, {"V_0", 0}, {"F_0_1", 0}, {"F_1_2", 0}, {"F_1_3", 0}, {"C_2", 0}, {"C_3", 0},
+                          {"P_9", 700}}},
+        {{{"C_2", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 1}, {"F_0_1", 1}, {"F_1_2", 1}, {"F_1_3", 0}, {"C_2", 1}, {"C_3", 0},
+                        {"P_9", 0}}},
+    };
+    for(int pass = 0; pass < 3; pass++) {
+        QVERIFY(TestMachines::hasRoutes(executor.get(), routes));
+    }
+    QCOMPARE(executor->getNumSpecializations(), (std::size_t) 1);
+}
+
+void PrologExecutorTest::warmStartReturnsKnownRoutes() {
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<PrologExecutor> executor(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+    executor->setWarmStart(true);
+
+    QVERIFY(TestMachines::hasRoutes(executor.get(), TestMachines::VALVE_MACHINE_ROUTES));
+
+    //the route of C_2 is consistent with F_0_1 = 1, its cost bounds the next query and the valve must still be closed
+    const std::vector<TestMachines::Route> & routes = TestMachines::VALVE_MACHINE_ROUTES;
+    QVERIFY(TestMachines::hasRoutes(executor.get(), {routes[2], routes[0], routes[3], routes[0]}));
+
+    executor->clearWarmStart();
+    QVERIFY(TestMachines::hasRoutes(executor.get(), {routes[0], routes[2]}));
+}
+
+void PrologExecutorTest::warmStartKeepsWeightedOptimum() {
+    //C_0 needs P_0, and a closed valve needs P_1: with C_1 = 1 the only routes open the valve, with C_1 = 0 closing it and using
+    //both pumps is cheaper, but has more pumps than the previous route
+    PrologTranslationStack stack;
+    TestMachines::stackDomain(&stack, "C_0", 0, 1);
+    TestMachines::stackDomain(&stack, "C_1", 0, 1);
+    TestMachines::stackDomain(&stack, "P_0", -1, 1);
+    TestMachines::stackDomain(&stack, "P_1", -1, 1);
+    TestMachines::stackDomain(&stack, "V_0", 0, 2);
+
+    TestMachines::stackComparison(&stack, "C_0", Equality::not_equal, 1);
+    TestMachines::stackComparison(&stack, "P_0", Equality::not_equal, 0);
+    stack.stackBooleanConjuction(Conjunction::predicate_or);
+    stack.addHeadToRestrictions();
+
+    TestMachines::stackComparison(&stack, "V_0", Equality::not_equal, 0);
+    TestMachines::stackComparison(&stack, "P_1", Equality::not_equal, 0);
+    stack.stackBooleanConjuction(Conjunction::predicate_or);
+    stack.addHeadToRestrictions();
+
+    TestMachines::stackComparison(&stack, "C_1", Equality::not_equal, 1);
+    TestMachines::stackComparison(&stack, "P_1", Equality::equal, 0);
+    stack.stackBooleanConjuction(Conjunction::predicate_or);
+    stack.addHeadToRestrictions();
+
+    LabelingStrategy strategy;
+    strategy.setObjective(LabelingStrategy::weighted_objective);
+    strategy.setWeights(1, 10);
+    stack.setLabelingStrategy(strategy);
+
+    std::unique_ptr<PrologExecutor> cold(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+    std::unique_ptr<PrologExecutor> warm(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+    warm->setWarmStart(true);
+
+    TestMachines::State outStates;
+    QVERIFY(warm->calculateNewRoute({{"C_0", 1}, {"C_1", 1}}, outStates));
+    QCOMPARE(pumpsCost(outStates), 1LL);
+    QCOMPARE(valvesCost(outStates), 1LL);
+
+    TestMachines::State second = {{"C_0", 1}, {"C_1", 0}};
+    TestMachines::State expected;
+    QVERIFY(cold->calculateNewRoute(second, expected));
+    outStates.clear();
+    QVERIFY(warm->calculateNewRoute(second, outStates));
+    QCOMPARE(pumpsCost(outStates), 2LL);
+    QCOMPARE(valvesCost(outStates), 0LL);
+    QCOMPARE(pumpsCost(expected), 2LL);
+    QCOMPARE(valvesCost(expected), 0LL);
+}
+
+void PrologExecutorTest::budgetedQueryRecordsWarmStart() {
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<PrologExecutor> executor(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+    executor->setWarmStart(true);
+    executor->setSpecialization(1);
+
+    const std::vector<TestMachines::Route> & routes = TestMachines::VALVE_MACHINE_ROUTES;
+    PrologExecutor::QueryBudget budget;
+    budget.timeLimit = 60.0;
+    budget.inferenceLimit = 0;
+    budget.returnBest = false;
+    TestMachines::State outStates;
+    QCOMPARE(executor->calculateNewRouteWithBudget(routes[2].input, outStates, budget), PrologExecutor::route_found);
+    QVERIFY(outStates == routes[2].route);
+
+    //seeded with the route of C_2, so the query is not specialized
+    QVERIFY(TestMachines::hasRoutes(executor.get(), {routes[0]}));
+    QCOMPARE(executor->getNumSpecializations(), (std::size_t) 0);
+
+    executor->clearWarmStart();
+    QVERIFY(TestMachines::hasRoutes(executor.get(), {routes[0]}));
+    QCOMPARE(executor->getNumSpecializations(), (std::size_t) 1);
+}
+
+void PrologExecutorTest::labelingStrategiesReturnKnownRoutes() {
+    LabelingStrategy weighted;
+    weighted.setObjective(LabelingStrategy::weighted_objective);
+    weighted.setWeights(2, 1);
+
+    PrologTranslationStack weightedStack;
+    TestMachines::stackValveMachine(&weightedStack);
+    weightedStack.setLabelingStrategy(weighted);
+    std::unique_ptr<RoutingEngine> weightedExecutor(weightedStack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(weightedExecutor.get(), TestMachines::VALVE_MACHINE_ROUTES));
+
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<PrologExecutor> executor(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+
+    LabelingStrategy firstFeasible;
+    firstFeasible.setMode(LabelingStrategy::first_feasible_mode);
+    for(const TestMachines::Route & route: TestMachines::VALVE_MACHINE_ROUTES) {
+        TestMachines::State outStates;
+        bool found = executor->calculateNewRouteWithStrategy(route.input, outStates, weighted);
+        QCOMPARE(found, !route.route.empty());
+        QVERIFY(!found || outStates == route.route);
+
+        outStates.clear();
+        QCOMPARE(executor->calculateNewRouteWithStrategy(route.input, outStates, firstFeasible), !route.route.empty());
+    }
+}
+
+void PrologExecutorTest::alternativeRoutesFromBestToWorst() {
+    PrologTranslationStack stack;
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<PrologExecutor> executor(static_cast<PrologExecutor*>(stack.getRoutingEngine()));
+
+    const TestMachines::Route & known = TestMachines::VALVE_MACHINE_ROUTES[2];
+    std::vector<TestMachines::State> routes;
+    QCOMPARE(executor->calculateAlternativeRoutes(known.input, 1, routes), PrologExecutor::route_found);
+    QCOMPARE(routes.size(), (std::size_t) 1);
+    QVERIFY(routes[0] == known.route);
+
+    //the routes of the same cost can come in any order
+    QCOMPARE(executor->calculateAlternativeRoutes(known.input, 5, routes), PrologExecutor::route_found);
+    QCOMPARE(routes.size(), (std::size_t) 3);
+    QVERIFY(routes[0] == known.route);
+    TestMachines::State backward = known.route;
+    backward["P_1"] = -1;
+    TestMachines::State forward = known.route;
+    forward["P_1"] = 1;
+    QVERIFY((routes[1] == backward && routes[2] == forward) || (routes[1] == forward && routes[2] == backward));
+
+    QCOMPARE(executor->calculateAlternativeRoutes(TestMachines::VALVE_MACHINE_ROUTES[4].input, 5, routes), PrologExecutor::route_not_found);
+    QVERIFY(routes.empty());
+
+    //an inference limit that does not fit in 32 bits caps nothing
+    PrologExecutor::QueryBudget budget;
+    budget.timeLimit = 60.0;
+    budget.inferenceLimit = 3000000000LL;
+    budget.returnBest = false;
+    QCOMPARE(executor->calculateAlternativeRoutes(known.input, 5, routes, budget), PrologExecutor::route_found);
+    QCOMPARE(routes.size(), (std::size_t) 3);
+}
@@ -0,0 +1,75 @@
+#ifndef PROLOGEXECUTORTEST_H
+#define PROLOGEXECUTORTEST_H
+
+#include <QObject>
+
+/**
+ * @brief The PrologExecutorTest class checks the queries and options of PrologExecutor beyond a plain calculateNewRoute.
+ */
+class PrologExecutorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief savedRouteCacheNeedsSameMachine a saved route cache is only loaded by an executor with the same predicate, variables and
+     * labeling.
+     */
+    void savedRouteCacheNeedsSameMachine();
+    /**
+     * @brief budgetedQueriesRunToCompletion a query with a budget that is not exhausted returns the known route, or no route, with and
+     * without returnBest and with an inference limit that does not fit in 32 bits.
+     */
+    void budgetedQueriesRunToCompletion();
+    /**
+     * @brief exhaustedBudgetTimesOut a query that needs more inferences than its budget times out.
+     */
+    void exhaustedBudgetTimesOut();
+    /**
+     * @brief compiledProgramIsReused the program compiled by the first executor of a machine is found by the next one and both return
+     * the known routes.
+     */
+    void compiledProgramIsReused();
+    /**
+     * @brief executorsShareCompiledProgram the executors loaded from the same CompiledProgramCache key keep working when the others are
+     * destroyed.
+     */
+    void executorsShareCompiledProgram();
+    /**
+     * @brief specializedQueriesReturnKnownRoutes the queries of the valve machine return the same routes before and after their
+     * signatures are specialized.
+     */
+    void specializedQueriesReturnKnownRoutes();
+    /**
+     * @brief bigSignatureIsNotSpecialized a signature whose grounded variables allow more than MAX_SPECIALIZED_CLAUSES combinations
+     * keeps calling the original predicate, and the other signatures are still specialized.
+     */
+    void bigSignatureIsNotSpecialized();
+    /**
+     * @brief warmStartReturnsKnownRoutes an executor seeded with its previous solution returns the known routes, also when the previous
+     * pumps and valves are consistent with the new query and bound its cost.
+     */
+    void warmStartReturnsKnownRoutes();
+    /**
+     * @brief warmStartKeepsWeightedOptimum a warm start with a weighted objective returns the same cost as a cold query, also when
+     * the previous solution has fewer pumps than the new optimum.
+     */
+    void warmStartKeepsWeightedOptimum();
+    /**
+     * @brief budgetedQueryRecordsWarmStart the route of a query with a budget seeds the next query of a warm executor, that skips the
+     * specialized predicates.
+     */
+    void budgetedQueryRecordsWarmStart();
+    /**
+     * @brief labelingStrategiesReturnKnownRoutes the routes of the valve machine are the only optimum of a weighted objective too, set at
+     * the stack or chosen per query, and a first feasible query finds a route for the same inputs.
+     */
+    void labelingStrategiesReturnKnownRoutes();
+    /**
+     * @brief alternativeRoutesFromBestToWorst filling C_2 fixes every pump and valve but P_1, the alternatives are the known route and
+     * then the two routes that also run P_1.
+     */
+    void alternativeRoutesFromBestToWorst();
+};
+
+#endif // PROLOGEXECUTORTEST_H
@@ -0,0 +1,54 @@
+#include "prologtranslationstacktest.h"
+
+#include <memory>
+#include <stdexcept>
+
+#include <QtTest>
+
+#include "constraintengine/prologtranslationstack.h"
+
+#include "testmachines.h"
+
+void PrologTranslationStackTest::streamedProgramReturnsKnownRoutes() {
+    PrologTranslationStack stack;
+    stack.setStreaming(true);
+    TestMachines::stackValveMachine(&stack);
+    QVERIFY(stack.getRestrictionRoots().empty());
+
+    std::unique_ptr<RoutingEngine> executor(stack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(executor.get(), TestMachines::VALVE_MACHINE_ROUTES));
+}
+
+void PrologTranslationStackTest::streamedProgramLoadsEveryEngine() {
+    PrologTranslationStack stack;
+    stack.setStreaming(true);
+    TestMachines::stackValveMachine(&stack);
+
+    std::unique_ptr<RoutingEngine> first(stack.getRoutingEngine());
+    std::unique_ptr<RoutingEngine> second(stack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(first.get(), TestMachines::VALVE_MACHINE_ROUTES));
+
+    first.reset();
+    QVERIFY(TestMachines::hasRoutes(second.get(), TestMachines::VALVE_MACHINE_ROUTES));
+}
+
+void PrologTranslationStackTest::clearDiscardsStreamedProgram() {
+    //a single pump that feeds a tube
+    PrologTranslationStack stack;
+    stack.setStreaming(true);
+    TestMachines::stackDomain(&stack, "P_0", -1, 1);
+    TestMachines::stackDomain(&stack, "F_0_1", -1, 1);
+    TestMachines::stackEqualVariables(&stack, "F_0_1", "P_0");
+    std::unique_ptr<RoutingEngine> first(stack.getRoutingEngine());
+
+    QVERIFY_EXCEPTION_THROWN(TestMachines::stackValveMachine(&stack), std::runtime_error);
+
+    stack.clear();
+    TestMachines::stackValveMachine(&stack);
+    std::unique_ptr<RoutingEngine> second(stack.getRoutingEngine());
+    QVERIFY(TestMachines::hasRoutes(second.get(), TestMachines::VALVE_MACHINE_ROUTES));
+
+    TestMachines::State outStates;
+    QVERIFY(first->calculateNewRoute({{"F_0_1", -1}}, outStates));
+    QCOMPARE(outStates["P_0"], -1LL);
+}
@@ -0,0 +1,31 @@
+#ifndef PROLOGTRANSLATIONSTACKTEST_H
+#define PROLOGTRANSLATIONSTACKTEST_H
+
+#include <QObject>
+
+/**
+ * @brief The PrologTranslationStackTest class checks the streaming mode of PrologTranslationStack against the program generated in
+ * memory.
+ */
+class PrologTranslationStackTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief streamedProgramReturnsKnownRoutes the valve machine streamed to a file returns its known routes.
+     */
+    void streamedProgramReturnsKnownRoutes();
+    /**
+     * @brief streamedProgramLoadsEveryEngine every engine of a streamed program has the whole machine, also after the first one is
+     * destroyed.
+     */
+    void streamedProgramLoadsEveryEngine();
+    /**
+     * @brief clearDiscardsStreamedProgram a finished streamed program rejects more restrictions until clear() is called, and then
+     * another machine can be streamed.
+     */
+    void clearDiscardsStreamedProgram();
+};
+
+#endif // PROLOGTRANSLATIONSTACKTEST_H
@@ -0,0 +1,109 @@
+#include "routecachetest.h"
+
+#include <string>
+#include <vector>
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "constraintengine/routecache.h"
+
+void RouteCacheTest::lookupIgnoresInputOrder() {
+    RouteCache cache(4);
+    cache.insert({2, 0}, {1, -1}, true, {-1, 7, 1});
+    cache.insert({1}, {5}, false, {});
+
+    bool found = false;
+    std::vector<long long> outStates;
+    QVERIFY(cache.lookup({0, 2}, {-1, 1}, found, outStates));
+    QVERIFY(found);
+    QVERIFY(outStates == std::vector<long long>({-1, 7, 1}));
+
+    //the same positions with other values are another key
+    QVERIFY(!cache.lookup({0, 2}, {1, -1}, found, outStates));
+
+    outStates.clear();
+    QVERIFY(cache.lookup({1}, {5}, found, outStates));
+    QVERIFY(!found);
+    QVERIFY(outStates.empty());
+
+    RouteCache::Stats stats = cache.getStats();
+    QCOMPARE(stats.hits, 2ULL);
+    QCOMPARE(stats.misses, 1ULL);
+    QCOMPARE(stats.size, (std::size_t) 2);
+}
+
+void RouteCacheTest::leastRecentlyUsedIsEvicted() {
+    RouteCache cache(2);
+    bool found;
+    std::vector<long long> outStates;
+
+    cache.insert({0}, {1}, true, {1});
+    cache.insert({0}, {2}, true, {2});
+    //0 = 1 is now more recent than 0 = 2
+    QVERIFY(cache.lookup({0}, {1}, found, outStates));
+    cache.insert({0}, {3}, true, {3});
+
+    QVERIFY(!cache.lookup({0}, {2}, found, outStates));
+    QVERIFY(cache.lookup({0}, {1}, found, outStates));
+    QVERIFY(cache.lookup({0}, {3}, found, outStates));
+    QCOMPARE(cache.getStats().evictions, 1ULL);
+
+    //0 = 3 is the most recent, reducing the capacity keeps only that one
+    cache.setCapacity(1);
+    QVERIFY(!cache.lookup({0}, {1}, found, outStates));
+    QVERIFY(cache.lookup({0}, {3}, found, outStates));
+    QVERIFY(outStates == std::vector<long long>({3}));
+
+    RouteCache::Stats stats = cache.getStats();
+    QCOMPARE(stats.evictions, 2ULL);
+    QCOMPARE(stats.size, (std::size_t) 1);
+    QCOMPARE(stats.capacity, (std::size_t) 1);
+}
+
+void RouteCacheTest::loadKeepsRecencyOrder() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::string path = dir.filePath("routes.cache").toStdString();
+
+    RouteCache cache(3);
+    bool found;
+    std::vector<long long> outStates;
+    cache.insert({0}, {1}, true, {1});
+    cache.insert({0}, {2}, true, {2});
+    cache.insert({0}, {3}, false, {});
+    QVERIFY(cache.lookup({0}, {1}, found, outStates));
+    QVERIFY(cache.saveToFile(path, "machine"));
+
+    //from the least to the most recently used: 0 = 2, 0 = 3, 0 = 1
+    RouteCache loaded(2);
+    QVERIFY(loaded.loadFromFile(path, "machine"));
+    QVERIFY(!loaded.lookup({0}, {2}, found, outStates));
+    QVERIFY(loaded.lookup({0}, {3}, found, outStates));
+    QVERIFY(!found);
+    outStates.clear();
+    QVERIFY(loaded.lookup({0}, {1}, found, outStates));
+    QVERIFY(found);
+    QVERIFY(outStates == std::vector<long long>({1}));
+}
+
+void RouteCacheTest::loadRejectsOtherMachine() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::string path = dir.filePath("routes.cache").toStdString();
+
+    RouteCache cache(2);
+    cache.insert({0}, {1}, true, {1});
+    QVERIFY(cache.saveToFile(path, "machine"));
+
+    RouteCache other(2);
+    other.insert({1}, {1}, true, {4});
+    QVERIFY(!other.loadFromFile(path, "another machine"));
+    QVERIFY(!other.loadFromFile(dir.filePath("missing.cache").toStdString(), "machine"));
+
+    bool found;
+    std::vector<long long> outStates;
+    QVERIFY(!other.lookup({0}, {1}, found, outStates));
+    QVERIFY(other.lookup({1}, {1}, found, outStates));
+    QCOMPARE(other.getStats().size, (std::size_t) 1);
+}
@@ -0,0 +1,34 @@
+#ifndef ROUTECACHETEST_H
+#define ROUTECACHETEST_H
+
+#include <QObject>
+
+/**
+ * @brief The RouteCacheTest class checks the eviction order and the files of RouteCache.
+ */
+class RouteCacheTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief lookupIgnoresInputOrder the same grounded variables in a different order are the same key, also for the results
+     * without solution.
+     */
+    void lookupIgnoresInputOrder();
+    /**
+     * @brief leastRecentlyUsedIsEvicted a lookup makes an entry the most recently used, so a full cache evicts the entry that was
+     * neither inserted nor found last, also when the capacity is reduced.
+     */
+    void leastRecentlyUsedIsEvicted();
+    /**
+     * @brief loadKeepsRecencyOrder a saved cache loaded into a smaller one keeps the most recently used entries.
+     */
+    void loadKeepsRecencyOrder();
+    /**
+     * @brief loadRejectsOtherMachine a file saved with another machine hash is not loaded and the cache is left intact.
+     */
+    void loadRejectsOtherMachine();
+};
+
+#endif // ROUTECACHETEST_H
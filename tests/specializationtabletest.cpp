@@ -0,0 +1,68 @@
+#include "specializationtabletest.h"
+
+#include <string>
+#include <vector>
+
+#include <QtTest>
+
+#include "constraintengine/specializationtable.h"
+
+void SpecializationTableTest::thresholdStartsSpecialization() {
+    SpecializationTable table(3, 16, "spec");
+    std::vector<int> signature;
+    std::string name;
+    std::vector<int> argIndex;
+
+    QCOMPARE(table.lookup({3, 1}, signature, name, argIndex), SpecializationTable::not_specialized);
+    QCOMPARE(table.lookup({1, 3, 3}, signature, name, argIndex), SpecializationTable::not_specialized);
+    QVERIFY(signature == std::vector<int>({1, 3}));
+
+    QCOMPARE(table.lookup({1, 3}, signature, name, argIndex), SpecializationTable::must_specialize);
+    QCOMPARE(name, std::string("spec0"));
+    //while it is being created the queries call the original predicate
+    QCOMPARE(table.lookup({3, 1}, signature, name, argIndex), SpecializationTable::not_specialized);
+    QCOMPARE(table.getNumSpecializations(), (std::size_t) 0);
+
+    table.setCreated({1, 3}, 4);
+    name.clear();
+    QCOMPARE(table.lookup({3, 1}, signature, name, argIndex), SpecializationTable::specialized);
+    QCOMPARE(name, std::string("spec0"));
+    QVERIFY(argIndex == std::vector<int>({2, 0, 3, 1}));
+    QCOMPARE(table.getNumSpecializations(), (std::size_t) 1);
+    QVERIFY(table.getNames() == std::vector<std::string>({"spec0"}));
+}
+
+void SpecializationTableTest::failedSignatureIsNotSpecialized() {
+    SpecializationTable table(1, 16, "spec");
+    std::vector<int> signature;
+    std::string name;
+    std::vector<int> argIndex;
+
+    QCOMPARE(table.lookup({0}, signature, name, argIndex), SpecializationTable::must_specialize);
+    table.setFailed(signature);
+    for(int i = 0; i < 3; i++) {
+        QCOMPARE(table.lookup({0}, signature, name, argIndex), SpecializationTable::not_specialized);
+    }
+    QCOMPARE(table.getNumSpecializations(), (std::size_t) 0);
+
+    //other signatures are still specialized, with the next name
+    QCOMPARE(table.lookup({1}, signature, name, argIndex), SpecializationTable::must_specialize);
+    QCOMPARE(name, std::string("spec1"));
+}
+
+void SpecializationTableTest::maxSpecializationsIsRespected() {
+    SpecializationTable table(1, 2, "spec");
+    std::vector<int> signature;
+    std::string name;
+    std::vector<int> argIndex;
+
+    QCOMPARE(table.lookup({0}, signature, name, argIndex), SpecializationTable::must_specialize);
+    table.setCreated(signature, 3);
+    QCOMPARE(table.lookup({1}, signature, name, argIndex), SpecializationTable::must_specialize);
+    table.setCreated(signature, 3);
+    QCOMPARE(table.lookup({2}, signature, name, argIndex), SpecializationTable::not_specialized);
+    QCOMPARE(table.getNumSpecializations(), (std::size_t) 2);
+
+    table.setThreshold(0, 2);
+    QCOMPARE(table.lookup({0}, signature, name, argIndex), SpecializationTable::not_specialized);
+}
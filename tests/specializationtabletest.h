@@ -0,0 +1,30 @@
+#ifndef SPECIALIZATIONTABLETEST_H
+#define SPECIALIZATIONTABLETEST_H
+
+#include <QObject>
+
+/**
+ * @brief The SpecializationTableTest class checks when a SpecializationTable asks for a specialized predicate and what it returns
+ * afterwards.
+ */
+class SpecializationTableTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief thresholdStartsSpecialization the query that reaches the threshold must specialize, the next ones get the predicate once
+     * it is created, with the grounded variables as its first arguments.
+     */
+    void thresholdStartsSpecialization();
+    /**
+     * @brief failedSignatureIsNotSpecialized a signature whose predicate could not be created always calls the original predicate.
+     */
+    void failedSignatureIsNotSpecialized();
+    /**
+     * @brief maxSpecializationsIsRespected no more predicates than the maximum are asked for, and a zero threshold asks for none.
+     */
+    void maxSpecializationsIsRespected();
+};
+
+#endif // SPECIALIZATIONTABLETEST_H
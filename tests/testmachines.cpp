@@ -0,0 +1,88 @@
+#include "testmachines.h"
+
+const int TestMachines::VALVE_MACHINE_F_1_3_RULE = 10;
+
+const std::vector<TestMachines::Route> TestMachines::VALVE_MACHINE_ROUTES = {
+    {{{"F_0_1", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 0}, {"F_0_1", 1}, {"F_1_2", 0}, {"F_1_3", 0}, {"C_2", 0}, {"C_3", 0}}},
+    {{{"F_0_1", -1}}, {{"P_0", -1}, {"P_1", 0}, {"V_0", 0}, {"F_0_1", -1}, {"F_1_2", 0}, {"F_1_3", 0}, {"C_2", 0}, {"C_3", 0}}},
+    {{{"C_2", 1}}, {{"P_0", 1}, {"P_1", 0}, {"V_0", 1}, {"F_0_1", 1}, {"F_1_2", 1}, {"F_1_3", 0}, {"C_2", 1}, {"C_3", 0}}},
+    {{{"C_3", 1}}, {{"P_0", 0}, {"P_1", 1}, {"V_0", 2}, {"F_0_1", 0}, {"F_1_2", 0}, {"F_1_3", 1}, {"C_2", 0}, {"C_3", 1}}},
+    {{{"C_2", 1}, {"C_3", 1}}, {}},
+    {{{"F_0_1", -1}, {"C_2", 1}}, {}},
+};
+
+void TestMachines::stackValveMachine(TranslationStack* stack) {
+    stackDomain(stack, "P_0", -1, 1);
+    stackDomain(stack, "P_1", -1, 1);
+    stackDomain(stack, "V_0", 0, 2);
+    stackDomain(stack, "F_0_1", -1, 1);
+    stackDomain(stack, "F_1_2", 0, 1);
+    stackDomain(stack, "F_1_3", 0, 1);
+    stackDomain(stack, "C_2", 0, 1);
+    stackDomain(stack, "C_3", 0, 1);
+
+    stackEqualVariables(stack, "F_0_1", "P_0");
+    stackValveTube(stack, "V_0", 1, "F_1_2", "P_0");
+    stackValveTube(stack, "V_0", 2, "F_1_3", "P_1");
+    stackContainer(stack, "C_2", "F_1_2");
+    stackContainer(stack, "C_3", "F_1_3");
+}
+
+bool TestMachines::hasRoutes(RoutingEngine* engine, const std::vector<Route> & routes) {
+    for(const Route & route: routes) {
+        State outStates;
+        bool found = engine->calculateNewRoute(route.input, outStates);
+        if (found != !route.route.empty() || (found && outStates != route.route)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestMachines::stackDomain(TranslationStack* stack, const std::string & name, int min, int max) {
+    stack->stackNumber(min);
+    stack->stackNumber(max);
+    stack->stackVariable(name);
+    stack->stackVarDomain();
+    stack->addHeadToRestrictions();
+}
+
+void TestMachines::stackEqualVariables(TranslationStack* stack, const std::string & left, const std::string & right) {
+    stackVariables(stack, left, Equality::equal, right);
+    stack->addHeadToRestrictions();
+}
+
+void TestMachines::stackValveTube(TranslationStack* stack, const std::string & valve, int position, const std::string & tube,
+                                  const std::string & pump)
+{
+    stackComparison(stack, valve, Equality::equal, position);
+    stackVariables(stack, tube, Equality::equal, pump);
+    stack->stackBooleanConjuction(Conjunction::predicate_and);
+
+    stackComparison(stack, valve, Equality::not_equal, position);
+    stackComparison(stack, tube, Equality::equal, 0);
+    stack->stackBooleanConjuction(Conjunction::predicate_and);
+
+    stack->stackBooleanConjuction(Conjunction::predicate_or);
+    stack->addHeadToRestrictions();
+}
+
+void TestMachines::stackContainer(TranslationStack* stack, const std::string & container, const std::string & tube) {
+    stack->stackVariable(container);
+    stack->stackVariable(tube);
+    stack->stackArithmeticUnaryOperation(RuleUnaryOperation::absolute_value);
+    stack->stackEquality(Equality::equal);
+    stack->addHeadToRestrictions();
+}
+
+void TestMachines::stackComparison(TranslationStack* stack, const std::string & name, Equality::ComparatorOp op, int value) {
+    stack->stackVariable(name);
+    stack->stackNumber(value);
+    stack->stackEquality(op);
+}
+
+void TestMachines::stackVariables(TranslationStack* stack, const std::string & left, Equality::ComparatorOp op, const std::string & right) {
+    stack->stackVariable(left);
+    stack->stackVariable(right);
+    stack->stackEquality(op);
+}
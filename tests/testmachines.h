@@ -0,0 +1,97 @@
+#ifndef TESTMACHINES_H
+#define TESTMACHINES_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fluidicmachinemodel/constraintssolverinterface/routingengine.h>
+#include <fluidicmachinemodel/constraintssolverinterface/translationstack.h>
+#include <fluidicmachinemodel/rules/conjunction.h>
+#include <fluidicmachinemodel/rules/arithmetic/unaryoperation.h>
+#include <fluidicmachinemodel/rules/equality.h>
+
+/**
+ * @brief The TestMachines class stacks small hand-written machines whose routes are known, and the rules they are made of.
+ *
+ * The methods that end in a whole restriction add it to the restrictions of the stack, the others leave an expression at the top of
+ * the stack.
+ */
+class TestMachines
+{
+public:
+    /**
+     * @brief State value of the variables of a machine by name.
+     */
+    typedef std::unordered_map<std::string, long long> State;
+
+    /**
+     * @brief The Route struct an input of a machine and its known route, empty if the input has no route.
+     */
+    typedef struct Route {
+        State input;
+        State route;
+    } Route;
+
+    /**
+     * @brief stackValveMachine stacks a machine with two pumps and a valve that sends the flow of one of them to a container.
+     *
+     * P_0 feeds F_0_1 always and F_1_2 when V_0 is 1, P_1 feeds F_1_3 when V_0 is 2. F_1_2 and F_1_3 only flow forward, C_2 and C_3
+     * are in use when their tube has flow. The first eight restrictions are the domains of P_0, P_1, V_0, F_0_1, F_1_2, F_1_3, C_2 and
+     * C_3, followed by the rules of F_0_1, F_1_2, F_1_3, C_2 and C_3. The routes of every input have a single optimum:
+     *
+     * - F_0_1 = 1: P_0 = 1, P_1 = 0, V_0 = 0.
+     * - F_0_1 = -1: P_0 = -1, P_1 = 0, V_0 = 0.
+     * - C_2 = 1: P_0 = 1, P_1 = 0, V_0 = 1.
+     * - C_3 = 1: P_0 = 0, P_1 = 1, V_0 = 2.
+     * - C_2 = 1 and C_3 = 1, or F_0_1 = -1 and C_2 = 1: no route.
+     *
+     * The whole states are in VALVE_MACHINE_ROUTES.
+     */
+    static void stackValveMachine(TranslationStack* stack);
+
+    /**
+     * @brief VALVE_MACHINE_ROUTES known routes of the machine of stackValveMachine().
+     */
+    static const std::vector<Route> VALVE_MACHINE_ROUTES;
+
+    /**
+     * @brief VALVE_MACHINE_F_1_3_RULE position of the rule of the valve of F_1_3 in the restrictions of stackValveMachine().
+     */
+    static const int VALVE_MACHINE_F_1_3_RULE;
+
+    /**
+     * @brief hasRoutes returns true if the engine finds the known route of every input, and no route for the inputs without one.
+     */
+    static bool hasRoutes(RoutingEngine* engine, const std::vector<Route> & routes);
+
+    /**
+     * @brief stackDomain translates the restriction: name in min..max.
+     */
+    static void stackDomain(TranslationStack* stack, const std::string & name, int min, int max);
+    /**
+     * @brief stackEqualVariables translates the restriction: left #= right.
+     */
+    static void stackEqualVariables(TranslationStack* stack, const std::string & left, const std::string & right);
+    /**
+     * @brief stackValveTube translates the restriction of a tube that has the flow of a pump only at one position of a valve:
+     * (valve #= position #/\ tube #= pump) #\/ (valve #\= position #/\ tube #= 0).
+     */
+    static void stackValveTube(TranslationStack* stack, const std::string & valve, int position, const std::string & tube,
+                               const std::string & pump);
+    /**
+     * @brief stackContainer translates the restriction of a container that is in use when its tube has flow: container #= abs(tube).
+     */
+    static void stackContainer(TranslationStack* stack, const std::string & container, const std::string & tube);
+
+    /**
+     * @brief stackComparison stacks the expression: name op value.
+     */
+    static void stackComparison(TranslationStack* stack, const std::string & name, Equality::ComparatorOp op, int value);
+    /**
+     * @brief stackVariables stacks the expression: left op right.
+     */
+    static void stackVariables(TranslationStack* stack, const std::string & left, Equality::ComparatorOp op, const std::string & right);
+};
+
+#endif // TESTMACHINES_H
@@ -0,0 +1,45 @@
+#include "variabletabletest.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QtTest>
+
+#include "constraintengine/variabletable.h"
+
+static const std::set<std::string> VALVE_MACHINE_VARS = {"C_2", "C_3", "F_0_1", "F_1_2", "F_1_3", "P_0", "P_1", "V_0"};
+
+/**
+ * @brief toVector copies the ids of a range.
+ */
+static std::vector<int> toVector(const VariableTable::IdRange & range) {
+    return std::vector<int>(range.begin(), range.end());
+}
+
+void VariableTableTest::idsFollowAlphabeticalOrder() {
+    VariableTable table(VALVE_MACHINE_VARS);
+    QCOMPARE(table.size(), 8);
+
+    int id = 0;
+    for(const std::string & name: VALVE_MACHINE_VARS) {
+        QCOMPARE(table.find(name), id);
+        QCOMPARE(table.getName(id), name);
+        id++;
+    }
+    QCOMPARE(table.find("P_2"), -1);
+    QCOMPARE(table.find(""), -1);
+    QVERIFY(table.toSet() == VALVE_MACHINE_VARS);
+    QVERIFY(VariableTable().empty());
+}
+
+void VariableTableTest::idsArePartitionedByType() {
+    VariableTable table(VALVE_MACHINE_VARS);
+
+    QVERIFY(toVector(table.getIds(VariableNominator::pump)) == std::vector<int>({5, 6}));
+    QVERIFY(toVector(table.getIds(VariableNominator::valve)) == std::vector<int>({7}));
+    QVERIFY(toVector(table.getIds(VariableNominator::container)) == std::vector<int>({0, 1}));
+    QVERIFY(toVector(table.getIds(VariableNominator::tube)) == std::vector<int>({2, 3, 4}));
+    QVERIFY(toVector(table.getLabelingIds()) == std::vector<int>({5, 6, 7}));
+    QCOMPARE(table.getType(7), VariableNominator::valve);
+}
@@ -0,0 +1,24 @@
+#ifndef VARIABLETABLETEST_H
+#define VARIABLETABLETEST_H
+
+#include <QObject>
+
+/**
+ * @brief The VariableTableTest class checks the ids and the partitions by type of a VariableTable.
+ */
+class VariableTableTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief idsFollowAlphabeticalOrder the ids are the alphabetical order of the names and every name is found by its id.
+     */
+    void idsFollowAlphabeticalOrder();
+    /**
+     * @brief idsArePartitionedByType the ids of every type are grouped, and the pumps and the valves form the labeling range.
+     */
+    void idsArePartitionedByType();
+};
+
+#endif // VARIABLETABLETEST_H